@@ -19,8 +19,10 @@ TaskA::TaskA(const char* name, const char* description)
   : JPetTask(name, description), fCurrEventNumber(0) {}
 void TaskA::init(const JPetTaskInterface::Options& )
 {
-  getStatistics().createHistogram( new TH1F("HitsPerEvtCh", "Hits per channel in one event", 50, -0.5, 49.5) );
-  getStatistics().createHistogram( new TH1F("ChannelsPerEvt", "Channels fired in one event", 200, -0.5, 199.5) );
+  fHitsPerEvtCh = registerHistogram(getStatistics(),
+                                    new TH1F("HitsPerEvtCh", "Hits per channel in one event", 50, -0.5, 49.5) );
+  fChannelsPerEvt = registerHistogram(getStatistics(),
+                                      new TH1F("ChannelsPerEvt", "Channels fired in one event", 200, -0.5, 199.5) );
 }
 
 TaskA::~TaskA() {}
@@ -31,7 +33,7 @@ void TaskA::exec()
   // all get-methods aren't tagged with const modifier
   if (auto evt = dynamic_cast </*const*/ EventIII * const > (getEvent())) {
     int ntdc = evt->GetTotalNTDCChannels();
-    getStatistics().getHisto1D("ChannelsPerEvt").Fill( ntdc );
+    fChannelsPerEvt->Fill( ntdc );
     JPetTimeWindow tslot;
     tslot.setIndex(fCurrEventNumber);
     auto tdcHits = evt->GetTDCChannelsArray();
@@ -51,7 +53,7 @@ void TaskA::exec()
       // one TDC channel may record multiple signals in one TSlot
       // iterate over all signals from one TDC channel
       // analyze number of hits per channel
-      getStatistics().getHisto1D("HitsPerEvtCh").Fill( tdcChannel->GetHitsNum() );
+      fHitsPerEvtCh->Fill( tdcChannel->GetHitsNum() );
       const int kNumHits = tdcChannel->GetHitsNum();
       for (int j = 0; j < kNumHits; ++j) {
 
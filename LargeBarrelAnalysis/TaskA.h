@@ -22,6 +22,7 @@
 #include <JPetParamBank/JPetParamBank.h>
 #include <JPetParamManager/JPetParamManager.h>
 #include <JPetTOMBChannel/JPetTOMBChannel.h>
+#include "HistogramHandles.h"
 class JPetWriter;
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -46,5 +47,7 @@ protected:
   long long int fCurrEventNumber;
   const double kMaxTime = 0.;
   const double kMinTime = -1.e6;
+  TH1F* fHitsPerEvtCh = nullptr;
+  TH1F* fChannelsPerEvt = nullptr;
 };
 #endif /*  !TASKA_H */
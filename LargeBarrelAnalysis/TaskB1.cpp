@@ -28,10 +28,10 @@ void TaskB1::init(const JPetTaskInterface::Options&){
 	for(auto & tomb : getParamBank().getTOMBChannels()){
 		
 		const char * histo_name = formatUniqueChannelDescription(*(tomb.second), "TOT_");
-		getStatistics().createHistogram( new TH1F(histo_name, histo_name, 4000, 20., 100.) );
+		fTOTHistos.add(getStatistics(), tomb.first, new TH1F(histo_name, histo_name, 4000, 20., 100.) );
 	}
 	// a 2D histogram for presence of leading vs trailing edge
-	getStatistics().createHistogram( new TH2F("was lead and trail edge?",
+	fLeadTrailHisto = registerHistogram(getStatistics(), new TH2F("was lead and trail edge?",
 						  "was lead and trail edge?;was trail edge;was lead edge",
 					   2, -0.5, 1.5, 2, -0.5, 1.5)
 	);
@@ -41,11 +41,11 @@ void TaskB1::init(const JPetTaskInterface::Options&){
 		int n_pmts = getParamBank().getPMsSize();
 		char * histo_name = Form("HitsLeadingEdge_thr%d", thr);
 		char * histo_title = Form("%s;PMT No.;No. hits", histo_name);
-		getStatistics().createHistogram( new TH1F(histo_name, histo_title, n_pmts, -0.5, n_pmts-0.5) );
+		fHitsLeadingEdgeHistos.add(getStatistics(), thr, new TH1F(histo_name, histo_title, n_pmts, -0.5, n_pmts-0.5) );
 		
 		histo_name = Form("HitsTrailingEdge_thr%d", thr);
 		histo_title = Form("%s;PMT No.;No. hits", histo_name);
-		getStatistics().createHistogram( new TH1F(histo_name, histo_title, n_pmts, -0.5, n_pmts-0.5) );
+		fHitsTrailingEdgeHistos.add(getStatistics(), thr, new TH1F(histo_name, histo_title, n_pmts, -0.5, n_pmts-0.5) );
 	}
 }
 
@@ -68,22 +68,21 @@ void TaskB1::exec(){
 		for (auto & chSigPair : leadSigChs) {
 			int daq_channel = chSigPair.first;
 			if( trailSigChs.count(daq_channel) != 0 ){ 
-				getStatistics().getHisto2D("was lead and trail edge?").Fill(1.,1.);
+				fLeadTrailHisto->Fill(1.,1.);
 				JPetSigCh & leadSigCh = chSigPair.second;
 				JPetSigCh & trailSigCh = trailSigChs.at(daq_channel);
 				double tot = trailSigCh.getValue() - leadSigCh.getValue();
 				if( leadSigCh.getPM() != trailSigCh.getPM() ){
 					ERROR("Signals from same channel point to different PMTs! Check the setup mapping!!!");
 				}
-				const char * histo_name = formatUniqueChannelDescription(leadSigCh.getTOMBChannel(), "TOT_");
-				getStatistics().getHisto1D(histo_name).Fill( tot / 1000. );
+				fTOTHistos.get(daq_channel)->Fill( tot / 1000. );
 				int pmt_number = calcGlobalPMTNumber(leadSigCh.getPM());
-				getStatistics().getHisto1D(Form("HitsLeadingEdge_thr%d", leadSigCh.getThresholdNumber())).Fill(pmt_number);
+				fHitsLeadingEdgeHistos.get(leadSigCh.getThresholdNumber())->Fill(pmt_number);
 				double pmt_id = trailSigCh.getPM().getID();
 				signals[pmt_id].addPoint( leadSigCh );
 				signals[pmt_id].addPoint( trailSigCh );
 			}else{
-				getStatistics().getHisto2D("was lead and trail edge?").Fill(0.,1.);
+				fLeadTrailHisto->Fill(0.,1.);
 			}
 		}
 		// the above loop will not count cases where there was only trailing edge signal
@@ -91,9 +90,9 @@ void TaskB1::exec(){
 		for (const auto & chSigPair : trailSigChs) {
 			int daq_channel = chSigPair.first;
 			if( leadSigChs.count(daq_channel) == 0 )
-				getStatistics().getHisto2D("was lead and trail edge?").Fill(1.,0.);
+				fLeadTrailHisto->Fill(1.,0.);
 			int pmt_number = calcGlobalPMTNumber(chSigPair.second.getPM());
-			getStatistics().getHisto1D(Form("HitsTrailingEdge_thr%d", chSigPair.second.getThresholdNumber())).Fill(pmt_number);
+			fHitsTrailingEdgeHistos.get(chSigPair.second.getThresholdNumber())->Fill(pmt_number);
 		}    
 		for(auto & pmSignalPair : signals){
 			auto & signal = pmSignalPair.second;
@@ -23,6 +23,7 @@
 #include <JPetParamBank/JPetParamBank.h>
 #include <JPetParamManager/JPetParamManager.h>
 #include "LargeBarrelMapping.h"
+#include "HistogramHandles.h"
 class JPetWriter;
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -48,5 +49,10 @@ protected:
   JPetParamManager* fParamManager;
   LargeBarrelMapping fBarrelMap;
   const int kNumOfThresholds = 4;
+  /// TOT histograms indexed by the DAQ channel, hits per PMT indexed by the threshold
+  HistogramArray<TH1F> fTOTHistos;
+  HistogramArray<TH1F> fHitsLeadingEdgeHistos;
+  HistogramArray<TH1F> fHitsTrailingEdgeHistos;
+  TH2F* fLeadTrailHisto = nullptr;
 };
 #endif /*  !TASKB1_H */
@@ -34,27 +34,24 @@ void TaskC::exec()
   //getting the data from event in propriate format
   if (auto currSignal = dynamic_cast<const JPetRawSignal* const>(getEvent())) {
     getStatistics().getCounter("No. initial signals")++;
-    if (fSignals.empty()) {
-      fSignals.push_back(*currSignal);
-    } else {
-      if (fSignals[0].getTimeWindowIndex() == currSignal->getTimeWindowIndex()) {
-        fSignals.push_back(*currSignal);
-      } else {
-
-        vector<JPetHit> hits = createHits(fSignals);
-        hits = JPetAnalysisTools::getHitsOrderedByTime(hits);
-        // uncomment this in order to fill histograms
-        // of time differences for subsequent hist
-        studyTimeWindow(hits);
-
-        saveHits(hits);
-
-        fSignals.clear();
-        fSignals.push_back(*currSignal);
-      }
-    }
+    fSignals.add(*currSignal, currSignal->getTimeWindowIndex(),
+    [this](const vector<JPetRawSignal>& signals) {
+      processTimeWindow(signals);
+    });
   }
 }
+
+void TaskC::processTimeWindow(const vector<JPetRawSignal>& signals)
+{
+  vector<JPetHit> hits = createHits(signals);
+  hits = JPetAnalysisTools::getHitsOrderedByTime(hits);
+  // uncomment this in order to fill histograms
+  // of time differences for subsequent hist
+  studyTimeWindow(hits);
+
+  saveHits(hits);
+}
+
 vector<JPetHit> TaskC::createHits(const vector<JPetRawSignal>& signals)
 {
   vector<JPetHit> hits;
@@ -139,7 +136,10 @@ vector<JPetHit> TaskC::createHits(const vector<JPetRawSignal>& signals)
 
 void TaskC::terminate()
 {
-  //	saveHits(createHits(fSignals)); //if there is something left
+  // the last time window
+  fSignals.finish([this](const vector<JPetRawSignal>& signals) {
+    processTimeWindow(signals);
+  });
   INFO( Form("From %d initial signals %d hits were paired.",
              static_cast<int>(getStatistics().getCounter("No. initial signals")),
              static_cast<int>(getStatistics().getCounter("No. found hits")) )
@@ -19,6 +19,7 @@
 #include <JPetTask/JPetTask.h>
 #include <JPetHit/JPetHit.h>
 #include <JPetRawSignal/JPetRawSignal.h>
+#include "WindowAccumulator.h"
 class JPetWriter;
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -35,10 +36,11 @@ public:
   virtual void terminate()override;
   virtual void setWriter(JPetWriter* writer)override;
 protected:
+  void processTimeWindow(const std::vector<JPetRawSignal>& signals);
   std::vector<JPetHit> createHits(const std::vector<JPetRawSignal>& signals);
   void saveHits(const std::vector<JPetHit>& hits);
   void studyTimeWindow(const std::vector<JPetHit>& hits);
-  std::vector<JPetRawSignal> fSignals;
+  WindowAccumulator<JPetRawSignal> fSignals;
   JPetWriter* fWriter;
   const int kNumOfThresholds = 4;
 };
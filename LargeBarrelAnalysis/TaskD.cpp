@@ -24,7 +24,8 @@ void TaskD::init(const JPetTaskInterface::Options&){
 	for(auto & scin : getParamBank().getScintillators()){
 		for (int thr=1;thr<=4;thr++){
 			const char * histo_name = formatUniqueSlotDescription(scin.second->getBarrelSlot(), thr, "timeDiffAB_");
-			getStatistics().createHistogram( new TH1F(histo_name, histo_name, 2000, -20., 20.) );
+			fTimeDiffHistos.add(getStatistics(), scin.second->getBarrelSlot().getID(), thr,
+					    new TH1F(histo_name, histo_name, 2000, -20., 20.) );
 		}
 	}
 	// create histograms for time diffrerence vs slot ID
@@ -33,8 +34,9 @@ void TaskD::init(const JPetTaskInterface::Options&){
 			const char * histo_name = Form("TimeDiffVsID_layer_%d_thr_%d", fBarrelMap.getLayerNumber(*layer.second), thr);
 			const char * histo_titile = Form("%s;Slot ID; TimeDiffAB [ns]", histo_name); 
 			int n_slots_in_layer = fBarrelMap.getNumberOfSlots(*layer.second);
-			getStatistics().createHistogram( new TH2F(histo_name, histo_titile, n_slots_in_layer, 0.5, n_slots_in_layer+0.5,
-								  120, -20., 20.) );
+			fTimeDiffVsIDHistos.add(getStatistics(), layer.second->getID(), thr,
+						new TH2F(histo_name, histo_titile, n_slots_in_layer, 0.5, n_slots_in_layer+0.5,
+							 120, -20., 20.) );
 		}
 	}
 }
@@ -54,8 +56,11 @@ void TaskD::terminate(){
 
 	for(auto & slot : getParamBank().getBarrelSlots()){
 		for (int thr=1;thr<=4;thr++){
+			TH1F * histo = fTimeDiffHistos.get(slot.first, thr);
+			if( !histo ) // slot without a scintillator
+				continue;
 			const char * histo_name = formatUniqueSlotDescription(*(slot.second), thr, "timeDiffAB_");
-			double mean = getStatistics().getHisto1D(histo_name).GetMean();
+			double mean = histo->GetMean();
 			getAuxilliaryData().setValue("timeDiffAB mean values", histo_name, mean);
 		}
 	}
@@ -71,13 +76,11 @@ void TaskD::fillHistosForHit(const JPetHit & hit){
 			double timeDiffAB = lead_times_A[thr] - lead_times_B[thr];
 			timeDiffAB /= 1000.; // we want the plots in ns instead of ps
 			// fill the appropriate histogram
-			const char * histo_name = formatUniqueSlotDescription(hit.getBarrelSlot(), thr, "timeDiffAB_");
-			getStatistics().getHisto1D(histo_name).Fill( timeDiffAB );
+			fTimeDiffHistos.get(hit.getBarrelSlot().getID(), thr)->Fill( timeDiffAB );
 			// fill the timeDiffAB vs slot ID histogram
-			int layer_number = fBarrelMap.getLayerNumber( hit.getBarrelSlot().getLayer() );
 			int slot_number = fBarrelMap.getSlotNumber( hit.getBarrelSlot() );
-			getStatistics().getHisto2D(Form("TimeDiffVsID_layer_%d_thr_%d", layer_number, thr)).Fill( slot_number,
-														  timeDiffAB);
+			fTimeDiffVsIDHistos.get(hit.getBarrelSlot().getLayer().getID(), thr)->Fill( slot_number,
+												   timeDiffAB);
 		}
 	}
 }
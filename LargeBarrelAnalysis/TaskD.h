@@ -20,6 +20,7 @@
 #include <JPetHit/JPetHit.h>
 #include <JPetRawSignal/JPetRawSignal.h>
 #include "LargeBarrelMapping.h"
+#include "HistogramHandles.h"
 class JPetWriter;
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -39,5 +40,9 @@ protected:
 	void fillHistosForHit(const JPetHit & hit);
 	JPetWriter* fWriter;
 	LargeBarrelMapping fBarrelMap;
+	static const int kNumOfThresholds = 4;
+	/// indexed by the barrel slot ID and threshold, and by the layer ID and threshold
+	HistogramArray<TH1F> fTimeDiffHistos = HistogramArray<TH1F>(kNumOfThresholds + 1);
+	HistogramArray<TH2F> fTimeDiffVsIDHistos = HistogramArray<TH2F>(kNumOfThresholds + 1);
 };
 #endif /*  !TASKD_H */
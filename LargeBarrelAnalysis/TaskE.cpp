@@ -13,7 +13,9 @@
  *  @file TaskE.cpp
  */
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <JPetWriter/JPetWriter.h>
 #include <JPetHitUtils/JPetHitUtils.h>
 #include "TaskE.h"
@@ -23,23 +25,41 @@ TaskE::~TaskE() {}
 void TaskE::init(const JPetTaskInterface::Options& opts)
 {
   fBarrelMap.buildMappings(getParamBank());
+  if (opts.count(kOverlapMarginParamKey)) {
+    double overlapMargin = std::atof(opts.at(kOverlapMarginParamKey).c_str());
+    double timeWindowLength = 0.; // [ps]
+    if (opts.count(kTimeWindowLengthParamKey)) {
+      timeWindowLength = std::atof(opts.at(kTimeWindowLengthParamKey).c_str());
+    }
+    /// the hits of the next window are shifted by the window length, there is no safe default
+    if (timeWindowLength > 0.) {
+      fHits.setOverlap(overlapMargin, timeWindowLength, [](const JPetHit & hit) {
+        return hit.getTime();
+      });
+    } else {
+      ERROR(kOverlapMarginParamKey + " requires a positive " + kTimeWindowLengthParamKey
+            + ", the coincidences across the time windows are switched off");
+    }
+  }
   for (auto & layer : getParamBank().getLayers()) {
     for (int thr = 1; thr <= 4; thr++) {
       // create histograms of Delta ID
       char* histo_name = Form("Delta_ID_for_coincidences_layer_%d_thr_%d", fBarrelMap.getLayerNumber(*layer.second), thr);
       char* histo_title = Form("%s;#Delta ID", histo_name);
       int n_slots_in_half_layer = fBarrelMap.getNumberOfSlots(*layer.second) / 2;
-      getStatistics().createHistogram( new TH1F(histo_name, histo_title,
-                                       n_slots_in_half_layer, 0.5, n_slots_in_half_layer + 0.5)
-                                     );
+      fDeltaIDHistos.add(getStatistics(), layer.second->getID(), thr,
+                         new TH1F(histo_name, histo_title,
+                                  n_slots_in_half_layer, 0.5, n_slots_in_half_layer + 0.5)
+                        );
 
       // create histograms of TOF vs Delta ID
       histo_name = Form("TOF_vs_Delta_ID_layer_%d_thr_%d", fBarrelMap.getLayerNumber(*layer.second), thr);
       histo_title = Form("%s;#Delta ID;TOF [ns]", histo_name);
-      getStatistics().createHistogram( new TH2F(histo_name, histo_title,
+      fTOFvsDeltaIDHistos.add(getStatistics(), layer.second->getID(), thr,
+                              new TH2F(histo_name, histo_title,
                                        n_slots_in_half_layer, 0.5, n_slots_in_half_layer + 0.5,
                                        100, 0., 15.)
-                                     );
+                             );
 
       // create histograms for TOT vs TOT
       for (char side : {
@@ -47,7 +67,9 @@ void TaskE::init(const JPetTaskInterface::Options& opts)
            } ) {
         histo_name = Form("TOT_vs_TOT_layer_%d_thr_%d_side_%c", fBarrelMap.getLayerNumber(*layer.second), thr, side);
         histo_title = Form("%s;TOT [ns];TOT [ns]", histo_name);
-        getStatistics().createHistogram( new TH2F(histo_name, histo_title, 120, 0., 120., 120, 0., 120.));
+        auto& histos = side == 'A' ? fTOTvsTOTSideAHistos : fTOTvsTOTSideBHistos;
+        histos.add(getStatistics(), layer.second->getID(), thr,
+                   new TH2F(histo_name, histo_title, 120, 0., 120., 120, 0., 120.));
       }
     }
   }
@@ -56,7 +78,8 @@ void TaskE::init(const JPetTaskInterface::Options& opts)
   for (auto & scin : getParamBank().getScintillators()) {
     for (int thr = 1; thr <= 4; thr++) {
       const char* histo_name = formatUniqueSlotDescription(scin.second->getBarrelSlot(), thr, "dTOF_");
-      getStatistics().createHistogram( new TH1F(histo_name, histo_name, 2000, -20., 20.) );
+      fDTOFHistos.add(getStatistics(), scin.second->getBarrelSlot().getID(), thr,
+                      new TH1F(histo_name, histo_name, 2000, -20., 20.) );
     }
   }
 }
@@ -64,25 +87,22 @@ void TaskE::exec()
 {
   //getting the data from event in propriate format
   if (auto currHit = dynamic_cast<const JPetHit* const>(getEvent())) {
-    if (fHits.empty()) {
-      fHits.push_back(*currHit);
-    } else {
-      if (fHits[0].getTimeWindowIndex() == currHit->getSignalB().getTimeWindowIndex()) {
-        fHits.push_back(*currHit);
-      } else {
-        fillCoincidenceHistos(fHits);
-        fHits.clear();
-        fHits.push_back(*currHit);
-      }
-    }
+    fHits.add(*currHit, currHit->getSignalB().getTimeWindowIndex(),
+    [this](const vector<JPetHit>& hits) {
+      fillCoincidenceHistos(hits);
+    });
   }
 }
 // this method considers all possible 2-strip coincidences
-// among the hits from a single time window
+// among the hits from a single time window, and between them and
+// the hits carried over from the end of the previous time window
 void TaskE::fillCoincidenceHistos(const vector<JPetHit>& hits)
 {
+  const std::size_t numOfCarried = fHits.getNumOfCarried();
   for (auto i = hits.begin(); i != hits.end(); ++i) {
-    for (auto j = i; ++j != hits.end(); /**/) {
+    // the time shift of the hits carried over from the previous time window
+    double shift1 = static_cast<std::size_t>(i - hits.begin()) < numOfCarried ? fHits.getCarriedTimeOffset() : 0.;
+    for (auto j = std::max(i + 1, hits.begin() + numOfCarried); j != hits.end(); ++j) {
       auto& hit1 = *i;
       auto& hit2 = *j;
       // if there are two hits from the same layer but different scintillators
@@ -93,7 +113,7 @@ void TaskE::fillCoincidenceHistos(const vector<JPetHit>& hits)
         // study the coincidences independently for each threshold
         for (int thr = 1; thr <= 4; thr++) {
           if ( isGoodTimeDiff(hit1, thr) && isGoodTimeDiff(hit2, thr) ) {
-            double tof = fabs( JPetHitUtils::getTimeAtThr(hit1, thr) -
+            double tof = fabs( JPetHitUtils::getTimeAtThr(hit1, thr) + shift1 -
                                JPetHitUtils::getTimeAtThr(hit2, thr)
                              );
             tof /= 1000.; // [ns]
@@ -102,7 +122,7 @@ void TaskE::fillCoincidenceHistos(const vector<JPetHit>& hits)
               // study the coincidence and fill histograms
               int delta_ID = fBarrelMap.calcDeltaID(hit1, hit2);
               fillDeltaIDhisto(delta_ID, thr, hit1.getBarrelSlot().getLayer());
-              fillTOFvsDeltaIDhisto(delta_ID, thr, hit1, hit2);
+              fillTOFvsDeltaIDhisto(delta_ID, thr, hit1, tof);
               // fill TOT vs TOT histos
               fillTOTvsTOThisto(delta_ID, thr, hit1, hit2);
 
@@ -113,7 +133,13 @@ void TaskE::fillCoincidenceHistos(const vector<JPetHit>& hits)
     }
   }
 }
-void TaskE::terminate() {}
+void TaskE::terminate()
+{
+  // the last time window
+  fHits.finish([this](const vector<JPetHit>& hits) {
+    fillCoincidenceHistos(hits);
+  });
+}
 const char* TaskE::formatUniqueSlotDescription(const JPetBarrelSlot& slot, int threshold, const char* prefix = "")
 {
   int slot_number = fBarrelMap.getSlotNumber(slot);
@@ -128,30 +154,16 @@ const char* TaskE::formatUniqueSlotDescription(const JPetBarrelSlot& slot, int t
 
 void TaskE::fillDeltaIDhisto(int delta_ID, int threshold, const JPetLayer& layer)
 {
-  int layer_number = fBarrelMap.getLayerNumber(layer);
-  const char* histo_name = Form("Delta_ID_for_coincidences_layer_%d_thr_%d", layer_number, threshold);
-  getStatistics().getHisto1D(histo_name).Fill(delta_ID);
+  fDeltaIDHistos.get(layer.getID(), threshold)->Fill(delta_ID);
 }
 
-void TaskE::fillTOFvsDeltaIDhisto(int delta_ID, int thr, const JPetHit& hit1, const JPetHit& hit2)
+void TaskE::fillTOFvsDeltaIDhisto(int delta_ID, int thr, const JPetHit& hit1, double tof)
 {
-  int layer_number = fBarrelMap.getLayerNumber(hit1.getBarrelSlot().getLayer());
-  const char* histo_name = Form("TOF_vs_Delta_ID_layer_%d_thr_%d",
-                                fBarrelMap.getLayerNumber(hit1.getBarrelSlot().getLayer()),
-                                thr);
-
-  double tof = fabs( JPetHitUtils::getTimeAtThr(hit1, thr) -
-                     JPetHitUtils::getTimeAtThr(hit2, thr)
-                   );
-
-  tof /= 1000.; // to have the TOF in ns instead of ps
-
-  getStatistics().getHisto2D(histo_name).Fill(delta_ID, tof);
+  fTOFvsDeltaIDHistos.get(hit1.getBarrelSlot().getLayer().getID(), thr)->Fill(delta_ID, tof);
 
   if (delta_ID == 24) {
 
-    histo_name = formatUniqueSlotDescription(hit1.getBarrelSlot(), thr, "dTOF_");
-    getStatistics().getHisto1D(histo_name).Fill(tof);
+    fDTOFHistos.get(hit1.getBarrelSlot().getID(), thr)->Fill(tof);
 
   }
 
@@ -160,10 +172,18 @@ void TaskE::fillTOFvsDeltaIDhisto(int delta_ID, int thr, const JPetHit& hit1, co
 
 bool TaskE::isGoodTimeDiff(const JPetHit& hit, int thr)
 {
-  double mean_timediff = getAuxilliaryData().getValue("timeDiffAB mean values",
-                         formatUniqueSlotDescription(hit.getBarrelSlot(),
-                             thr, "timeDiffAB_")
-                                                     );
+  /// the means are read by name once for every slot and threshold
+  std::size_t index = hit.getBarrelSlot().getID() * (kNumOfThresholds + 1) + thr;
+  if (index >= fTimeDiffMeans.size()) {
+    fTimeDiffMeans.resize(index + 1, std::numeric_limits<double>::quiet_NaN());
+  }
+  if (std::isnan(fTimeDiffMeans[index])) {
+    fTimeDiffMeans[index] = getAuxilliaryData().getValue("timeDiffAB mean values",
+                            formatUniqueSlotDescription(hit.getBarrelSlot(),
+                                thr, "timeDiffAB_")
+                                                        );
+  }
+  double mean_timediff = fTimeDiffMeans[index];
   double this_hit_timediff = JPetHitUtils::getTimeDiffAtThr(hit, thr) / 1000.; // [ns]
   return ( fabs( this_hit_timediff - mean_timediff ) < 1.0 );
 }
@@ -176,17 +196,13 @@ void TaskE::fillTOTvsTOThisto(int delta_ID, int thr, const JPetHit& hit1, const
   double totB1 = hit1.getSignalB().getRecoSignal().getRawSignal().getTOTsVsThresholdNumber().at(thr);
   double totA2 = hit2.getSignalA().getRecoSignal().getRawSignal().getTOTsVsThresholdNumber().at(thr);
   double totB2 = hit2.getSignalB().getRecoSignal().getRawSignal().getTOTsVsThresholdNumber().at(thr);
-  char* histo_name;
+  int layer_id = hit1.getBarrelSlot().getLayer().getID();
 
   // fill side A
-  histo_name = Form("TOT_vs_TOT_layer_%d_thr_%d_side_A",
-                    fBarrelMap.getLayerNumber(hit1.getBarrelSlot().getLayer()), thr);
-  getStatistics().getHisto2D(histo_name).Fill(totA1 / 1000., totA2 / 1000.);
+  fTOTvsTOTSideAHistos.get(layer_id, thr)->Fill(totA1 / 1000., totA2 / 1000.);
 
   // fill side B
-  histo_name = Form("TOT_vs_TOT_layer_%d_thr_%d_side_B",
-                    fBarrelMap.getLayerNumber(hit1.getBarrelSlot().getLayer()), thr);
-  getStatistics().getHisto2D(histo_name).Fill(totB1 / 1000., totB2 / 1000.);
+  fTOTvsTOTSideBHistos.get(layer_id, thr)->Fill(totB1 / 1000., totB2 / 1000.);
 
 }
 void TaskE::setWriter(JPetWriter* writer)
@@ -18,6 +18,8 @@
 #include <JPetHit/JPetHit.h>
 #include <JPetRawSignal/JPetRawSignal.h>
 #include "LargeBarrelMapping.h"
+#include "WindowAccumulator.h"
+#include "HistogramHandles.h"
 class JPetWriter;
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -36,12 +38,28 @@ protected:
 	const char * formatUniqueSlotDescription(const JPetBarrelSlot & slot, int threshold,const char * prefix);
 	void fillCoincidenceHistos(const std::vector<JPetHit>& hits);
 	void fillDeltaIDhisto(int delta_ID, int threshold, const JPetLayer & layer);
-	void fillTOFvsDeltaIDhisto(int delta_ID, int threshold, const JPetHit & hit1, const JPetHit & hit2);
+	/// tof in ns
+	void fillTOFvsDeltaIDhisto(int delta_ID, int threshold, const JPetHit & hit1, double tof);
 	bool isGoodTimeDiff(const JPetHit & hit, int thr);
 	void fillTOTvsTOThisto(int delta_ID, int thr, const JPetHit & hit1, const JPetHit & hit2);
 private:
 	LargeBarrelMapping fBarrelMap;
-	std::vector<JPetHit> fHits;
+	WindowAccumulator<JPetHit> fHits;
+	/// with a positive margin (in ps) the coincidences between the hits at the end
+	/// of a time window and at the beginning of the next one are also considered,
+	/// the time window length (in ps) must be given then
+	const std::string kOverlapMarginParamKey = "TaskE_OverlapMargin";
+	const std::string kTimeWindowLengthParamKey = "TaskE_TimeWindowLength";
 	JPetWriter* fWriter;
+	static const int kNumOfThresholds = 4;
+	/// indexed by the layer ID and threshold
+	HistogramArray<TH1F> fDeltaIDHistos = HistogramArray<TH1F>(kNumOfThresholds + 1);
+	HistogramArray<TH2F> fTOFvsDeltaIDHistos = HistogramArray<TH2F>(kNumOfThresholds + 1);
+	HistogramArray<TH2F> fTOTvsTOTSideAHistos = HistogramArray<TH2F>(kNumOfThresholds + 1);
+	HistogramArray<TH2F> fTOTvsTOTSideBHistos = HistogramArray<TH2F>(kNumOfThresholds + 1);
+	/// indexed by the barrel slot ID and threshold
+	HistogramArray<TH1F> fDTOFHistos = HistogramArray<TH1F>(kNumOfThresholds + 1);
+	/// timeDiffAB means from the TaskD, NaN until read, indexed as fDTOFHistos
+	std::vector<double> fTimeDiffMeans;
 };
 #endif /*  !TASKE_H */
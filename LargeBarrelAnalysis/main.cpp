@@ -13,6 +13,7 @@
  *  @file main.cpp
  */
 
+#include <iostream>
 #include <DBHandler/HeaderFiles/DBHandler.h>
 #include <JPetManager/JPetManager.h>
 #include <JPetTaskLoader/JPetTaskLoader.h>
@@ -21,6 +22,7 @@
 #include "TaskC.h"
 #include "TaskD.h"
 #include "TaskE.h"
+#include "ProfiledTask.h"
 
 using namespace std;
 
@@ -34,34 +36,35 @@ int main(int argc, char* argv[])
   /*
   manager.registerTask([](){
       return new JPetTaskLoader("hld", "tslot.raw",
-  				  new TaskA("Module A: Unp to TSlot Raw",
-  					    "Process unpacked HLD file into a tree of JPetTSlot objects"));
+  				  new ProfiledTask(new TaskA("Module A: Unp to TSlot Raw",
+  					    "Process unpacked HLD file into a tree of JPetTSlot objects")));
     });
   
   manager.registerTask([](){
       return new JPetTaskLoader("tslot.raw", "raw.sig",
-  				new TaskB1("Module B1: Make TOT histos and assemble signals",
-					   "Assemble signals and create TOT historgrams"));
+  				new ProfiledTask(new TaskB1("Module B1: Make TOT histos and assemble signals",
+					   "Assemble signals and create TOT historgrams")));
     });
 
    manager.registerTask([](){ 
        return new JPetTaskLoader("raw.sig", "phys.hit", 
-				 new TaskC("Module C: Pair signals", 
-					   "Create hits from pairs of signals")); 
+				 new ProfiledTask(new TaskC("Module C: Pair signals", 
+					   "Create hits from pairs of signals"))); 
      }); 
 
   manager.registerTask([](){
       return new JPetTaskLoader("phys.hit", "phys.hit.means",
-				new TaskD("Module D: Make histograms for hits",
-					  "Only make timeDiff histos and produce mean timeDiff value for each threshold and slot to be used by the next module"));
+				new ProfiledTask(new TaskD("Module D: Make histograms for hits",
+					  "Only make timeDiff histos and produce mean timeDiff value for each threshold and slot to be used by the next module")));
     });
   
   */  
   manager.registerTask([](){
       return new JPetTaskLoader("phys.hit.means", "phys.hit.coincplots",
-  				new TaskE("Module E: Filter hits",
-  					  "Pass only hits with time diffrerence close to the peak"));
+  				new ProfiledTask(new TaskE("Module E: Filter hits",
+  					  "Pass only hits with time diffrerence close to the peak")));
     });
 
   manager.run();
+  TaskProfiler::getProfiler().finish(std::cout);
 }
@@ -0,0 +1,197 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file BatchTools.cpp
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <glob.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <THashTable.h>
+#include <JPetStatistics/JPetStatistics.h>
+#include <JPetLoggerInclude.h>
+#include "BatchTools.h"
+
+bool BatchTools::parseBatchOptions(int argc, const char* const argv[], BatchOptions& options)
+{
+  for (int i = 0; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg != "--batch" && arg != "--jobs" && arg != "--merged-output") {
+      options.frameworkArgs.push_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      ERROR("No value given for the option " + arg);
+      return false;
+    }
+    std::string value = argv[++i];
+    if (arg == "--batch") {
+      options.inputFiles = value;
+    } else if (arg == "--merged-output") {
+      options.mergedOutput = value;
+    } else {
+      char* end = nullptr;
+      options.jobs = std::strtol(value.c_str(), &end, 10);
+      if (*end != '\0' || options.jobs < 0) {
+        ERROR("Incorrect number of jobs: " + value);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<std::string> BatchTools::expandInputFiles(const std::string& pattern)
+{
+  if (pattern.find_first_of("*?[") == std::string::npos) {
+    return readFileList(pattern);
+  }
+  std::vector<std::string> files;
+  glob_t matches;
+  if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+    files.assign(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+  }
+  globfree(&matches);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+std::vector<std::string> BatchTools::readFileList(const std::string& listFile)
+{
+  std::vector<std::string> files;
+  std::ifstream list(listFile);
+  if (!list) {
+    ERROR("Can not open the list of the input files: " + listFile);
+    return files;
+  }
+  std::string line;
+  while (std::getline(list, line)) {
+    auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    auto last = line.find_last_not_of(" \t\r");
+    files.push_back(line.substr(first, last - first + 1));
+  }
+  return files;
+}
+
+std::vector<std::vector<std::string>> BatchTools::splitIntoRounds(const std::vector<std::string>& files, int jobs)
+{
+  const std::size_t roundSize = std::max(1, jobs);
+  std::vector<std::vector<std::string>> rounds;
+  for (std::size_t first = 0; first < files.size(); first += roundSize) {
+    auto last = std::min(files.size(), first + roundSize);
+    rounds.emplace_back(files.begin() + first, files.begin() + last);
+  }
+  return rounds;
+}
+
+/// The framework runs a separate task chain, in its own thread, for every file given with -f.
+std::vector<std::string> BatchTools::getRoundArgs(const BatchOptions& options, const std::vector<std::string>& files)
+{
+  auto args = options.frameworkArgs;
+  args.push_back("-f");
+  args.insert(args.end(), files.begin(), files.end());
+  return args;
+}
+
+std::string BatchTools::getSetupKey(const std::map<std::string, std::string>& opts)
+{
+  auto setupFile = opts.find("localDB");
+  auto runId = opts.find("runId");
+  return (setupFile != opts.end() ? setupFile->second : std::string()) + "|"
+         + (runId != opts.end() ? runId->second : std::string());
+}
+
+HistogramMerger::HistogramMerger() {}
+
+HistogramMerger::~HistogramMerger() {}
+
+HistogramMerger& HistogramMerger::getMerger()
+{
+  static HistogramMerger merger;
+  return merger;
+}
+
+void HistogramMerger::setEnabled(bool enabled)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fEnabled = enabled;
+}
+
+bool HistogramMerger::isEnabled() const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  return fEnabled;
+}
+
+void HistogramMerger::add(const JPetStatistics& stats)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  TIter next(stats.getStatsTable());
+  while (TObject* object = next()) {
+    auto histogram = dynamic_cast<TH1*>(object);
+    if (!histogram) {
+      continue;
+    }
+    auto merged = fHistogramsByName.find(histogram->GetName());
+    if (merged != fHistogramsByName.end()) {
+      merged->second->Add(histogram);
+      continue;
+    }
+    /// the copy is owned by the merger, not by the current ROOT directory
+    std::unique_ptr<TH1> copy(static_cast<TH1*>(histogram->Clone()));
+    copy->SetDirectory(nullptr);
+    fHistogramsByName[histogram->GetName()] = copy.get();
+    fHistograms.push_back(std::move(copy));
+  }
+  fNumOfInputs++;
+}
+
+std::size_t HistogramMerger::getNumOfInputs() const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  return fNumOfInputs;
+}
+
+std::size_t HistogramMerger::getNumOfHistograms() const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  return fHistograms.size();
+}
+
+bool HistogramMerger::write(const std::string& fileName) const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  TFile file(fileName.c_str(), "RECREATE");
+  if (file.IsZombie()) {
+    ERROR("Can not create the file for the merged histograms: " + fileName);
+    return false;
+  }
+  for (const auto& histogram : fHistograms) {
+    histogram->Write();
+  }
+  file.Close();
+  return true;
+}
+
+void HistogramMerger::clear()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fHistograms.clear();
+  fHistogramsByName.clear();
+  fNumOfInputs = 0;
+}
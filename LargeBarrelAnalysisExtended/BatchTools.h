@@ -0,0 +1,95 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file BatchTools.h
+ *  @brief Tools of the batch mode, analysing many HLD files in one job.
+ */
+
+#ifndef BATCHTOOLS_H
+#define BATCHTOOLS_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class JPetStatistics;
+class TH1;
+
+/// Options of the batch mode, given on the command line before the framework options.
+struct BatchOptions {
+  /// glob pattern or file with the list of the input files, empty if the batch mode is not used
+  std::string inputFiles;
+  /// number of files processed at the same time, 0 for the number of cores
+  int jobs = 0;
+  /// ROOT file with the histograms summed over all input files
+  std::string mergedOutput = "batch_stats.root";
+  /// command line without the batch options, to be passed to the JPetManager
+  std::vector<std::string> frameworkArgs;
+};
+
+class BatchTools
+{
+public:
+  /// Takes the options --batch, --jobs and --merged-output out of the command line.
+  /// Returns false if any of them is given without a correct value.
+  static bool parseBatchOptions(int argc, const char* const argv[], BatchOptions& options);
+  /// Files matching the glob pattern, sorted by name. If the pattern has no wildcards
+  /// it is the name of a file listing the input files, as read by readFileList().
+  static std::vector<std::string> expandInputFiles(const std::string& pattern);
+  /// One file name per line, empty lines and lines starting with # are skipped.
+  static std::vector<std::string> readFileList(const std::string& listFile);
+  /// Consecutive groups of at most jobs files, processed at the same time.
+  static std::vector<std::vector<std::string>> splitIntoRounds(const std::vector<std::string>& files, int jobs);
+  /// Command line of the framework for the files of one round.
+  static std::vector<std::string> getRoundArgs(const BatchOptions& options, const std::vector<std::string>& files);
+  /// Part of the SharedCache keys for the objects built from the parameter bank:
+  /// the setup file and the run number from the task options.
+  static std::string getSetupKey(const std::map<std::string, std::string>& opts);
+};
+
+/**
+ * @brief Sums the histograms of the statistics of all input files, one instance per process.
+ *
+ * Every task chain adds its statistics at the end, the first histogram of a given
+ * name is copied and the next ones are added to it. Other objects are skipped.
+ */
+class HistogramMerger
+{
+public:
+  static HistogramMerger& getMerger();
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+  void add(const JPetStatistics& stats);
+  std::size_t getNumOfInputs() const;
+  std::size_t getNumOfHistograms() const;
+  /// Writes all merged histograms to a new ROOT file, false if it can not be created.
+  bool write(const std::string& fileName) const;
+  void clear();
+
+private:
+  HistogramMerger();
+  ~HistogramMerger();
+  HistogramMerger(const HistogramMerger&);
+  void operator=(const HistogramMerger&);
+
+  mutable std::mutex fMutex;
+  bool fEnabled = false;
+  std::size_t fNumOfInputs = 0;
+  /// in the order of the first appearance
+  std::vector<std::unique_ptr<TH1>> fHistograms;
+  std::map<std::string, TH1*> fHistogramsByName;
+};
+
+#endif /*  !BATCHTOOLS_H */
@@ -0,0 +1,102 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BatchToolsTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include "BatchTools.h"
+
+BOOST_AUTO_TEST_SUITE(BatchToolsSuite)
+
+BOOST_AUTO_TEST_CASE(parseBatchOptions)
+{
+  const char* argv[] = {"LargeBarrelAnalysisExtended.x", "--batch", "data/*.hld", "-t", "hld",
+                        "--jobs", "4", "-i", "43", "--merged-output", "all.root"
+                       };
+  BatchOptions options;
+  BOOST_REQUIRE(BatchTools::parseBatchOptions(11, argv, options));
+  BOOST_REQUIRE_EQUAL(options.inputFiles, "data/*.hld");
+  BOOST_REQUIRE_EQUAL(options.jobs, 4);
+  BOOST_REQUIRE_EQUAL(options.mergedOutput, "all.root");
+  std::vector<std::string> expected = {"LargeBarrelAnalysisExtended.x", "-t", "hld", "-i", "43"};
+  BOOST_REQUIRE_EQUAL_COLLECTIONS(options.frameworkArgs.begin(), options.frameworkArgs.end(),
+                                  expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(parseBatchOptions_incorrect)
+{
+  const char* missingValue[] = {"program", "--batch"};
+  BatchOptions options;
+  BOOST_REQUIRE(!BatchTools::parseBatchOptions(2, missingValue, options));
+  const char* wrongJobs[] = {"program", "--jobs", "many"};
+  BOOST_REQUIRE(!BatchTools::parseBatchOptions(3, wrongJobs, options));
+}
+
+BOOST_AUTO_TEST_CASE(parseBatchOptions_noBatch)
+{
+  const char* argv[] = {"program", "-t", "hld", "-f", "file.hld"};
+  BatchOptions options;
+  BOOST_REQUIRE(BatchTools::parseBatchOptions(5, argv, options));
+  BOOST_REQUIRE(options.inputFiles.empty());
+  BOOST_REQUIRE_EQUAL(options.frameworkArgs.size(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(expandInputFiles_list)
+{
+  const std::string listFile = "batchToolsTestList.txt";
+  {
+    std::ofstream list(listFile);
+    list << "# run 43\n" << "first.hld\n" << "\n" << "  second.hld  \n" << "third.hld";
+  }
+  auto files = BatchTools::expandInputFiles(listFile);
+  std::vector<std::string> expected = {"first.hld", "second.hld", "third.hld"};
+  BOOST_REQUIRE_EQUAL_COLLECTIONS(files.begin(), files.end(), expected.begin(), expected.end());
+  std::remove(listFile.c_str());
+  BOOST_REQUIRE(BatchTools::expandInputFiles("blabla.txt").empty());
+}
+
+BOOST_AUTO_TEST_CASE(expandInputFiles_glob)
+{
+  std::vector<std::string> expected = {"batchToolsTest_1.hld", "batchToolsTest_2.hld"};
+  for (auto file = expected.rbegin(); file != expected.rend(); ++file) {
+    std::ofstream(*file) << "hld";
+  }
+  auto files = BatchTools::expandInputFiles("batchToolsTest_*.hld");
+  BOOST_REQUIRE_EQUAL_COLLECTIONS(files.begin(), files.end(), expected.begin(), expected.end());
+  for (const auto& file : expected) {
+    std::remove(file.c_str());
+  }
+  BOOST_REQUIRE(BatchTools::expandInputFiles("batchToolsTest_*.hld").empty());
+}
+
+BOOST_AUTO_TEST_CASE(splitIntoRounds)
+{
+  std::vector<std::string> files = {"a", "b", "c", "d", "e"};
+  auto rounds = BatchTools::splitIntoRounds(files, 2);
+  BOOST_REQUIRE_EQUAL(rounds.size(), 3u);
+  BOOST_REQUIRE_EQUAL(rounds.at(0).size(), 2u);
+  BOOST_REQUIRE_EQUAL(rounds.at(2).size(), 1u);
+  BOOST_REQUIRE_EQUAL(rounds.at(2).at(0), "e");
+  BOOST_REQUIRE_EQUAL(BatchTools::splitIntoRounds(files, 0).size(), 5u);
+  BOOST_REQUIRE(BatchTools::splitIntoRounds({}, 4).empty());
+}
+
+BOOST_AUTO_TEST_CASE(getRoundArgs)
+{
+  BatchOptions options;
+  options.frameworkArgs = {"program", "-t", "hld"};
+  auto args = BatchTools::getRoundArgs(options, {"a.hld", "b.hld"});
+  std::vector<std::string> expected = {"program", "-t", "hld", "-f", "a.hld", "b.hld"};
+  BOOST_REQUIRE_EQUAL_COLLECTIONS(args.begin(), args.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(getSetupKey)
+{
+  std::map<std::string, std::string> opts = {{"localDB", "large_barrel.json"}, {"runId", "43"}};
+  auto key = BatchTools::getSetupKey(opts);
+  opts["runId"] = "44";
+  BOOST_REQUIRE(BatchTools::getSetupKey(opts) != key);
+  BOOST_REQUIRE_EQUAL(BatchTools::getSetupKey({}), "|");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,209 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file BenchmarkTools.h
+ *  @brief Minimal harness shared by the *Benchmark.cpp microbenchmarks.
+ */
+
+#ifndef BENCHMARKTOOLS_H
+#define BENCHMARKTOOLS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Keeps the compiler from removing the computation of the value.
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief State of one run of a benchmark, used as
+ *   state.setObjectsPerIteration(signals.size());
+ *   while (state.keepRunning()) {
+ *     doNotOptimize(buildSignals(signals));
+ *   }
+ * Only the loop is timed, so the data can be prepared before it.
+ */
+class BenchmarkState
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  BenchmarkState(long long parameter, unsigned long iterations):
+    fParameter(parameter), fIterations(std::max(1ul, iterations)), fRemaining(fIterations) {}
+
+  bool keepRunning()
+  {
+    if (!fStarted) {
+      fStarted = true;
+      fStart = Clock::now();
+    }
+    if (fRemaining == 0) {
+      fElapsed = std::chrono::duration<double>(Clock::now() - fStart).count();
+      return false;
+    }
+    fRemaining--;
+    return true;
+  }
+
+  /// e.g. the multiplicity the benchmark is run for
+  long long getParameter() const
+  {
+    return fParameter;
+  }
+
+  /// The results are given per object, e.g. per Signal Channel or per hit.
+  void setObjectsPerIteration(double objects)
+  {
+    fObjectsPerIteration = objects;
+  }
+
+  double getObjectsPerIteration() const
+  {
+    return fObjectsPerIteration;
+  }
+
+  unsigned long getIterations() const
+  {
+    return fIterations;
+  }
+
+  /// in seconds
+  double getElapsedTime() const
+  {
+    return fElapsed;
+  }
+
+  double getNsPerObject() const
+  {
+    return fElapsed * 1.e9 / (fIterations * std::max(1., fObjectsPerIteration));
+  }
+
+private:
+  long long fParameter;
+  unsigned long fIterations;
+  unsigned long fRemaining;
+  bool fStarted = false;
+  Clock::time_point fStart;
+  double fElapsed = 0.;
+  double fObjectsPerIteration = 1.;
+};
+
+/**
+ * @brief Runs the benchmarks for the given parameters and prints the ns per object.
+ *
+ * The number of iterations is increased until one run takes the minimal time,
+ * then the run is repeated and the median and the minimum over the repetitions
+ * are printed, so the numbers of different commits can be compared.
+ * Options of the benchmark executables:
+ *   --filter <text>      run only the benchmarks with the text in "name/parameter"
+ *   --min-time <s>       minimal time of one run (0.2 s)
+ *   --repetitions <n>    number of the measured runs (5)
+ *   --csv                print the results as comma separated values
+ */
+class BenchmarkRunner
+{
+public:
+  typedef std::function<void(BenchmarkState&)> Function;
+
+  BenchmarkRunner(int argc, char* argv[])
+  {
+    for (int i = 1; i < argc; i++) {
+      std::string option = argv[i];
+      if (option == "--csv") {
+        fCSV = true;
+      } else if (option == "--filter" && i + 1 < argc) {
+        fFilter = argv[++i];
+      } else if (option == "--min-time" && i + 1 < argc) {
+        fMinTime = std::atof(argv[++i]);
+      } else if (option == "--repetitions" && i + 1 < argc) {
+        fRepetitions = std::max(1, std::atoi(argv[++i]));
+      } else {
+        std::cerr << "Unknown option " << option << ", the options are:"
+                  << " --filter <text> --min-time <s> --repetitions <n> --csv" << std::endl;
+        std::exit(1);
+      }
+    }
+  }
+
+  void run(const std::string& name, const std::vector<long long>& parameters, const Function& function)
+  {
+    for (long long parameter : parameters) {
+      std::string fullName = name + "/" + std::to_string(parameter);
+      if (fullName.find(fFilter) == std::string::npos) {
+        continue;
+      }
+      unsigned long iterations = 1;
+      while (true) {
+        BenchmarkState state(parameter, iterations);
+        function(state);
+        if (state.getElapsedTime() >= fMinTime || iterations >= kMaxIterations) {
+          break;
+        }
+        /// aim 20% above the minimal time, growing at most 10 times per step
+        double factor = state.getElapsedTime() > 0. ? 1.2 * fMinTime / state.getElapsedTime() : 10.;
+        iterations = std::min(kMaxIterations,
+                              static_cast<unsigned long>(iterations * std::min(10., std::max(factor, 1.5))));
+      }
+      std::vector<double> results;
+      double objectsPerIteration = 0.;
+      for (int i = 0; i < fRepetitions; i++) {
+        BenchmarkState state(parameter, iterations);
+        function(state);
+        results.push_back(state.getNsPerObject());
+        objectsPerIteration = state.getObjectsPerIteration();
+      }
+      std::sort(results.begin(), results.end());
+      print(fullName, results[results.size() / 2], results.front(), objectsPerIteration, iterations);
+    }
+  }
+
+private:
+  void print(const std::string& name, double median, double minimum, double objects, unsigned long iterations)
+  {
+    if (!fHeaderPrinted) {
+      fHeaderPrinted = true;
+      if (fCSV) {
+        std::cout << "name,ns_per_object_median,ns_per_object_min,objects_per_iteration,iterations" << std::endl;
+      } else {
+        std::cout << std::left << std::setw(48) << "benchmark" << std::right
+                  << std::setw(14) << "ns/object" << std::setw(14) << "min" << std::setw(14) << "objects"
+                  << std::setw(12) << "iterations" << std::endl;
+      }
+    }
+    if (fCSV) {
+      std::cout << name << "," << median << "," << minimum << "," << objects << "," << iterations << std::endl;
+      return;
+    }
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(14) << median << std::setw(14) << minimum << std::setprecision(0)
+              << std::setw(14) << objects << std::setw(12) << iterations << std::endl;
+  }
+
+  static const unsigned long kMaxIterations = 1000000000ul;
+  std::string fFilter;
+  double fMinTime = 0.2;
+  int fRepetitions = 5;
+  bool fCSV = false;
+  bool fHeaderPrinted = false;
+};
+
+#endif /*  !BENCHMARKTOOLS_H */
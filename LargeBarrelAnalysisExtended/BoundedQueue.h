@@ -0,0 +1,174 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file BoundedQueue.h
+ *  @brief Lock-free single producer, single consumer queue with occupancy counters.
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// Counters describing how a BoundedQueue was used.
+/// Occupancy is sampled every time an element is pushed.
+struct BoundedQueueStats {
+  uint64_t pushed = 0;
+  uint64_t maxOccupancy = 0;
+  uint64_t occupancySum = 0;
+  uint64_t producerStalls = 0; /// number of times the producer waited because the queue was full
+  uint64_t consumerStalls = 0; /// number of times the consumer waited because the queue was empty
+  double getMeanOccupancy() const
+  {
+    return pushed > 0 ? static_cast<double>(occupancySum) / pushed : 0.;
+  }
+};
+
+/**
+ * @brief Fixed capacity ring buffer connecting exactly one producer thread
+ * with exactly one consumer thread.
+ *
+ * push() blocks (yielding the cpu) while the queue is full, which gives the
+ * backpressure on the producer. pop() blocks while the queue is empty and
+ * returns false once the queue was closed by the producer and all the elements
+ * were consumed. The counters are updated only by the thread owning them:
+ * the producer side ones by the producer and the consumer side ones by the consumer,
+ * so they should be read after both threads are finished.
+ */
+template <class T>
+class BoundedQueue
+{
+public:
+  /// Capacity is rounded up to the power of two.
+  explicit BoundedQueue(std::size_t capacity);
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  void push(const T& value);
+  bool pop(T& value);
+  /// Called by the producer after the last push().
+  void close();
+  std::size_t getCapacity() const;
+  std::size_t getOccupancy() const;
+  const BoundedQueueStats& getStats() const;
+
+private:
+  static std::size_t roundUpToPowerOfTwo(std::size_t value);
+
+  /// Padding keeps the indices written by different threads in separate cache lines.
+  static const std::size_t kCacheLineSize = 64;
+  std::vector<T> fBuffer;
+  const std::size_t fMask;
+  char fPadding0[kCacheLineSize];
+  std::atomic<std::size_t> fHead; /// next element to pop, written by consumer
+  char fPadding1[kCacheLineSize];
+  std::atomic<std::size_t> fTail; /// next free slot, written by producer
+  char fPadding2[kCacheLineSize];
+  std::atomic<bool> fClosed;
+  BoundedQueueStats fStats;
+};
+
+template <class T>
+BoundedQueue<T>::BoundedQueue(std::size_t capacity):
+  fBuffer(roundUpToPowerOfTwo(capacity)),
+  fMask(fBuffer.size() - 1),
+  fHead(0),
+  fTail(0),
+  fClosed(false) {}
+
+template <class T>
+void BoundedQueue<T>::push(const T& value)
+{
+  const auto tail = fTail.load(std::memory_order_relaxed);
+  auto head = fHead.load(std::memory_order_acquire);
+  if (tail - head == fBuffer.size()) {
+    fStats.producerStalls++;
+    while (tail - head == fBuffer.size()) {
+      std::this_thread::yield();
+      head = fHead.load(std::memory_order_acquire);
+    }
+  }
+  fBuffer[tail & fMask] = value;
+  fTail.store(tail + 1, std::memory_order_release);
+  const uint64_t occupancy = tail + 1 - head;
+  fStats.pushed++;
+  fStats.occupancySum += occupancy;
+  if (occupancy > fStats.maxOccupancy) {
+    fStats.maxOccupancy = occupancy;
+  }
+}
+
+template <class T>
+bool BoundedQueue<T>::pop(T& value)
+{
+  const auto head = fHead.load(std::memory_order_relaxed);
+  auto tail = fTail.load(std::memory_order_acquire);
+  if (head == tail) {
+    fStats.consumerStalls++;
+    while (head == tail) {
+      /// fClosed must be read before the last look at fTail,
+      /// otherwise the elements pushed just before close() could be lost.
+      if (fClosed.load(std::memory_order_acquire)) {
+        tail = fTail.load(std::memory_order_acquire);
+        if (head == tail) {
+          return false;
+        }
+        break;
+      }
+      std::this_thread::yield();
+      tail = fTail.load(std::memory_order_acquire);
+    }
+  }
+  value = fBuffer[head & fMask];
+  fHead.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+void BoundedQueue<T>::close()
+{
+  fClosed.store(true, std::memory_order_release);
+}
+
+template <class T>
+std::size_t BoundedQueue<T>::getCapacity() const
+{
+  return fBuffer.size();
+}
+
+template <class T>
+std::size_t BoundedQueue<T>::getOccupancy() const
+{
+  return fTail.load(std::memory_order_acquire) - fHead.load(std::memory_order_acquire);
+}
+
+template <class T>
+const BoundedQueueStats& BoundedQueue<T>::getStats() const
+{
+  return fStats;
+}
+
+template <class T>
+std::size_t BoundedQueue<T>::roundUpToPowerOfTwo(std::size_t value)
+{
+  std::size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+#endif /*  !BOUNDEDQUEUE_H */
@@ -0,0 +1,220 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file CompactHits.cpp
+ */
+
+#include <JPetHit/JPetHit.h>
+#include <JPetLoggerInclude.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TTree.h>
+#include "CompactHits.h"
+
+namespace
+{
+
+const char* const kTreeName = "CompactHits";
+
+/// Branch name, ROOT leaf type and the member of CompactHit of every column.
+struct Column {
+  const char* name;
+  const char* leafType;
+  void* (*getAddress)(CompactHit& hit);
+};
+
+const Column kColumns[] = {
+  {"time", "D", [](CompactHit & hit) -> void* { return &hit.time; }},
+  {"timeDiff", "F", [](CompactHit & hit) -> void* { return &hit.timeDiff; }},
+  {"posX", "F", [](CompactHit & hit) -> void* { return &hit.posX; }},
+  {"posY", "F", [](CompactHit & hit) -> void* { return &hit.posY; }},
+  {"posZ", "F", [](CompactHit & hit) -> void* { return &hit.posZ; }},
+  {"energy", "F", [](CompactHit & hit) -> void* { return &hit.energy; }},
+  {"scinID", "I", [](CompactHit & hit) -> void* { return &hit.scinID; }},
+  {"timeWindowIndex", "I", [](CompactHit & hit) -> void* { return &hit.timeWindowIndex; }}
+};
+
+const Column* findColumn(const std::string& name)
+{
+  for (const auto& column : kColumns) {
+    if (name == column.name) {
+      return &column;
+    }
+  }
+  return nullptr;
+}
+
+}
+
+CompactHit CompactHit::fromHit(const JPetHit& hit, int timeWindowIndex)
+{
+  CompactHit compact;
+  compact.time = hit.getTime();
+  compact.timeDiff = hit.getTimeDiff();
+  compact.posX = hit.getPosX();
+  compact.posY = hit.getPosY();
+  compact.posZ = hit.getPosZ();
+  compact.energy = hit.getEnergy();
+  compact.scinID = hit.getScintillator().getID();
+  compact.timeWindowIndex = timeWindowIndex;
+  return compact;
+}
+
+CompactHitWriter::CompactHitWriter() {}
+
+CompactHitWriter::~CompactHitWriter()
+{
+  close();
+}
+
+bool CompactHitWriter::open(const std::string& fileName)
+{
+  close();
+  /// the new file becomes the current directory, the histograms and trees created
+  /// later by the other tasks must not be attached to it
+  TDirectory::TContext context;
+  fFile.reset(new TFile(fileName.c_str(), "RECREATE"));
+  if (fFile->IsZombie()) {
+    ERROR("Can not create the file for the compact hits: " + fileName);
+    fFile.reset();
+    return false;
+  }
+  fTree = new TTree(kTreeName, "Reconstructed hits");
+  fTree->SetDirectory(fFile.get());
+  for (const auto& column : kColumns) {
+    fTree->Branch(column.name, column.getAddress(fBuffer),
+                  (std::string(column.name) + "/" + column.leafType).c_str());
+  }
+  fNumOfHits = 0;
+  return true;
+}
+
+void CompactHitWriter::write(const CompactHit& hit)
+{
+  fBuffer = hit;
+  fTree->Fill();
+  fNumOfHits++;
+}
+
+void CompactHitWriter::close()
+{
+  if (!fFile) {
+    return;
+  }
+  {
+    TDirectory::TContext context(fFile.get());
+    fTree->Write();
+    fFile->Close();
+  }
+  fFile.reset();
+  fTree = nullptr;
+}
+
+bool CompactHitWriter::isOpen() const
+{
+  return fFile != nullptr;
+}
+
+long long CompactHitWriter::getNumOfHits() const
+{
+  return fNumOfHits;
+}
+
+std::string CompactHitWriter::getFileName(const std::string& inputFile)
+{
+  auto slashPos = inputFile.find_last_of('/');
+  auto nameStart = (slashPos == std::string::npos) ? 0 : slashPos + 1;
+  return inputFile.substr(0, inputFile.find('.', nameStart)) + ".hits.compact.root";
+}
+
+CompactHitReader::CompactHitReader() {}
+
+CompactHitReader::~CompactHitReader()
+{
+  close();
+}
+
+bool CompactHitReader::open(const std::string& fileName, const std::vector<std::string>& columns)
+{
+  close();
+  std::vector<const Column*> selected;
+  for (const auto& name : columns.empty() ? getColumnNames() : columns) {
+    auto column = findColumn(name);
+    if (!column) {
+      ERROR("Unknown column of the compact hits: " + name);
+      return false;
+    }
+    selected.push_back(column);
+  }
+  /// the file is not left as the current directory, as in the writer
+  TDirectory::TContext context;
+  fFile.reset(new TFile(fileName.c_str(), "READ"));
+  if (fFile->IsZombie()) {
+    ERROR("Can not open the file with the compact hits: " + fileName);
+    fFile.reset();
+    return false;
+  }
+  fTree = dynamic_cast<TTree*>(fFile->Get(kTreeName));
+  if (!fTree) {
+    ERROR(std::string("No tree ") + kTreeName + " in the file " + fileName);
+    close();
+    return false;
+  }
+  fBuffer = CompactHit();
+  fTree->SetBranchStatus("*", 0);
+  for (auto column : selected) {
+    fTree->SetBranchStatus(column->name, 1);
+    fTree->SetBranchAddress(column->name, column->getAddress(fBuffer));
+  }
+  return true;
+}
+
+void CompactHitReader::close()
+{
+  if (fFile) {
+    fFile->Close();
+  }
+  fFile.reset();
+  fTree = nullptr;
+}
+
+bool CompactHitReader::isOpen() const
+{
+  return fFile != nullptr;
+}
+
+long long CompactHitReader::getNumOfHits() const
+{
+  return fTree ? fTree->GetEntries() : 0;
+}
+
+bool CompactHitReader::read(long long index, CompactHit& hit)
+{
+  if (index < 0 || index >= getNumOfHits()) {
+    return false;
+  }
+  fTree->GetEntry(index);
+  hit = fBuffer;
+  return true;
+}
+
+const std::vector<std::string>& CompactHitReader::getColumnNames()
+{
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> result;
+    for (const auto& column : kColumns) {
+      result.push_back(column.name);
+    }
+    return result;
+  }();
+  return names;
+}
@@ -0,0 +1,114 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file CompactHits.h
+ *  @brief Compact columnar stream of the reconstructed hits.
+ */
+
+#ifndef COMPACTHITS_H
+#define COMPACTHITS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class JPetHit;
+class TFile;
+class TTree;
+
+/**
+ * @brief Hit reduced to the quantities used by the event building and categorization,
+ * without the signals it was built from.
+ *
+ * The barrel slot, layer and theta of the hit are given by the scintillator ID
+ * and can be taken from the parameter bank.
+ */
+struct CompactHit {
+  double time = 0.; /// ps
+  float timeDiff = 0.f; /// ps
+  float posX = 0.f; /// cm
+  float posY = 0.f; /// cm
+  float posZ = 0.f; /// cm
+  float energy = 0.f;
+  int32_t scinID = 0;
+  int32_t timeWindowIndex = 0;
+
+  static CompactHit fromHit(const JPetHit& hit, int timeWindowIndex);
+};
+
+/**
+ * @brief Writes the CompactHit objects to the tree "CompactHits" with one branch per column.
+ *
+ * Every column is stored and compressed separately, so a reader which needs
+ * e.g. only the times and the time window indices reads only these baskets.
+ * The current ROOT directory (gDirectory) is not changed by open and close.
+ */
+class CompactHitWriter
+{
+public:
+  CompactHitWriter();
+  ~CompactHitWriter();
+  /// Creates the file, false if it can not be created.
+  bool open(const std::string& fileName);
+  void write(const CompactHit& hit);
+  /// Writes the tree and closes the file.
+  void close();
+  bool isOpen() const;
+  long long getNumOfHits() const;
+  /// <input file name without extensions>.hits.compact.root
+  static std::string getFileName(const std::string& inputFile);
+
+private:
+  CompactHitWriter(const CompactHitWriter&);
+  void operator=(const CompactHitWriter&);
+
+  std::unique_ptr<TFile> fFile;
+  /// owned by fFile
+  TTree* fTree = nullptr;
+  CompactHit fBuffer;
+  long long fNumOfHits = 0;
+};
+
+/**
+ * @brief Reads the selected columns of the hits written by the CompactHitWriter.
+ *
+ * The columns which are not selected are not read from the file and keep
+ * their default values in the returned hits.
+ */
+class CompactHitReader
+{
+public:
+  CompactHitReader();
+  ~CompactHitReader();
+  /// Opens the file with the given columns, all of them if none is given.
+  /// False if the file or the tree does not exist or a column is unknown.
+  bool open(const std::string& fileName, const std::vector<std::string>& columns = {});
+  void close();
+  bool isOpen() const;
+  long long getNumOfHits() const;
+  /// Reads the hit with the given index, false if out of range.
+  bool read(long long index, CompactHit& hit);
+  /// Names of the branches: time, timeDiff, posX, posY, posZ, energy, scinID, timeWindowIndex.
+  static const std::vector<std::string>& getColumnNames();
+
+private:
+  CompactHitReader(const CompactHitReader&);
+  void operator=(const CompactHitReader&);
+
+  std::unique_ptr<TFile> fFile;
+  /// owned by fFile
+  TTree* fTree = nullptr;
+  CompactHit fBuffer;
+};
+
+#endif /*  !COMPACTHITS_H */
@@ -0,0 +1,134 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CompactHitsTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <JPetHit/JPetHit.h>
+#include <JPetScin/JPetScin.h>
+#include <TDirectory.h>
+#include "CompactHits.h"
+
+const std::string kCompactFile = "compactHitsTest.hits.compact.root";
+
+JPetHit createHit(double time, int scinID)
+{
+  JPetHit hit;
+  hit.setTime(time);
+  hit.setTimeDiff(-250.);
+  hit.setPosX(10.5);
+  hit.setPosY(-20.25);
+  hit.setPosZ(3.);
+  hit.setEnergy(300.);
+  hit.setScintillator(JPetScin(scinID));
+  return hit;
+}
+
+void writeHits(int numOfHits)
+{
+  CompactHitWriter writer;
+  BOOST_REQUIRE(writer.open(kCompactFile));
+  for (int i = 0; i < numOfHits; i++) {
+    writer.write(CompactHit::fromHit(createHit(1000. * i, i + 1), i / 2));
+  }
+  BOOST_REQUIRE_EQUAL(writer.getNumOfHits(), numOfHits);
+  writer.close();
+  BOOST_REQUIRE(!writer.isOpen());
+}
+
+BOOST_AUTO_TEST_SUITE(CompactHitsSuite)
+
+BOOST_AUTO_TEST_CASE(fromHit)
+{
+  auto compact = CompactHit::fromHit(createHit(123456789.5, 17), 4);
+  BOOST_REQUIRE_CLOSE(compact.time, 123456789.5, 1.e-9);
+  BOOST_REQUIRE_CLOSE(compact.timeDiff, -250.f, 0.001);
+  BOOST_REQUIRE_CLOSE(compact.posX, 10.5f, 0.001);
+  BOOST_REQUIRE_CLOSE(compact.posY, -20.25f, 0.001);
+  BOOST_REQUIRE_CLOSE(compact.posZ, 3.f, 0.001);
+  BOOST_REQUIRE_CLOSE(compact.energy, 300.f, 0.001);
+  BOOST_REQUIRE_EQUAL(compact.scinID, 17);
+  BOOST_REQUIRE_EQUAL(compact.timeWindowIndex, 4);
+}
+
+BOOST_AUTO_TEST_CASE(writeAndReadAllColumns)
+{
+  writeHits(5);
+  CompactHitReader reader;
+  BOOST_REQUIRE(reader.open(kCompactFile));
+  BOOST_REQUIRE_EQUAL(reader.getNumOfHits(), 5);
+  CompactHit hit;
+  BOOST_REQUIRE(reader.read(3, hit));
+  BOOST_REQUIRE_CLOSE(hit.time, 3000., 1.e-9);
+  BOOST_REQUIRE_CLOSE(hit.posY, -20.25f, 0.001);
+  BOOST_REQUIRE_CLOSE(hit.energy, 300.f, 0.001);
+  BOOST_REQUIRE_EQUAL(hit.scinID, 4);
+  BOOST_REQUIRE_EQUAL(hit.timeWindowIndex, 1);
+  BOOST_REQUIRE(!reader.read(5, hit));
+  BOOST_REQUIRE(!reader.read(-1, hit));
+  reader.close();
+  std::remove(kCompactFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(readSelectedColumns)
+{
+  writeHits(4);
+  CompactHitReader reader;
+  BOOST_REQUIRE(reader.open(kCompactFile, {"time", "timeWindowIndex"}));
+  CompactHit hit;
+  BOOST_REQUIRE(reader.read(2, hit));
+  BOOST_REQUIRE_CLOSE(hit.time, 2000., 1.e-9);
+  BOOST_REQUIRE_EQUAL(hit.timeWindowIndex, 1);
+  /// the columns not selected are not read
+  BOOST_REQUIRE_EQUAL(hit.scinID, 0);
+  BOOST_REQUIRE_EQUAL(hit.energy, 0.f);
+  std::remove(kCompactFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(keepsCurrentDirectory)
+{
+  /// the objects created by the other tasks must not end up in the compact file
+  TDirectory* current = gDirectory;
+  CompactHitWriter writer;
+  BOOST_REQUIRE(writer.open(kCompactFile));
+  BOOST_REQUIRE_EQUAL(gDirectory, current);
+  writer.write(CompactHit::fromHit(createHit(1., 1), 0));
+  writer.close();
+  BOOST_REQUIRE_EQUAL(gDirectory, current);
+  CompactHitReader reader;
+  BOOST_REQUIRE(reader.open(kCompactFile));
+  BOOST_REQUIRE_EQUAL(gDirectory, current);
+  BOOST_REQUIRE_EQUAL(reader.getNumOfHits(), 1);
+  reader.close();
+  BOOST_REQUIRE_EQUAL(gDirectory, current);
+  std::remove(kCompactFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(openIncorrect)
+{
+  CompactHitReader reader;
+  BOOST_REQUIRE(!reader.open("blabla.hits.compact.root"));
+  BOOST_REQUIRE(!reader.isOpen());
+  BOOST_REQUIRE_EQUAL(reader.getNumOfHits(), 0);
+  writeHits(1);
+  BOOST_REQUIRE(!reader.open(kCompactFile, {"time", "theta"}));
+  BOOST_REQUIRE(!reader.isOpen());
+  std::remove(kCompactFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(columnNames)
+{
+  const auto& names = CompactHitReader::getColumnNames();
+  BOOST_REQUIRE_EQUAL(names.size(), 8u);
+  BOOST_REQUIRE_EQUAL(names.front(), "time");
+  BOOST_REQUIRE_EQUAL(names.back(), "timeWindowIndex");
+}
+
+BOOST_AUTO_TEST_CASE(fileName)
+{
+  BOOST_REQUIRE_EQUAL(CompactHitWriter::getFileName("data/dabc_17025151847.hld"),
+                      "data/dabc_17025151847.hits.compact.root");
+  BOOST_REQUIRE_EQUAL(CompactHitWriter::getFileName("../run.1/file.hld.root"),
+                      "../run.1/file.hits.compact.root");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
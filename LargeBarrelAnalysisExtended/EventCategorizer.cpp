@@ -14,12 +14,11 @@
  */
 
 #include <iostream>
-#include <JPetWriter/JPetWriter.h>
 #include "EventCategorizer.h"
 
 using namespace std;
 
-EventCategorizer::EventCategorizer(const char * name, const char * description):JPetTask(name, description){}
+EventCategorizer::EventCategorizer(const char * name, const char * description):PipelineStage(name, description){}
 
 void EventCategorizer::init(const JPetTaskInterface::Options&){
 
@@ -27,72 +26,72 @@ void EventCategorizer::init(const JPetTaskInterface::Options&){
 	INFO("Looking at two hit Events on Layer 1&2 only - creating only control histograms");
 
 	if (fSaveControlHistos){
-		getStatistics().createHistogram(
+		fThetaDiffHisto = registerHistogram(getStatistics(),
 			new TH1F("two_hit_event_theta_diff",
 								"Abs Theta Difference Between Two Hits in Event",
 								360, -0.5, 359.5)
 		);
-		getStatistics().createHistogram(
+		fThetaDiffCutHisto = registerHistogram(getStatistics(),
 			new TH1F("two_hit_event_theta_diff_cut",
 								"Abs Theta Difference Between Opposite Hits in Event",
 								360, -0.5, 359.5)
 		);
-		getStatistics().createHistogram(
+		fPosHistos[0] = registerHistogram(getStatistics(),
 			new TH1F("hits_x_pos",
 								"Hits X position",
 								100, -60.0, 60.0)
 		);
-    getStatistics().createHistogram(
+    fPosHistos[1] = registerHistogram(getStatistics(),
 			new TH1F("hits_y_pos",
 								"Hits Y position",
 								100, -60.0, 60.0)
 		);
-		getStatistics().createHistogram(
+		fPosHistos[2] = registerHistogram(getStatistics(),
 			new TH1F("hits_z_pos",
 								"Hits Z position",
 								100, -60.0, 60.0)
 		);
-		getStatistics().createHistogram(
+		fPosCutHistos[0] = registerHistogram(getStatistics(),
 			new TH1F("hits_x_pos_cut",
 								"Opposite Hits X position",
 								100, -60.0, 60.0)
 		);
-    getStatistics().createHistogram(
+    fPosCutHistos[1] = registerHistogram(getStatistics(),
 			new TH1F("hits_y_pos_cut",
 								"Opposite Hits Y position",
 								100, -60.0, 60.0)
 		);
-		getStatistics().createHistogram(
+		fPosCutHistos[2] = registerHistogram(getStatistics(),
 			new TH1F("hits_z_pos_cut",
 								"Opposite Hits Z position",
 								100, -60.0, 60.0)
 		);
-		getStatistics().createHistogram(
+		fDistanceVsTimeDiffHisto = registerHistogram(getStatistics(),
 			new TH2F("hit_distanece_vs_time_diff",
 								"Two Hit distance vs. abs time difference",
 								100, 0.0, 150.0,
 								100, 0.0, 6000.0)
 		);
-		getStatistics().createHistogram(
+		fDistanceVsThetaDiffHisto = registerHistogram(getStatistics(),
 			new TH2F("hit_distanece_vs_theta_diff",
 								"Two Hit distance vs. abs theta difference",
 								100, 0.0, 150.0,
 								360, -0.5, 359.5)
 		);
-		getStatistics().createHistogram(
+		fDistanceVsTimeDiffCutHisto = registerHistogram(getStatistics(),
 			new TH2F("hit_distanece_vs_time_diff_cut",
 								"Opposite Hits distance vs. abs time difference",
 								100, 0.0, 150.0,
 								100, 0.0, 6000.0)
 		);
-		getStatistics().createHistogram(
+		fDistanceVsThetaDiffCutHisto = registerHistogram(getStatistics(),
 			new TH2F("hit_distanece_vs_theta_diff_cut",
 								"Opposite Hit distance vs. abs theta difference",
 								100, 0.0, 150.0,
 								360, -0.5, 359.5)
 		);
 
-		getStatistics().createHistogram(
+		fThreeHitAnglesHisto = registerHistogram(getStatistics(),
 			new TH2F("3_hit_angles",
 								"3 Hit angles difference 1-2, 2-3",
 								360, -0.5, 359.5,
@@ -106,97 +105,60 @@ void EventCategorizer::exec(){
 	//Analysis of Events consisting of two hits that come from Layer 1 or 2
 	//Layer 3 is ignored, since it is not callibrated
 	if(auto event = dynamic_cast<const JPetEvent*const>(getEvent())){
-		if(event->getHits().size() > 1){
-
-		  vector<JPetHit> hits = event->getHits();
-		  for(int i=0;i<hits.size();i++){
-		    for(int j=i+1;j<hits.size();j++){
-          JPetHit firstHit = hits.at(i);
-			    JPetHit secondHit = hits.at(j);
-
-          if(firstHit.getBarrelSlot().getLayer().getID()!=3
-            && secondHit.getBarrelSlot().getLayer().getID()!=3){
-
-            float thetaDiff = fabs(firstHit.getBarrelSlot().getTheta()
-              -secondHit.getBarrelSlot().getTheta());
-            float timeDiff = fabs(firstHit.getTime()-secondHit.getTime());
-            float distance = sqrt(pow(firstHit.getPosX()-secondHit.getPosX(),2)
-              +pow(firstHit.getPosY()-secondHit.getPosY(),2)
-              +pow(firstHit.getPosZ()-secondHit.getPosZ(),2));
-
-            if (fSaveControlHistos){
-              getStatistics().getHisto1D("two_hit_event_theta_diff")
-                .Fill(thetaDiff);
-              getStatistics().getHisto1D("hits_x_pos")
-                .Fill(firstHit.getPosX());
-              getStatistics().getHisto1D("hits_y_pos")
-                .Fill(firstHit.getPosY());
-              getStatistics().getHisto1D("hits_z_pos")
-                .Fill(firstHit.getPosZ());
-              getStatistics().getHisto1D("hits_x_pos")
-                .Fill(secondHit.getPosX());
-              getStatistics().getHisto1D("hits_y_pos")
-                .Fill(secondHit.getPosY());
-              getStatistics().getHisto1D("hits_z_pos")
-                .Fill(secondHit.getPosZ());
-              getStatistics().getHisto2D("hit_distanece_vs_time_diff")
-                .Fill(distance,timeDiff);
-              getStatistics().getHisto2D("hit_distanece_vs_theta_diff")
-                .Fill(distance,thetaDiff);
-              if(thetaDiff>=180.0 && thetaDiff<181.0){
-                getStatistics().getHisto1D("two_hit_event_theta_diff_cut")
-                  .Fill(thetaDiff);
-               getStatistics().getHisto1D("hits_x_pos_cut")
-                 .Fill(firstHit.getPosX());
-                getStatistics().getHisto1D("hits_y_pos_cut")
-                  .Fill(firstHit.getPosY());
-                getStatistics().getHisto1D("hits_z_pos_cut")
-                  .Fill(firstHit.getPosZ());
-                getStatistics().getHisto1D("hits_x_pos_cut")
-                 .Fill(secondHit.getPosX());
-                getStatistics().getHisto1D("hits_y_pos_cut")
-                  .Fill(secondHit.getPosY());
-                getStatistics().getHisto1D("hits_z_pos_cut")
-                  .Fill(secondHit.getPosZ());
-                getStatistics().getHisto2D("hit_distanece_vs_time_diff_cut")
-                  .Fill(distance,timeDiff);
-                getStatistics().getHisto2D("hit_distanece_vs_theta_diff_cut")
-                  .Fill(distance,thetaDiff);
-              }
-            }
-          }
-		    }
-		  }
+		const auto& hits = event->getHits();
+		if(hits.size() > 1 && fSaveControlHistos){
+			fHitsBlock.fill(hits, 3);
+			for(std::size_t i = 0; i < fHitsBlock.size(); i++){
+				fHitsBlock.computePairs(i, fPairsBlock);
+				for(std::size_t k = 0; k < fPairsBlock.size(); k++){
+					fillPairHistos(i, i + k + 1, fPairsBlock.thetaDiffs[k],
+						fPairsBlock.timeDiffs[k], fPairsBlock.distances[k]);
+				}
+			}
 		}
 
-		if(event->getHits().size() == 3){
-          JPetHit firstHit = event->getHits().at(0);
-          JPetHit secondHit = event->getHits().at(1);
-          JPetHit thirdHit = event->getHits().at(2);
-
-          float theta_1_2 = fabs(firstHit.getBarrelSlot().getTheta()
-            -secondHit.getBarrelSlot().getTheta());
-          float theta_2_3 = fabs(secondHit.getBarrelSlot().getTheta()
-            -thirdHit.getBarrelSlot().getTheta());
-
-          getStatistics().getHisto2D("3_hit_angles")
-                  .Fill(theta_1_2,theta_2_3);
+		if(hits.size() == 3 && fSaveControlHistos){
+			float theta_1_2 = fabs(hits[0].getBarrelSlot().getTheta()
+				-hits[1].getBarrelSlot().getTheta());
+			float theta_2_3 = fabs(hits[1].getBarrelSlot().getTheta()
+				-hits[2].getBarrelSlot().getTheta());
+			fThreeHitAnglesHisto->Fill(theta_1_2,theta_2_3);
 		}
 	}
 }
 
+void EventCategorizer::fillPairHistos(std::size_t first, std::size_t second,
+	float thetaDiff, float timeDiff, float distance){
+
+	const double pos1[] = {fHitsBlock.posX[first], fHitsBlock.posY[first], fHitsBlock.posZ[first]};
+	const double pos2[] = {fHitsBlock.posX[second], fHitsBlock.posY[second], fHitsBlock.posZ[second]};
+	fThetaDiffHisto->Fill(thetaDiff);
+	for(int axis = 0; axis < 3; axis++)
+		fPosHistos[axis]->Fill(pos1[axis]);
+	for(int axis = 0; axis < 3; axis++)
+		fPosHistos[axis]->Fill(pos2[axis]);
+	fDistanceVsTimeDiffHisto->Fill(distance,timeDiff);
+	fDistanceVsThetaDiffHisto->Fill(distance,thetaDiff);
+	if(thetaDiff>=180.0 && thetaDiff<181.0){
+		fThetaDiffCutHisto->Fill(thetaDiff);
+		for(int axis = 0; axis < 3; axis++)
+			fPosCutHistos[axis]->Fill(pos1[axis]);
+		for(int axis = 0; axis < 3; axis++)
+			fPosCutHistos[axis]->Fill(pos2[axis]);
+		fDistanceVsTimeDiffCutHisto->Fill(distance,timeDiff);
+		fDistanceVsThetaDiffCutHisto->Fill(distance,thetaDiff);
+	}
+}
+
 void EventCategorizer::terminate(){
 
 	INFO("More than one hit Events done. Writing conrtrol histograms.");
 
 }
 
-void EventCategorizer::setWriter(JPetWriter* writer) { fWriter = writer; }
-
 void EventCategorizer::saveEvents(const vector<JPetEvent>& events)
 {
-	assert(fWriter);
 	for (const auto & event : events) {
-		fWriter->write(event);
+		forward(event);
 	}
 }
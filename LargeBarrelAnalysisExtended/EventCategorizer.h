@@ -18,27 +18,38 @@
 
 #include <vector>
 #include <map>
-#include <JPetTask/JPetTask.h>
 #include <JPetHit/JPetHit.h>
 #include <JPetEvent/JPetEvent.h>
-
-class JPetWriter;
+#include "EventCategorizerTools.h"
+#include "HistogramHandles.h"
+#include "PipelineStage.h"
 
 #ifdef __CINT__
 #	define override
 #endif
 
-class EventCategorizer : public JPetTask{
+class EventCategorizer : public PipelineStage{
 public:
 	EventCategorizer(const char * name, const char * description);
 	virtual ~EventCategorizer(){}
 	virtual void init(const JPetTaskInterface::Options& opts)override;
 	virtual void exec()override;
 	virtual void terminate()override;
-	virtual void setWriter(JPetWriter* writer)override;
 protected:
-	JPetWriter* fWriter;
 	void saveEvents(const std::vector<JPetEvent>& event);
+	void fillPairHistos(std::size_t first, std::size_t second, float thetaDiff, float timeDiff, float distance);
 	bool fSaveControlHistos = true;
+	/// hits of the current event and the quantities of their pairs, reused between the events
+	EventHitsBlock fHitsBlock;
+	HitPairsBlock fPairsBlock;
+	TH1F* fThetaDiffHisto = nullptr;
+	TH1F* fThetaDiffCutHisto = nullptr;
+	TH1F* fPosHistos[3] = {nullptr, nullptr, nullptr}; /// x, y, z
+	TH1F* fPosCutHistos[3] = {nullptr, nullptr, nullptr};
+	TH2F* fDistanceVsTimeDiffHisto = nullptr;
+	TH2F* fDistanceVsThetaDiffHisto = nullptr;
+	TH2F* fDistanceVsTimeDiffCutHisto = nullptr;
+	TH2F* fDistanceVsThetaDiffCutHisto = nullptr;
+	TH2F* fThreeHitAnglesHisto = nullptr;
 };
 #endif /*  !EVENTCATEGORIZER_H */
@@ -0,0 +1,73 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventCategorizerTools.cpp
+ */
+
+#include <cmath>
+#include "EventCategorizerTools.h"
+
+void EventHitsBlock::fill(const std::vector<JPetHit>& hits, int skippedLayerID)
+{
+  clear();
+  for (const auto& hit : hits) {
+    const auto& slot = hit.getBarrelSlot();
+    if (slot.getLayer().getID() == skippedLayerID) {
+      continue;
+    }
+    thetas.push_back(slot.getTheta());
+    posX.push_back(hit.getPosX());
+    posY.push_back(hit.getPosY());
+    posZ.push_back(hit.getPosZ());
+    times.push_back(hit.getTime());
+  }
+}
+
+void EventHitsBlock::clear()
+{
+  thetas.clear();
+  posX.clear();
+  posY.clear();
+  posZ.clear();
+  times.clear();
+}
+
+void EventHitsBlock::computePairs(std::size_t i, HitPairsBlock& pairs) const
+{
+  const std::size_t numOfPairs = i < size() ? size() - i - 1 : 0;
+  pairs.thetaDiffs.resize(numOfPairs);
+  pairs.timeDiffs.resize(numOfPairs);
+  pairs.distances.resize(numOfPairs);
+  if (numOfPairs == 0) {
+    return;
+  }
+  /// plain loops over the arrays, without branches, so the compiler can vectorize them
+  const float theta = thetas[i];
+  const double x = posX[i], y = posY[i], z = posZ[i], time = times[i];
+  const float* otherThetas = thetas.data() + i + 1;
+  const double* otherX = posX.data() + i + 1;
+  const double* otherY = posY.data() + i + 1;
+  const double* otherZ = posZ.data() + i + 1;
+  const double* otherTimes = times.data() + i + 1;
+  for (std::size_t k = 0; k < numOfPairs; k++) {
+    pairs.thetaDiffs[k] = std::fabs(theta - otherThetas[k]);
+  }
+  for (std::size_t k = 0; k < numOfPairs; k++) {
+    pairs.timeDiffs[k] = std::fabs(time - otherTimes[k]);
+  }
+  for (std::size_t k = 0; k < numOfPairs; k++) {
+    const double dx = x - otherX[k];
+    const double dy = y - otherY[k];
+    const double dz = z - otherZ[k];
+    pairs.distances[k] = std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
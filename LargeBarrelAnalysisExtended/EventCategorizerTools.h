@@ -0,0 +1,56 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventCategorizerTools.h
+ *  @brief Per hit and per pair quantities used to categorize the events.
+ */
+
+#ifndef EVENTCATEGORIZERTOOLS_H
+#define EVENTCATEGORIZERTOOLS_H
+
+#include <vector>
+#include <JPetHit/JPetHit.h>
+
+/// Quantities of the pairs of one hit with the hits following it in the event,
+/// the pair with the k-th following hit is stored at the index k.
+struct HitPairsBlock {
+  std::vector<float> thetaDiffs; /// absolute difference of the slot angles in degrees
+  std::vector<float> timeDiffs; /// absolute time difference in ps
+  std::vector<float> distances; /// distance between the hits in cm
+  std::size_t size() const
+  {
+    return distances.size();
+  }
+};
+
+/// Quantities of the hits of one event needed by the categorization,
+/// stored as parallel arrays, so the pair loops touch no JPetHit object.
+/// The blocks are meant to be reused between the events.
+struct EventHitsBlock {
+  std::vector<float> thetas;
+  std::vector<double> posX;
+  std::vector<double> posY;
+  std::vector<double> posZ;
+  std::vector<double> times;
+
+  /// Fills the block with the hits, leaving out the hits from the layer with skippedLayerID.
+  void fill(const std::vector<JPetHit>& hits, int skippedLayerID);
+  void clear();
+  std::size_t size() const
+  {
+    return times.size();
+  }
+  /// Computes the quantities of the pairs of the hit i with all the hits j > i.
+  void computePairs(std::size_t i, HitPairsBlock& pairs) const;
+};
+
+#endif /*  !EVENTCATEGORIZERTOOLS_H */
@@ -0,0 +1,98 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EventCategorizerToolsTest
+#include <boost/test/unit_test.hpp>
+
+#include <deque>
+#include "EventCategorizerTools.h"
+
+/// Four barrel slots in each of three layers, at 45 degrees plus the layer number.
+struct EventCategorizerToolsFixture {
+  EventCategorizerToolsFixture()
+  {
+    for (int layer = 1; layer <= 3; layer++) {
+      layers.push_back(JPetLayer(layer, true, "layer", 40. + 5. * layer));
+      for (int slot = 0; slot < 4; slot++) {
+        slots.push_back(JPetBarrelSlot(4 * (layer - 1) + slot + 1, true, "slot", 45.f * slot + layer, slot + 1));
+        slots.back().setLayer(layers.back());
+      }
+    }
+  }
+
+  JPetHit createHit(int slotIndex, double x, double y, double z, double time)
+  {
+    JPetHit hit;
+    hit.setBarrelSlot(slots.at(slotIndex));
+    hit.setPosX(x);
+    hit.setPosY(y);
+    hit.setPosZ(z);
+    hit.setTime(time);
+    return hit;
+  }
+
+  std::deque<JPetLayer> layers;
+  std::deque<JPetBarrelSlot> slots;
+};
+
+BOOST_FIXTURE_TEST_SUITE(EventCategorizerToolsSuite, EventCategorizerToolsFixture)
+
+BOOST_AUTO_TEST_CASE(fill_skipsLayer)
+{
+  EventHitsBlock block;
+  block.fill({}, 3);
+  BOOST_REQUIRE_EQUAL(block.size(), 0u);
+  std::vector<JPetHit> hits = {createHit(0, 1., 2., 3., 10.), createHit(9, 0., 0., 0., 20.), createHit(5, 4., 5., 6., 30.)};
+  block.fill(hits, 3);
+  BOOST_REQUIRE_EQUAL(block.size(), 2u);
+  BOOST_REQUIRE_EQUAL(block.thetas[0], slots[0].getTheta());
+  BOOST_REQUIRE_EQUAL(block.thetas[1], slots[5].getTheta());
+  BOOST_REQUIRE_EQUAL(block.posX[1], 4.);
+  BOOST_REQUIRE_EQUAL(block.posY[1], 5.);
+  BOOST_REQUIRE_EQUAL(block.posZ[1], 6.);
+  BOOST_REQUIRE_EQUAL(block.times[1], 30.);
+  /// the block is refilled, not appended to
+  block.fill(hits, 1);
+  BOOST_REQUIRE_EQUAL(block.size(), 2u);
+  BOOST_REQUIRE_EQUAL(block.times[0], 20.);
+}
+
+BOOST_AUTO_TEST_CASE(computePairs)
+{
+  EventHitsBlock block;
+  block.fill({createHit(0, 0., 0., 0., 100.), createHit(2, 3., 4., 12., 40.)}, 3);
+  HitPairsBlock pairs;
+  block.computePairs(0, pairs);
+  BOOST_REQUIRE_EQUAL(pairs.size(), 1u);
+  BOOST_REQUIRE_EQUAL(pairs.thetaDiffs[0], 90.f);
+  BOOST_REQUIRE_EQUAL(pairs.timeDiffs[0], 60.f);
+  BOOST_REQUIRE_EQUAL(pairs.distances[0], 13.f);
+  block.computePairs(1, pairs);
+  BOOST_REQUIRE_EQUAL(pairs.size(), 0u);
+  block.computePairs(5, pairs);
+  BOOST_REQUIRE_EQUAL(pairs.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(computePairs_skippedLayer)
+{
+  EventHitsBlock block;
+  /// the hit in the third layer is left out, the indices refer to the remaining hits
+  block.fill({createHit(0, 0., 0., 0., 100.), createHit(9, 1., 1., 1., 70.),
+              createHit(2, 3., 4., 12., 40.), createHit(5, 6., 8., 0., 100.)
+             }, 3);
+  BOOST_REQUIRE_EQUAL(block.size(), 3u);
+  HitPairsBlock pairs;
+  block.computePairs(0, pairs);
+  BOOST_REQUIRE_EQUAL(pairs.size(), 2u);
+  BOOST_REQUIRE_EQUAL(pairs.thetaDiffs[0], 90.f);
+  BOOST_REQUIRE_EQUAL(pairs.timeDiffs[0], 60.f);
+  BOOST_REQUIRE_EQUAL(pairs.distances[0], 13.f);
+  BOOST_REQUIRE_EQUAL(pairs.thetaDiffs[1], 46.f);
+  BOOST_REQUIRE_EQUAL(pairs.timeDiffs[1], 0.f);
+  BOOST_REQUIRE_EQUAL(pairs.distances[1], 10.f);
+  block.computePairs(1, pairs);
+  BOOST_REQUIRE_EQUAL(pairs.size(), 1u);
+  BOOST_REQUIRE_EQUAL(pairs.thetaDiffs[0], 44.f);
+  BOOST_REQUIRE_EQUAL(pairs.timeDiffs[0], 60.f);
+  BOOST_REQUIRE_CLOSE(pairs.distances[0], std::sqrt(9.f + 16.f + 144.f), 0.0001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
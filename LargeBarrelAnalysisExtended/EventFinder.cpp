@@ -14,12 +14,11 @@
  */
 
 #include <iostream>
-#include <JPetWriter/JPetWriter.h>
 #include "EventFinder.h"
 
 using namespace std;
 
-EventFinder::EventFinder(const char * name, const char * description):JPetTask(name, description){}
+EventFinder::EventFinder(const char * name, const char * description):PipelineStage(name, description){}
 
 void EventFinder::init(const JPetTaskInterface::Options& opts){
 
@@ -27,9 +26,21 @@ void EventFinder::init(const JPetTaskInterface::Options& opts){
 
 	if (opts.count(fEventTimeParamKey))
 		kEventTimeWindow = std::atof(opts.at(fEventTimeParamKey).c_str());
+	if (opts.count(fCrossWindowParamKey))
+		fCrossWindow = opts.at(fCrossWindowParamKey) == "true";
+	if (opts.count(fTimeWindowLengthParamKey))
+		fTimeWindowLength = std::atof(opts.at(fTimeWindowLengthParamKey).c_str());
+	//the hits of the next window are shifted by the window length, there is no safe default
+	if (fCrossWindow && fTimeWindowLength <= 0.) {
+		ERROR(fCrossWindowParamKey + " requires a positive " + fTimeWindowLengthParamKey
+			+ ", the events are built separately in every time window");
+		fCrossWindow = false;
+	}
+	if (fCrossWindow)
+		INFO(Form("Events are built across the time windows of length %f ps.", fTimeWindowLength));
 
 	if (fSaveControlHistos)
-		getStatistics().createHistogram(
+		fHitsPerEventHisto = registerHistogram(getStatistics(),
 			new TH1F("hits_per_event","Number of Hits in Event",20, 0.5, 20.5)
 		);
 }
@@ -39,75 +50,67 @@ void EventFinder::exec(){
 	if(auto hit = dynamic_cast<const JPetHit*const>(getEvent())){
 		if(hit->isSignalASet() && hit->isSignalBSet()){
 			if(hit->getSignalA().getTimeWindowIndex() == hit->getSignalB().getTimeWindowIndex()){
+				int timeWindowIndex = hit->getSignalA().getTimeWindowIndex();
 				if(kFirstTime){
-					kTimeSlotIndex = hit->getSignalA().getTimeWindowIndex();
-					fHitVector.push_back(*hit);
+					kTimeSlotIndex = timeWindowIndex;
 					kFirstTime = false;
-				}else{
-					if(kTimeSlotIndex == hit->getSignalA().getTimeWindowIndex()){
-						fHitVector.push_back(*hit);
-					}else{
-						vector<JPetEvent> events = buildEvents(fHitVector);
-						saveEvents(events);
-						fHitVector.clear();
-						kTimeSlotIndex = hit->getSignalA().getTimeWindowIndex();
-						fHitVector.push_back(*hit);
-					}
+				}else if(kTimeSlotIndex != timeWindowIndex){
+					buildEvents(fCrossWindow);
+					kTimeSlotIndex = timeWindowIndex;
 				}
+				addHit(*hit, timeWindowIndex);
 			}
 		}
 	}
 }
 
-//sorting method
-bool sortByTimeValue(JPetHit hit1, JPetHit hit2) {
-	return (hit1.getTime() < hit2.getTime());
-}
-
-
 void EventFinder::terminate(){
+	/// the hits of the last time window, and of the last event without the time windows coming later
+	if (!fHitVector.empty())
+		buildEvents(false);
 	INFO("Event fiding ended.");
 }
 
-vector<JPetEvent> EventFinder::buildEvents(vector<JPetHit> hitVec){
-
-	vector<JPetEvent> eventVec;
-	sort(hitVec.begin(), hitVec.end(), sortByTimeValue);
-
-	while(hitVec.size()>0){
-
-		JPetEvent event;
-		event.setEventType(JPetEventType::kUnknown);
-
-		event.addHit(hitVec.at(0));
-
-		while(hitVec.size()>1){
-			if(fabs(hitVec.at(1).getTime()-hitVec.at(0).getTime()) < kEventTimeWindow) {
-				event.addHit(hitVec.at(1));
-				hitVec.erase(hitVec.begin() + 1);
-			} else {
-				break;
-			}
-		}
+void EventFinder::addHit(const JPetHit& hit, int timeWindowIndex){
+	fHitVector.push_back(hit);
+	if (fCrossWindow)
+		fHitTimes.push_back(timeWindowIndex * fTimeWindowLength + hit.getTime());
+	else
+		fHitTimes.push_back(hit.getTime());
+}
 
-		hitVec.erase(hitVec.begin() + 0);
+void EventFinder::buildEvents(bool keepLastOpen){
 
-		if (fSaveControlHistos) getStatistics()
-														.getHisto1D("hits_per_event")
-														.Fill(event.getHits().size());
+	EventFinderTools::sortByTime(fHitTimes, fHitOrder);
+	auto used = EventFinderTools::buildEvents(fHitTimes, fHitOrder, kEventTimeWindow, keepLastOpen,
+		[this](EventFinderTools::IndexIterator first, EventFinderTools::IndexIterator last){
+			saveEvent(first, last);
+		});
 
-		eventVec.push_back(event);
+	if (used == fHitOrder.size()) {
+		fHitVector.clear();
+		fHitTimes.clear();
+		return;
 	}
-
-	return eventVec;
+	/// only the hits of the open event are left, so the copy is short
+	vector<JPetHit> openHits;
+	vector<double> openTimes;
+	for (auto index = fHitOrder.begin() + used; index != fHitOrder.end(); ++index) {
+		openHits.push_back(fHitVector[*index]);
+		openTimes.push_back(fHitTimes[*index]);
+	}
+	fHitVector.swap(openHits);
+	fHitTimes.swap(openTimes);
 }
 
-void EventFinder::setWriter(JPetWriter* writer) { fWriter = writer; }
+void EventFinder::saveEvent(EventFinderTools::IndexIterator first, EventFinderTools::IndexIterator last){
+
+	JPetEvent event;
+	event.setEventType(JPetEventType::kUnknown);
+	for (auto index = first; index != last; ++index)
+		event.addHit(fHitVector[*index]);
+
+	if (fSaveControlHistos) fHitsPerEventHisto->Fill(event.getHits().size());
 
-void EventFinder::saveEvents(const vector<JPetEvent>& events)
-{
-  assert(fWriter);
-  for (const auto & event : events) {
-    fWriter->write(event);
-  }
+	forward(event);
 }
@@ -18,33 +18,55 @@
 
 #include <vector>
 #include <map>
-#include <JPetTask/JPetTask.h>
 #include <JPetHit/JPetHit.h>
 #include <JPetEvent/JPetEvent.h>
-
-class JPetWriter;
+#include "EventFinderTools.h"
+#include "HistogramHandles.h"
+#include "PipelineStage.h"
 
 #ifdef __CINT__
 #	define override
 #endif
 
-class EventFinder : public JPetTask{
+/**
+ * @brief Module grouping the hits close in time into events.
+ *
+ * The hits of one time window are collected, ordered by time and grouped
+ * in a single pass (see EventFinderTools::buildEvents), each event is passed
+ * downstream as soon as it is complete.
+ * By default the events are built separately in every time window. With the user
+ * option "EventFinder_CrossWindow":"true" the hits of the consecutive time windows
+ * are put on one time axis, shifted by the window index times the time window length
+ * given by "EventFinder_TimeWindowLength" (in ps), so the event open at the end of
+ * a time window can be completed with the hits of the next one. The length has no
+ * default, without it the cross-window building is switched off with an error.
+ */
+class EventFinder : public PipelineStage{
 public:
 	EventFinder(const char * name, const char * description);
 	virtual ~EventFinder(){}
 	virtual void init(const JPetTaskInterface::Options& opts)override;
 	virtual void exec()override;
 	virtual void terminate()override;
-	virtual void setWriter(JPetWriter* writer)override;
 protected:
   	int kTimeSlotIndex;
   	bool kFirstTime = true;
   	double kEventTimeWindow = 5000.0; //ps
 	const std::string fEventTimeParamKey = "EventFinder_EventTime";
-    	std::vector<JPetHit> fHitVector;
-  	bool fSaveControlHistos = true;
-	JPetWriter* fWriter;
-	void saveEvents(const std::vector<JPetEvent>& event);
-	std::vector<JPetEvent> buildEvents(std::vector<JPetHit> hitVec);
+	const std::string fCrossWindowParamKey = "EventFinder_CrossWindow";
+	const std::string fTimeWindowLengthParamKey = "EventFinder_TimeWindowLength";
+	bool fCrossWindow = false;
+	double fTimeWindowLength = 0.; //ps, must be given with fCrossWindow
+	/// hits waiting for the events, with their times used for the ordering
+	std::vector<JPetHit> fHitVector;
+	std::vector<double> fHitTimes;
+	std::vector<unsigned int> fHitOrder;
+	bool fSaveControlHistos = true;
+	TH1F* fHitsPerEventHisto = nullptr;
+	void addHit(const JPetHit& hit, int timeWindowIndex);
+	/// Builds the events from the collected hits. With keepLastOpen the hits of
+	/// the last event are kept for the next time window, the rest is removed.
+	void buildEvents(bool keepLastOpen);
+	void saveEvent(EventFinderTools::IndexIterator first, EventFinderTools::IndexIterator last);
 };
 #endif /*  !EVENTFINDER_H */
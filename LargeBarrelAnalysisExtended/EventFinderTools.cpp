@@ -0,0 +1,31 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventFinderTools.cpp
+ */
+
+#include <algorithm>
+#include "EventFinderTools.h"
+
+void EventFinderTools::sortByTime(const std::vector<double>& times, std::vector<unsigned int>& order)
+{
+  order.resize(times.size());
+  for (unsigned int i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  auto isEarlier = [&times](unsigned int index1, unsigned int index2) {
+    return times[index1] < times[index2];
+  };
+  if (!std::is_sorted(order.begin(), order.end(), isEarlier)) {
+    std::stable_sort(order.begin(), order.end(), isEarlier);
+  }
+}
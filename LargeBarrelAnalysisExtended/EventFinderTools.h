@@ -0,0 +1,66 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventFinderTools.h
+ *  @brief Grouping of the time ordered hits into events.
+ */
+
+#ifndef EVENTFINDERTOOLS_H
+#define EVENTFINDERTOOLS_H
+
+#include <cmath>
+#include <vector>
+
+class EventFinderTools
+{
+public:
+  typedef std::vector<unsigned int>::const_iterator IndexIterator;
+
+  /// Fills order with the indices of the times, sorted by the time value.
+  /// Equal times keep their original order.
+  static void sortByTime(const std::vector<double>& times, std::vector<unsigned int>& order);
+
+  /**
+   * Groups the hits into events in a single pass over the time ordered indices.
+   * An event starts with the earliest hit not yet used and contains all the
+   * following hits closer in time to this first hit than eventTimeWindow.
+   * For every event emitEvent(begin, end) is called with the range of its indices in order.
+   * With keepLastOpen the last event is not emitted, because hits coming later
+   * could still belong to it.
+   * Returns the number of indices used in the emitted events.
+   */
+  template <class EmitEvent>
+  static std::size_t buildEvents(const std::vector<double>& times, const std::vector<unsigned int>& order,
+                                 double eventTimeWindow, bool keepLastOpen, const EmitEvent& emitEvent)
+  {
+    auto first = order.begin();
+    while (first != order.end()) {
+      const double firstTime = times[*first];
+      auto last = first + 1;
+      while (last != order.end() && std::fabs(times[*last] - firstTime) < eventTimeWindow) {
+        ++last;
+      }
+      if (keepLastOpen && last == order.end()) {
+        break;
+      }
+      emitEvent(first, last);
+      first = last;
+    }
+    return first - order.begin();
+  }
+
+private:
+  EventFinderTools(const EventFinderTools&);
+  void operator=(const EventFinderTools&);
+};
+
+#endif /*  !EVENTFINDERTOOLS_H */
@@ -0,0 +1,115 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventFinderToolsBenchmark.cpp
+ *  @brief Microbenchmark of the grouping of the hits into events, in ns per hit.
+ *
+ *  Measures the sorting of the hit times and the single pass building
+ *  of the events done by the EventFinder, for growing numbers of hits
+ *  in a 20 us time window. The hits come in the order of the scintillators,
+ *  as given by the HitFinder, not sorted by time.
+ *  Usage: EventFinderToolsBenchmark.x [--filter <text>] [--min-time <s>] [--repetitions <n>] [--csv]
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "BenchmarkTools.h"
+#include "EventFinderTools.h"
+#include <JPetEvent/JPetEvent.h>
+
+namespace
+{
+
+/// as in the EventFinder, in ps
+const double kEventTimeWindow = 5000.;
+const double kTimeWindowLength = 20000000.;
+const int kNumOfScins = 192;
+const std::vector<long long> kHitsPerWindow = {16, 128, 1024, 8192, 65536};
+
+/// Hit times of the annihilations giving 2 hits close in time and of single hits,
+/// grouped by the scintillator.
+std::vector<double> generateHitTimes(int numOfHits)
+{
+  std::mt19937 generator(2017);
+  std::uniform_real_distribution<double> time(0., kTimeWindowLength);
+  std::uniform_int_distribution<int> scin(0, kNumOfScins - 1);
+  std::normal_distribution<double> timeDifference(0., 500.);
+  std::vector<std::vector<double>> timesPerScin(kNumOfScins);
+  for (int i = 0; i < numOfHits; i++) {
+    double annihilationTime = time(generator);
+    timesPerScin[scin(generator)].push_back(annihilationTime);
+    if (++i < numOfHits) {
+      timesPerScin[scin(generator)].push_back(annihilationTime + timeDifference(generator));
+    }
+  }
+  std::vector<double> times;
+  for (const auto& scinTimes : timesPerScin) {
+    times.insert(times.end(), scinTimes.begin(), scinTimes.end());
+  }
+  return times;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  BenchmarkRunner runner(argc, argv);
+
+  runner.run("sortByTime", kHitsPerWindow, [](BenchmarkState & state) {
+    auto times = generateHitTimes(state.getParameter());
+    std::vector<unsigned int> order;
+    state.setObjectsPerIteration(times.size());
+    while (state.keepRunning()) {
+      EventFinderTools::sortByTime(times, order);
+      doNotOptimize(order);
+    }
+  });
+  runner.run("buildEvents", kHitsPerWindow, [](BenchmarkState & state) {
+    auto times = generateHitTimes(state.getParameter());
+    std::vector<unsigned int> order;
+    EventFinderTools::sortByTime(times, order);
+    state.setObjectsPerIteration(times.size());
+    while (state.keepRunning()) {
+      std::size_t numOfEvents = 0;
+      EventFinderTools::buildEvents(times, order, kEventTimeWindow, false,
+      [&numOfEvents](EventFinderTools::IndexIterator, EventFinderTools::IndexIterator) {
+        numOfEvents++;
+      });
+      doNotOptimize(numOfEvents);
+    }
+  });
+  /// the whole EventFinder step: sorting and filling the JPetEvents with the hits
+  runner.run("buildEvents/withHits", kHitsPerWindow, [](BenchmarkState & state) {
+    auto times = generateHitTimes(state.getParameter());
+    std::vector<JPetHit> hits(times.size());
+    for (std::size_t i = 0; i < hits.size(); i++) {
+      hits[i].setTime(times[i]);
+    }
+    std::vector<unsigned int> order;
+    state.setObjectsPerIteration(times.size());
+    while (state.keepRunning()) {
+      EventFinderTools::sortByTime(times, order);
+      EventFinderTools::buildEvents(times, order, kEventTimeWindow, false,
+      [&hits](EventFinderTools::IndexIterator first, EventFinderTools::IndexIterator last) {
+        JPetEvent event;
+        event.setEventType(JPetEventType::kUnknown);
+        for (auto index = first; index != last; ++index) {
+          event.addHit(hits[*index]);
+        }
+        doNotOptimize(event);
+      });
+    }
+  });
+  return 0;
+}
@@ -0,0 +1,103 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EventFinderToolsTest
+#include <boost/test/unit_test.hpp>
+
+#include "EventFinderTools.h"
+
+typedef std::vector<std::vector<double>> EventTimes;
+
+std::size_t groupTimes(const std::vector<double>& times, double eventTimeWindow, bool keepLastOpen,
+                        EventTimes& events, std::vector<unsigned int>& order)
+{
+  EventFinderTools::sortByTime(times, order);
+  return EventFinderTools::buildEvents(times, order, eventTimeWindow, keepLastOpen,
+  [&](EventFinderTools::IndexIterator first, EventFinderTools::IndexIterator last) {
+    std::vector<double> event;
+    for (auto index = first; index != last; ++index) {
+      event.push_back(times[*index]);
+    }
+    events.push_back(event);
+  });
+}
+
+BOOST_AUTO_TEST_SUITE(EventFinderToolsSuite)
+
+BOOST_AUTO_TEST_CASE(sortByTime)
+{
+  std::vector<unsigned int> order = {7, 7};
+  EventFinderTools::sortByTime({}, order);
+  BOOST_REQUIRE(order.empty());
+  EventFinderTools::sortByTime({3., 1., 2., 1.}, order);
+  BOOST_REQUIRE_EQUAL(order.size(), 4u);
+  BOOST_REQUIRE_EQUAL(order[0], 1u);
+  BOOST_REQUIRE_EQUAL(order[1], 3u);
+  BOOST_REQUIRE_EQUAL(order[2], 2u);
+  BOOST_REQUIRE_EQUAL(order[3], 0u);
+}
+
+BOOST_AUTO_TEST_CASE(buildEvents)
+{
+  EventTimes events;
+  std::vector<unsigned int> order;
+  BOOST_REQUIRE_EQUAL(groupTimes({}, 5., false, events, order), 0u);
+  BOOST_REQUIRE(events.empty());
+
+  /// the time is measured from the first hit of the event, not from the previous one
+  std::vector<double> times = {12., 0., 4., 8., 30., 35.};
+  BOOST_REQUIRE_EQUAL(groupTimes(times, 5., false, events, order), 6u);
+  BOOST_REQUIRE_EQUAL(events.size(), 4u);
+  BOOST_REQUIRE(events[0] == std::vector<double>({0., 4.}));
+  BOOST_REQUIRE(events[1] == std::vector<double>({8., 12.}));
+  BOOST_REQUIRE(events[2] == std::vector<double>({30.}));
+  BOOST_REQUIRE(events[3] == std::vector<double>({35.}));
+
+  events.clear();
+  BOOST_REQUIRE_EQUAL(groupTimes(times, 5., true, events, order), 5u);
+  BOOST_REQUIRE_EQUAL(events.size(), 3u);
+  BOOST_REQUIRE_EQUAL(times[order[5]], 35.);
+}
+
+BOOST_AUTO_TEST_CASE(buildEvents_equalTimes)
+{
+  EventTimes events;
+  std::vector<unsigned int> order;
+  /// the hit exactly one event time window after the first hit starts a new event
+  BOOST_REQUIRE_EQUAL(groupTimes({5., 0., 5., 0.}, 5., false, events, order), 4u);
+  BOOST_REQUIRE_EQUAL(events.size(), 2u);
+  BOOST_REQUIRE(events[0] == std::vector<double>({0., 0.}));
+  BOOST_REQUIRE(events[1] == std::vector<double>({5., 5.}));
+  /// the equal times keep the input order
+  BOOST_REQUIRE_EQUAL(order[0], 1u);
+  BOOST_REQUIRE_EQUAL(order[1], 3u);
+}
+
+/// Time windows of 100 ps processed one after another, with the last event kept open,
+/// as done by the EventFinder with the option EventFinder_CrossWindow.
+BOOST_AUTO_TEST_CASE(buildEvents_acrossTimeWindows)
+{
+  const double timeWindowLength = 100.;
+  const std::vector<std::vector<double>> windows = {{98., 10.}, {50., 1.}, {}, {3.}};
+  std::vector<double> pending;
+  EventTimes events;
+  std::vector<unsigned int> order;
+  for (unsigned int window = 0; window < windows.size(); window++) {
+    for (double time : windows[window]) {
+      pending.push_back(window * timeWindowLength + time);
+    }
+    auto used = groupTimes(pending, 5., true, events, order);
+    std::vector<double> open;
+    for (auto index = order.begin() + used; index != order.end(); ++index) {
+      open.push_back(pending[*index]);
+    }
+    pending.swap(open);
+  }
+  groupTimes(pending, 5., false, events, order);
+  BOOST_REQUIRE_EQUAL(events.size(), 4u);
+  BOOST_REQUIRE(events[0] == std::vector<double>({10.}));
+  /// the event started at the end of the first window is completed in the second one
+  BOOST_REQUIRE(events[1] == std::vector<double>({98., 101.}));
+  BOOST_REQUIRE(events[2] == std::vector<double>({150.}));
+  BOOST_REQUIRE(events[3] == std::vector<double>({303.}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
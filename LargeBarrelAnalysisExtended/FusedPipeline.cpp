@@ -0,0 +1,264 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file FusedPipeline.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <JPetWriter/JPetWriter.h>
+#include <JPetParamManager/JPetParamManager.h>
+#include <TDirectory.h>
+#include <TROOT.h> /// ROOT::EnableThreadSafety()
+#include "FusedPipeline.h"
+#include "BatchTools.h"
+
+namespace
+{
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+FusedPipeline::FusedPipeline(const char* name, const char* description):
+  JPetTask(name, description) {}
+
+FusedPipeline::~FusedPipeline() {}
+
+void FusedPipeline::addStage(PipelineStage* stage, const std::string& outputFileType)
+{
+  assert(stage);
+  if (!fStages.empty()) {
+    fStages.back()->setNextStage(stage);
+  }
+  fStages.push_back(std::unique_ptr<PipelineStage>(stage));
+  fOutputFileTypes.push_back(outputFileType);
+}
+
+long long FusedPipeline::getNumOfOutputObjects() const
+{
+  return fStages.empty() ? 0 : fStages.back()->getNumOfOutputObjects();
+}
+
+void FusedPipeline::init(const JPetTaskInterface::Options& opts)
+{
+  INFO("Fused pipeline started with " + std::to_string(fStages.size()) + " stages.");
+  if (fStages.empty()) {
+    ERROR("No stages were added to the pipeline");
+    return;
+  }
+  if (opts.count(kThreadedParamKey)) {
+    fThreaded = (opts.at(kThreadedParamKey) == "true");
+  }
+  if (opts.count(kQueueCapacityParamKey)) {
+    fQueueCapacity = std::max(1, std::atoi(opts.at(kQueueCapacityParamKey).c_str()));
+  }
+  std::string baseFileName;
+  if (opts.count("inputFile")) {
+    baseFileName = getBaseFileName(opts.at("inputFile"));
+  }
+  fStageProfiles.assign(fStages.size(), TaskProfile());
+  for (unsigned int i = 0; i < fStages.size(); i++) {
+    auto& stage = fStages[i];
+    auto start = std::chrono::steady_clock::now();
+    stage->setParamManager(fParamManager);
+    stage->setStatistics(&getStatistics());
+    stage->setAuxilliaryData(&getAuxilliaryData());
+    if (i + 1 == fStages.size()) {
+      /// the last stage is always written by the loader
+      stage->setWriter(fWriter);
+    } else {
+      auto key = std::string(stage->getName()) + kSaveOutputParamKeySuffix;
+      if (opts.count(key) && opts.at(key) == "true") {
+        auto fileName = baseFileName + "." + fOutputFileTypes[i] + ".root";
+        INFO("Intermediate output of " + std::string(stage->getName()) + " will be saved to:" + fileName);
+        {
+          /// the new file must not become the current directory, otherwise the histograms
+          /// created by the stages would be owned and deleted by it in closeFile()
+          TDirectory::TContext context;
+          fIntermediateWriters.push_back(std::unique_ptr<JPetWriter>(new JPetWriter(fileName.c_str())));
+        }
+        stage->setWriter(fIntermediateWriters.back().get());
+      } else {
+        stage->setWriter(nullptr);
+      }
+    }
+    stage->init(opts);
+    fStageProfiles[i].initWallTime = secondsSince(start);
+  }
+  if (fThreaded) {
+    startThreads();
+  }
+}
+
+void FusedPipeline::startThreads()
+{
+  INFO("Starting " + std::to_string(fStages.size()) + " stage threads with queues of "
+       + std::to_string(fQueueCapacity) + " objects.");
+  /// the copies of TRef members of the data objects are made concurrently
+  ROOT::EnableThreadSafety();
+  for (unsigned int i = 0; i < fStages.size(); i++) {
+    fQueues.push_back(std::unique_ptr<PipelineStage::StageQueue>(
+                        new PipelineStage::StageQueue(fQueueCapacity)));
+  }
+  for (unsigned int i = 0; i + 1 < fStages.size(); i++) {
+    fStages[i]->setOutputQueue(fQueues[i + 1].get());
+  }
+  for (unsigned int i = 0; i < fStages.size(); i++) {
+    fThreads.push_back(std::thread(&FusedPipeline::runStage, this, i));
+  }
+}
+
+/// Body of the stage thread: the stage consumes its input queue until it is closed
+/// by the previous stage, then it is terminated and closes the queue of the next stage.
+void FusedPipeline::runStage(unsigned int stageIndex)
+{
+  auto& stage = fStages[stageIndex];
+  auto& input = *fQueues[stageIndex];
+  TObject* obj = nullptr;
+  while (input.pop(obj)) {
+    stage->process(obj);
+    delete obj;
+  }
+  terminateStage(stageIndex);
+  /// the thread runs only this stage
+  fStageProfiles[stageIndex].cpuTime = ResourceUsage::getThreadCPUTime();
+  if (stageIndex + 1 < fQueues.size()) {
+    fQueues[stageIndex + 1]->close();
+  }
+}
+
+void FusedPipeline::exec()
+{
+  if (fStages.empty()) {
+    return;
+  }
+  if (fThreaded) {
+    /// the reader reuses its event object, so the first stage gets a copy
+    fQueues.front()->push(getEvent()->Clone());
+    return;
+  }
+  fStages.front()->process(getEvent());
+}
+
+void FusedPipeline::terminate()
+{
+  /// Stages are terminated in the order of the chain, so that
+  /// everything flushed by a stage is still processed by the next ones.
+  if (fThreaded) {
+    if (!fQueues.empty()) {
+      fQueues.front()->close();
+    }
+    for (auto& thread : fThreads) {
+      thread.join();
+    }
+    fThreads.clear();
+    reportQueueStats();
+  } else {
+    for (unsigned int i = 0; i < fStages.size(); i++) {
+      terminateStage(i);
+    }
+  }
+  reportStageProfiles();
+  for (auto& writer : fIntermediateWriters) {
+    writer->closeFile();
+  }
+  if (HistogramMerger::getMerger().isEnabled()) {
+    HistogramMerger::getMerger().add(getStatistics());
+  }
+  INFO("Fused pipeline ended.");
+}
+
+void FusedPipeline::terminateStage(unsigned int stageIndex)
+{
+  auto& stage = fStages[stageIndex];
+  auto& profile = fStageProfiles[stageIndex];
+  double downstreamBefore = stage->getCounters().downstreamWallTime;
+  auto start = std::chrono::steady_clock::now();
+  stage->terminate();
+  double downstream = stage->getCounters().downstreamWallTime - downstreamBefore;
+  profile.terminateWallTime = secondsSince(start) - downstream;
+  /// the next stages run for the objects flushed in terminate() were not a part of exec(),
+  /// this is given back when their whole time is subtracted from exec() in reportStageProfiles()
+  profile.execWallTime = downstream;
+}
+
+/// The times of the stages are exclusive: the time of the next stages
+/// run from forward() is subtracted, so they add up to the pipeline time.
+void FusedPipeline::reportStageProfiles()
+{
+  for (unsigned int i = 0; i < fStages.size(); i++) {
+    const auto& counters = fStages[i]->getCounters();
+    auto profile = fStageProfiles[i];
+    profile.name = std::string(getName()) + "/" + fStages[i]->getName();
+    profile.execWallTime += counters.execWallTime - counters.downstreamWallTime;
+    profile.objectsIn = counters.objectsIn;
+    profile.objectsOut = counters.objectsOut;
+    TaskProfiler::getProfiler().addProfile(profile);
+  }
+}
+
+void FusedPipeline::reportQueueStats()
+{
+  INFO("Queue occupancy (capacity " + std::to_string(fQueueCapacity) + "):");
+  unsigned int bottleneck = 0;
+  double maxMeanOccupancy = -1.;
+  for (unsigned int i = 0; i < fQueues.size(); i++) {
+    const auto& stats = fQueues[i]->getStats();
+    std::string stageName = fStages[i]->getName();
+    INFO(Form("  input of %-20s pushed: %10llu mean: %8.2f max: %6llu producer stalls: %10llu consumer stalls: %10llu",
+              stageName.c_str(),
+              static_cast<unsigned long long>(stats.pushed),
+              stats.getMeanOccupancy(),
+              static_cast<unsigned long long>(stats.maxOccupancy),
+              static_cast<unsigned long long>(stats.producerStalls),
+              static_cast<unsigned long long>(stats.consumerStalls)));
+    auto prefix = "FusedPipeline_" + stageName + "_Queue";
+    getStatistics().getCounter((prefix + "Pushed").c_str()) = stats.pushed;
+    getStatistics().getCounter((prefix + "MeanOccupancy").c_str()) = stats.getMeanOccupancy();
+    getStatistics().getCounter((prefix + "MaxOccupancy").c_str()) = stats.maxOccupancy;
+    getStatistics().getCounter((prefix + "ProducerStalls").c_str()) = stats.producerStalls;
+    getStatistics().getCounter((prefix + "ConsumerStalls").c_str()) = stats.consumerStalls;
+    if (stats.getMeanOccupancy() > maxMeanOccupancy) {
+      maxMeanOccupancy = stats.getMeanOccupancy();
+      bottleneck = i;
+    }
+  }
+  if (!fQueues.empty()) {
+    INFO("The slowest stage is probably " + std::string(fStages[bottleneck]->getName())
+         + " which has the fullest input queue.");
+  }
+}
+
+void FusedPipeline::setWriter(JPetWriter* writer)
+{
+  fWriter = writer;
+}
+
+void FusedPipeline::setParamManager(JPetParamManager* paramManager)
+{
+  fParamManager = paramManager;
+  JPetTask::setParamManager(paramManager);
+}
+
+/// Returns the file name stripped of all its extensions,
+/// e.g. /data/dabc_17025151847.hld.root -> /data/dabc_17025151847
+std::string FusedPipeline::getBaseFileName(const std::string& fileName)
+{
+  auto slashPos = fileName.find_last_of('/');
+  auto nameStart = (slashPos == std::string::npos) ? 0 : slashPos + 1;
+  return fileName.substr(0, fileName.find('.', nameStart));
+}
@@ -0,0 +1,106 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file FusedPipeline.h
+ */
+
+#ifndef FUSEDPIPELINE_H
+#define FUSEDPIPELINE_H
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <JPetTask/JPetTask.h>
+#include "PipelineStage.h"
+#include "ProfiledTask.h"
+
+class JPetWriter;
+
+#ifdef __CINT__
+//when cint is used instead of compiler, override word is not recognized
+//nevertheless it's needed for checking if the structure of project is correct
+#	define override
+#endif
+
+/**
+ * @brief Task running a chain of PipelineStage tasks in memory.
+ *
+ * The pipeline is registered with a single JPetTaskLoader. Every object read
+ * from the input file is given to the first stage, and every object produced
+ * by a stage is handed directly to the exec() of the next one, so the data are
+ * processed one time window at a time without the intermediate ROOT files.
+ * Only the output of the last stage is written by the loader's writer.
+ *
+ * The output of any other stage can be kept by setting the user option:
+ * "<StageName>_SaveOutput":"true"
+ * e.g. "SignalFinder_SaveOutput":"true" writes the <input>.raw.sig.root file
+ * with the same content as in the non-fused chain.
+ * The control histograms of all stages are stored in the final output file.
+ *
+ * With the user option "FusedPipeline_Threaded":"true" every stage runs in
+ * its own thread and the stages are connected with bounded lock-free queues
+ * (capacity set by "FusedPipeline_QueueCapacity", default 256 objects), so
+ * unpacking, calibration, signal finding and hit finding overlap in time.
+ * A full queue blocks its producer. At the end the occupancy of every queue
+ * is printed and saved as counters in the statistics: the input queue of the
+ * slowest stage is the one which is full most of the time.
+ *
+ * The time, objects in and out of every stage are added to the TaskProfiler
+ * summary as "<PipelineName>/<StageName>". In the threaded mode the CPU time
+ * of every stage thread is also given, and the exec() time of a stage includes
+ * the time it waited for the space in its output queue.
+ *
+ * In the batch mode the histograms of all stages are also added to the
+ * HistogramMerger at the end, to be summed over all input files.
+ */
+class FusedPipeline: public JPetTask, public OutputCounter
+{
+public:
+  FusedPipeline(const char* name, const char* description);
+  virtual ~FusedPipeline();
+  virtual void init(const JPetTaskInterface::Options& opts) override;
+  virtual void exec() override;
+  virtual void terminate() override;
+  virtual void setWriter(JPetWriter* writer) override;
+  virtual void setParamManager(JPetParamManager* paramManager) override;
+  /// Appends a stage to the end of the chain. The pipeline takes the ownership.
+  /// outputFileType is the file type used when the stage output is saved, e.g. "raw.sig".
+  void addStage(PipelineStage* stage, const std::string& outputFileType);
+  /// Output objects of the last stage, written by the loader.
+  virtual long long getNumOfOutputObjects() const override;
+
+protected:
+  static std::string getBaseFileName(const std::string& fileName);
+  void startThreads();
+  void runStage(unsigned int stageIndex);
+  void reportQueueStats();
+  void terminateStage(unsigned int stageIndex);
+  void reportStageProfiles();
+
+  const std::string kSaveOutputParamKeySuffix = "_SaveOutput";
+  const std::string kThreadedParamKey = "FusedPipeline_Threaded";
+  const std::string kQueueCapacityParamKey = "FusedPipeline_QueueCapacity";
+  bool fThreaded = false;
+  std::size_t fQueueCapacity = 256;
+  /// fQueues[i] is the input queue of the i-th stage
+  std::vector<std::unique_ptr<PipelineStage::StageQueue>> fQueues;
+  std::vector<std::thread> fThreads;
+  std::vector<std::unique_ptr<PipelineStage>> fStages;
+  std::vector<std::string> fOutputFileTypes;
+  /// times of the init() and terminate() of the stages, the rest is in their counters
+  std::vector<TaskProfile> fStageProfiles;
+  std::vector<std::unique_ptr<JPetWriter>> fIntermediateWriters;
+  JPetWriter* fWriter = nullptr;
+  JPetParamManager* fParamManager = nullptr;
+};
+#endif /*  !FUSEDPIPELINE_H */
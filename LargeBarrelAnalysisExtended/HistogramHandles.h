@@ -0,0 +1,83 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file HistogramHandles.h
+ *  @brief Histograms registered in JPetStatistics and kept by pointer.
+ */
+
+#ifndef HISTOGRAMHANDLES_H
+#define HISTOGRAMHANDLES_H
+
+#include <vector>
+#include <JPetStatistics/JPetStatistics.h>
+
+/**
+ * Registers the histogram in the statistics, which takes its ownership,
+ * and returns it, so it can be filled without formatting and looking up its name.
+ * To be called in init(), e.g.
+ *   fChannelsPerEvt = registerHistogram(getStatistics(), new TH1F("ChannelsPerEvt", ...));
+ */
+template <class H>
+H* registerHistogram(JPetStatistics& stats, H* histogram)
+{
+  stats.createHistogram(histogram);
+  return histogram;
+}
+
+/**
+ * @brief Family of histograms, like one per barrel slot and threshold,
+ * addressed by two integer keys instead of a formatted name.
+ *
+ * The histograms are kept in a flat array indexed by key * numOfSubkeys + subkey,
+ * so the keys should be small numbers such as IDs or threshold numbers.
+ */
+template <class H>
+class HistogramArray
+{
+public:
+  explicit HistogramArray(int numOfSubkeys = 1): fNumOfSubkeys(numOfSubkeys) {}
+
+  /// Registers the histogram in the statistics and stores it under the keys.
+  H* add(JPetStatistics& stats, int key, int subkey, H* histogram)
+  {
+    registerHistogram(stats, histogram);
+    if (key >= 0 && subkey >= 0 && subkey < fNumOfSubkeys) {
+      std::size_t index = static_cast<std::size_t>(key) * fNumOfSubkeys + subkey;
+      if (index >= fHistograms.size()) {
+        fHistograms.resize(index + 1, nullptr);
+      }
+      fHistograms[index] = histogram;
+    }
+    return histogram;
+  }
+
+  H* add(JPetStatistics& stats, int key, H* histogram)
+  {
+    return add(stats, key, 0, histogram);
+  }
+
+  /// nullptr if no histogram was added under the keys.
+  H* get(int key, int subkey = 0) const
+  {
+    if (key < 0 || subkey < 0 || subkey >= fNumOfSubkeys) {
+      return nullptr;
+    }
+    std::size_t index = static_cast<std::size_t>(key) * fNumOfSubkeys + subkey;
+    return index < fHistograms.size() ? fHistograms[index] : nullptr;
+  }
+
+private:
+  std::vector<H*> fHistograms;
+  int fNumOfSubkeys;
+};
+
+#endif /*  !HISTOGRAMHANDLES_H */
@@ -0,0 +1,52 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE HistogramHandlesTest
+#include <boost/test/unit_test.hpp>
+
+#include "HistogramHandles.h"
+
+BOOST_AUTO_TEST_SUITE(HistogramHandlesSuite)
+
+BOOST_AUTO_TEST_CASE(registerHistogramReturnsIt)
+{
+  JPetStatistics stats;
+  TH1F* histogram = new TH1F("registered", "", 10, 0., 10.);
+  BOOST_REQUIRE_EQUAL(registerHistogram(stats, histogram), histogram);
+}
+
+BOOST_AUTO_TEST_CASE(emptyArray)
+{
+  HistogramArray<TH1F> histograms(5);
+  BOOST_REQUIRE(histograms.get(0) == nullptr);
+  BOOST_REQUIRE(histograms.get(3, 2) == nullptr);
+  BOOST_REQUIRE(histograms.get(-1, 2) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(addressedByKeys)
+{
+  JPetStatistics stats;
+  HistogramArray<TH1F> histograms(5);
+  TH1F* first = histograms.add(stats, 7, 1, new TH1F("slot7_thr1", "", 10, 0., 10.));
+  TH1F* second = histograms.add(stats, 7, 4, new TH1F("slot7_thr4", "", 10, 0., 10.));
+  TH1F* third = histograms.add(stats, 2, 1, new TH1F("slot2_thr1", "", 10, 0., 10.));
+  BOOST_REQUIRE_EQUAL(histograms.get(7, 1), first);
+  BOOST_REQUIRE_EQUAL(histograms.get(7, 4), second);
+  BOOST_REQUIRE_EQUAL(histograms.get(2, 1), third);
+  BOOST_REQUIRE(histograms.get(7, 2) == nullptr);
+  BOOST_REQUIRE(histograms.get(2, 4) == nullptr);
+  BOOST_REQUIRE(histograms.get(8, 1) == nullptr);
+  /// subkey outside of the declared range does not alias the next key
+  BOOST_REQUIRE(histograms.get(6, 6) == nullptr);
+  BOOST_REQUIRE(histograms.add(stats, 6, 6, new TH1F("outside", "", 10, 0., 10.)) != nullptr);
+  BOOST_REQUIRE_EQUAL(histograms.get(7, 1), first);
+}
+
+BOOST_AUTO_TEST_CASE(singleKey)
+{
+  JPetStatistics stats;
+  HistogramArray<TH2F> histograms;
+  TH2F* histogram = histograms.add(stats, 3, new TH2F("layer3", "", 10, 0., 10., 10, 0., 10.));
+  BOOST_REQUIRE_EQUAL(histograms.get(3), histogram);
+  BOOST_REQUIRE(histograms.get(2) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -14,23 +14,46 @@
  */
 
 #include <iostream>
-#include <JPetWriter/JPetWriter.h>
 #include <JPetAnalysisTools/JPetAnalysisTools.h>
 #include "HitFinder.h"
 #include "HitFinderTools.h"
+#include "BatchTools.h"
+#include "SharedCache.h"
 
 using namespace std;
 
-HitFinder::HitFinder(const char* name, const char* description): JPetTask(name, description) {}
+HitFinder::HitFinder(const char* name, const char* description): PipelineStage(name, description) {}
 
 HitFinder::~HitFinder() {}
 
 void HitFinder::init(const JPetTaskInterface::Options& opts)
 {
-	INFO("Reading velocities.");
-	fVelocityMap = readVelocityFile();
-
-  getStatistics().createHistogram(
+	if (opts.count(fVelocityFileParamKey)) {
+		fVelocityFile = opts.at(fVelocityFileParamKey);
+	}
+	if (opts.count(fVelocityThresholdParamKey)) {
+		fVelocityThreshold = atoi(opts.at(fVelocityThresholdParamKey).c_str());
+	}
+	if (fVelocityThreshold < 1 || fVelocityThreshold > VelocityCalibTable::kNumOfThresholds) {
+		WARNING(Form("Threshold %d given for the velocities does not exist, the first one is used.", fVelocityThreshold));
+		fVelocityThreshold = 1;
+	}
+	/// in the batch mode the velocities and the geometry are prepared once for all input files
+	fVelocityCalibration = *SharedCache<VelocityCalibTable>::getCache().get(fVelocityFile, [this]() {
+		INFO("Reading velocities from " + fVelocityFile);
+		auto velocities = VelocityCalibTools::loadVelocities(fVelocityFile);
+		INFO(Form("Velocities loaded for %d slot and threshold combinations.", (int) velocities.getNumOfEntries()));
+		return velocities;
+	});
+	auto geometryKey = BatchTools::getSetupKey(opts) + "|" + fVelocityFile + "|" + std::to_string(fVelocityThreshold);
+	fSlotGeometry = *SharedCache<BarrelSlotGeometry>::getCache().get(geometryKey, [this]() {
+		BarrelSlotGeometry geometry;
+		geometry.build(getParamBank(), fVelocityCalibration, fVelocityThreshold);
+		INFO(Form("Geometry of %d barrel slots prepared for the hit reconstruction.", (int) geometry.getNumOfSlots()));
+		return geometry;
+	});
+
+  fHitsPerTimeWindowHisto = registerHistogram(getStatistics(),
     new TH1F("hits_per_time_window",
       "Number of Hits in Time Window",
       101, -0.5, 100.5
@@ -53,6 +76,17 @@ void HitFinder::init(const JPetTaskInterface::Options& opts)
     )
   );
 
+	if (opts.count(fCompactOutputParamKey) && opts.at(fCompactOutputParamKey) == "true") {
+		if (!opts.count("inputFile")) {
+			WARNING("No input file name, the compact hits are not saved.");
+		} else {
+			auto fileName = CompactHitWriter::getFileName(opts.at("inputFile"));
+			if (fCompactWriter.open(fileName)) {
+				INFO("Compact hits will be saved to: " + fileName);
+			}
+		}
+	}
+
 	if (opts.count(fTimeWindowWidthParamKey )) {
 		kTimeWindowWidth = atof(opts.at(fTimeWindowWidthParamKey).c_str());
 	}
@@ -65,26 +99,10 @@ void HitFinder::exec()
 
 	//getting the data from event in apropriate format
 	if (auto currSignal = dynamic_cast<const JPetPhysSignal* const>(getEvent())) {
-		if (kFirstTime) {
-			kTimeSlotIndex = currSignal->getTimeWindowIndex();
-			fillSignalsMap(*currSignal);
-			kFirstTime = false;
-		} else {
-			if (kTimeSlotIndex == currSignal->getTimeWindowIndex()) {
-				fillSignalsMap(*currSignal);
-			} else {
-        vector<JPetHit> hits = HitTools.createHits(
-          getStatistics(),
-          fAllSignalsInTimeWindow,
-          kTimeWindowWidth,
-          fVelocityMap);
-        saveHits(hits);
-        getStatistics().getHisto1D("hits_per_time_window").Fill(hits.size());
-        fAllSignalsInTimeWindow.clear();
-        kTimeSlotIndex = currSignal->getTimeWindowIndex();
-        fillSignalsMap(*currSignal);
-			}
-		}
+		fSignals.add(*currSignal, currSignal->getTimeWindowIndex(),
+			[this](const vector<JPetPhysSignal>& signals) {
+				findHits(signals);
+			});
 	}
 }
 
@@ -92,71 +110,53 @@ void HitFinder::exec()
 
 void HitFinder::terminate()
 {
+	fSignals.finish([this](const vector<JPetPhysSignal>& signals) {
+		findHits(signals);
+	});
+	if (fCompactWriter.isOpen()) {
+		INFO(Form("%lld compact hits saved.", fCompactWriter.getNumOfHits()));
+		fCompactWriter.close();
+	}
 	INFO("Hit finding ended.");
 }
 
+void HitFinder::findHits(const vector<JPetPhysSignal>& signals)
+{
+	/// the vectors of the scintillators are emptied, not removed, to be reused in the next window
+	for (auto& scintillator : fAllSignalsInTimeWindow) {
+		scintillator.second.first.clear();
+		scintillator.second.second.clear();
+	}
+	for (const auto& signal : signals) {
+		fillSignalsMap(signal);
+	}
+	vector<JPetHit> hits = HitTools.createHits(
+		getStatistics(),
+		fAllSignalsInTimeWindow,
+		kTimeWindowWidth,
+		fSlotGeometry);
+	saveHits(hits);
+	fHitsPerTimeWindowHisto->Fill(hits.size());
+}
 
 void HitFinder::saveHits(const vector<JPetHit>& hits)
 {
-	assert(fWriter);
 	auto sortedHits = JPetAnalysisTools::getHitsOrderedByTime(hits);
 
 	for (const auto & hit : sortedHits) {
-		fWriter->write(hit);
+		if (fCompactWriter.isOpen()) {
+			fCompactWriter.write(CompactHit::fromHit(hit, hit.getSignalA().getTimeWindowIndex()));
+		}
+		forward(hit);
 	}
 }
 
-void HitFinder::setWriter(JPetWriter* writer)
+void HitFinder::fillSignalsMap(const JPetPhysSignal& signal)
 {
-	fWriter = writer;
-}
-
-void HitFinder::fillSignalsMap(JPetPhysSignal signal)
-{
-	auto scinId = signal.getPM().getScin().getID();
+	auto& sides = fAllSignalsInTimeWindow[signal.getPM().getScin().getID()];
 	if (signal.getPM().getSide() == JPetPM::SideA) {
-		if (fAllSignalsInTimeWindow.find(scinId) != fAllSignalsInTimeWindow.end()) {
-			fAllSignalsInTimeWindow.at(scinId).first.push_back(signal);
-		} else {
-			std::vector<JPetPhysSignal> sideA = {signal};
-			std::vector<JPetPhysSignal> sideB;
-			fAllSignalsInTimeWindow.insert(std::make_pair(scinId,
-						std::make_pair(sideA, sideB)));
-		}
+		sides.first.push_back(signal);
 	} else {
-		if (fAllSignalsInTimeWindow.find(scinId) != fAllSignalsInTimeWindow.end()) {
-			fAllSignalsInTimeWindow.at(scinId).second.push_back(signal);
-		} else {
-			std::vector<JPetPhysSignal> sideA;
-			std::vector<JPetPhysSignal> sideB = {signal};
-			fAllSignalsInTimeWindow.insert(std::make_pair(scinId,
-						std::make_pair(sideA, sideB)));
-		}
-	}
-}
-
-map<int, vector<double>> HitFinder::readVelocityFile(){
-
-	map<int, vector<double>> velocitiesMap;
-
-	ifstream input;
-	input.open("resultsForThresholda.txt");
-	if(input.is_open()) INFO("File with velocities for THR A opened.");
-	else INFO("File with velocities ERROR.");
-
-	int slot = 0;
-	double vel = 0.0, error = 0.0;
-
-	while(!input.eof()){
-
-		input>>slot>>vel>>error;
-
-		vector<double> values;
-		values.push_back(vel);
-		values.push_back(error);
-
-		velocitiesMap[slot] = values;
+		sides.second.push_back(signal);
 	}
-
-	return velocitiesMap;
 }
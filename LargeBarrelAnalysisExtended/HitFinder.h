@@ -18,12 +18,14 @@
 
 #include <map>
 #include <vector>
-#include <JPetTask/JPetTask.h>
 #include <JPetHit/JPetHit.h>
 #include <JPetRawSignal/JPetRawSignal.h>
 #include "HitFinderTools.h"
-
-class JPetWriter;
+#include "VelocityCalibTools.h"
+#include "WindowAccumulator.h"
+#include "HistogramHandles.h"
+#include "PipelineStage.h"
+#include "CompactHits.h"
 
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -40,9 +42,14 @@ class JPetWriter;
  * one for physical signals on photomultiplier on side A and second for signals on side B. Then
  * for each signal on side A it searches for corresponding signal on side B - that is time difference of arrival
  * of those two signals needs to be less then specified time difference (kTimeWindowWidth)
+ * The position along the scintillator is calculated with the effective velocities read
+ * from the file given by the user option "HitFinder_VelocityFile" (by default resultsForThresholda.txt),
+ * for the threshold given by "HitFinder_VelocityThreshold" (by default 1).
+ * With the user option "HitFinder_CompactOutput":"true" the hits are also written
+ * as CompactHit objects to the file <input>.hits.compact.root, without their signals.
  *
  */
-class HitFinder: public JPetTask
+class HitFinder: public PipelineStage
 {
 
 public:
@@ -51,21 +58,26 @@ public:
 	virtual void init(const JPetTaskInterface::Options& opts)override;
 	virtual void exec()override;
 	virtual void terminate()override;
-	virtual void setWriter(JPetWriter* writer)override;
-	std::map<int, std::vector<double>> fVelocityMap;
 
 protected:
 
-  	//Index that defines a given DAQ time window (defined at the hardware level)
-	int kTimeSlotIndex;
-	bool kFirstTime = true;
+	/// signals of the current DAQ time window (defined at the hardware level)
+	WindowAccumulator<JPetPhysSignal> fSignals;
+	TH1F* fHitsPerTimeWindowHisto = nullptr;
 	HitFinderTools::SignalsContainer fAllSignalsInTimeWindow;
 	HitFinderTools HitTools;
-  	std::map<int, std::vector<double>> readVelocityFile();
-	void fillSignalsMap(JPetPhysSignal signal);
+	VelocityCalibTable fVelocityCalibration;
+	BarrelSlotGeometry fSlotGeometry;
+	CompactHitWriter fCompactWriter;
+	void findHits(const std::vector<JPetPhysSignal>& signals);
+	void fillSignalsMap(const JPetPhysSignal& signal);
 	void saveHits(const std::vector<JPetHit>& hits);
-	JPetWriter* fWriter;
 	const std::string fTimeWindowWidthParamKey = "HitFinder_TimeWindowWidth";
+	const std::string fVelocityFileParamKey = "HitFinder_VelocityFile";
+	const std::string fVelocityThresholdParamKey = "HitFinder_VelocityThreshold";
+	const std::string fCompactOutputParamKey = "HitFinder_CompactOutput";
+	std::string fVelocityFile = "resultsForThresholda.txt";
+	int fVelocityThreshold = 1; /// threshold of the velocities used for the hit positions
 	double kTimeWindowWidth = 50000; /// in ps -> 50ns. Maximal time difference between signals
 
 };
@@ -14,88 +14,228 @@
  */
 
 #include "HitFinderTools.h"
+#include <algorithm>
 #include <cmath> /// std::sin(), std::cos()
 #include <TMath.h> /// DegToRad()
 
 using namespace std;
 
-vector<JPetHit> HitFinderTools::createHits(JPetStatistics& stats,
-    const SignalsContainer& allSignalsInTimeWindow,
-    const double timeDifferenceWindow,
-    const std::map<int, std::vector<double>> velMap)
+namespace
+{
+
+bool isEarlier(const JPetPhysSignal* signal1, const JPetPhysSignal* signal2)
+{
+  return signal1->getTime() < signal2->getTime();
+}
+
+/// Fills sorted with the pointers to the signals ordered by time.
+void sortByTime(const vector<JPetPhysSignal>& signals, vector<const JPetPhysSignal*>& sorted)
+{
+  sorted.clear();
+  for (const auto& signal : signals) {
+    sorted.push_back(&signal);
+  }
+  if (!std::is_sorted(sorted.begin(), sorted.end(), isEarlier)) {
+    std::stable_sort(sorted.begin(), sorted.end(), isEarlier);
+  }
+}
+
+/// Calls createHit for every pair of signals from the opposite sides closer than the window
+/// and stores the hits, in the order described in HitFinderTools::createHits.
+template <class CreateHit>
+vector<JPetHit> matchSides(JPetStatistics& stats,
+                           const HitFinderTools::SignalsContainer& allSignalsInTimeWindow,
+                           const double timeDifferenceWindow,
+                           const CreateHit& createHit)
 {
   vector<JPetHit> hits;
+  /// reused between the time windows to avoid allocations
+  static thread_local vector<const JPetPhysSignal*> sideA;
+  static thread_local vector<const JPetPhysSignal*> sideB;
+  /// looked up by name once per time window, not for every hit
+  TH2F& timeDiffHisto = stats.getHisto2D("time_diff_per_scin");
+  TH2F& hitPosHisto = stats.getHisto2D("hit_pos_per_scin");
+
+  for (const auto& scintillator : allSignalsInTimeWindow) {
 
-  for (auto scintillator : allSignalsInTimeWindow) {
-
-    auto sideA = scintillator.second.first;
-    auto sideB = scintillator.second.second;
-
-    if (sideA.size() > 0 && sideB.size() > 0) {
-
-      std::sort(sideA.begin(),
-                sideA.end(),
-                [] (const JPetPhysSignal & h1,
-      const JPetPhysSignal & h2) {
-        return h1.getTime() < h2.getTime();
-      });
-
-      std::sort(sideB.begin(),
-                sideB.end(),
-                [] (const JPetPhysSignal & h1,
-      const JPetPhysSignal & h2) {
-        return h1.getTime() < h2.getTime();
-      });
-
-      for (auto signalA : sideA) {
-        for (auto signalB : sideB) {
-
-          if ((signalB.getTime() - signalA.getTime())
-              > timeDifferenceWindow)
-            break;
-
-          if (fabs(signalA.getTime() - signalB.getTime())
-              < timeDifferenceWindow) {
-
-            //Creating hit for successfully matched pair of Phys singlas
-            //Setting meaningless parameters of Energy, Position, quality
-            JPetHit hit;
-            hit.setSignalA(signalA);
-            hit.setSignalB(signalB);
-            hit.setTime((signalA.getTime() + signalB.getTime()) / 2.0);
-            hit.setQualityOfTime(-1.0);
-            hit.setTimeDiff(signalA.getTime() - signalB.getTime());
-            hit.setQualityOfTimeDiff(-1.0);
-            hit.setEnergy(-1.0);
-            hit.setQualityOfEnergy(-1.0);
-            hit.setScintillator(signalA.getPM().getScin());
-            hit.setBarrelSlot(signalA.getPM().getBarrelSlot());
-            auto radius = hit.getBarrelSlot().getLayer().getRadius();
-            auto theta = TMath::DegToRad() * hit.getBarrelSlot().getTheta();
-            hit.setPosX(radius * std::cos(theta));
-            hit.setPosY(radius * std::sin(theta));
-            auto search = velMap.find(hit.getBarrelSlot().getID());
-            if (search != velMap.end()) {
-              double vel = search->second.at(0);
-              double position = vel * hit.getTimeDiff() / 2000;
-              hit.setPosZ(position);
-            } else {
-              hit.setPosZ(-1000000.0);
-            }
-
-            hits.push_back(hit);
-
-            stats.getHisto2D("time_diff_per_scin")
-            .Fill(hit.getTimeDiff(),
-                  (float) (hit.getScintillator().getID()));
-
-            stats.getHisto2D("hit_pos_per_scin")
-            .Fill(hit.getPosZ(),
-                  (float) (hit.getScintillator().getID()));
-          }
-        }
+    if (scintillator.second.first.empty() || scintillator.second.second.empty()) {
+      continue;
+    }
+    sortByTime(scintillator.second.first, sideA);
+    sortByTime(scintillator.second.second, sideB);
+
+    /// The signals on side B matching a signal on side A form a range which
+    /// only moves forward with the time of the signal on side A:
+    /// firstB is the first signal on side B not too early for the current signal on side A.
+    auto firstB = sideB.begin();
+    for (auto signalA : sideA) {
+      while (firstB != sideB.end()
+             && signalA->getTime() - (*firstB)->getTime() >= timeDifferenceWindow) {
+        ++firstB;
+      }
+      for (auto signalB = firstB; signalB != sideB.end()
+           && (*signalB)->getTime() - signalA->getTime() < timeDifferenceWindow; ++signalB) {
+
+        JPetHit hit = createHit(*signalA, **signalB);
+        hits.push_back(hit);
+
+        timeDiffHisto.Fill(hit.getTimeDiff(),
+                           (float) (hit.getScintillator().getID()));
+
+        hitPosHisto.Fill(hit.getPosZ(),
+                         (float) (hit.getScintillator().getID()));
       }
     }
   }
   return hits;
 }
+
+}
+
+void BarrelSlotGeometry::build(const JPetParamBank& paramBank, const std::map<int, std::vector<double>>& velMap)
+{
+  fSlots.clear();
+  fNumOfSlots = 0;
+  for (const auto& slot : paramBank.getBarrelSlots()) {
+    addSlot(*slot.second, velMap);
+  }
+}
+
+void BarrelSlotGeometry::addSlot(const JPetBarrelSlot& slot, const std::map<int, std::vector<double>>& velMap)
+{
+  auto search = velMap.find(slot.getID());
+  bool hasVelocity = search != velMap.end();
+  setSlot(slot, hasVelocity, hasVelocity ? search->second.at(0) : 0.);
+}
+
+void BarrelSlotGeometry::build(const JPetParamBank& paramBank, const VelocityCalibTable& velocities, int threshold)
+{
+  fSlots.clear();
+  fNumOfSlots = 0;
+  for (const auto& slot : paramBank.getBarrelSlots()) {
+    addSlot(*slot.second, velocities, threshold);
+  }
+}
+
+void BarrelSlotGeometry::addSlot(const JPetBarrelSlot& slot, const VelocityCalibTable& velocities, int threshold)
+{
+  setSlot(slot, velocities.isValid(slot.getID(), threshold), velocities.getVelocity(slot.getID(), threshold));
+}
+
+void BarrelSlotGeometry::setSlot(const JPetBarrelSlot& slot, bool hasVelocity, double velocity)
+{
+  if (slot.getID() < 0) {
+    return;
+  }
+  if (fSlots.size() <= static_cast<std::size_t>(slot.getID())) {
+    fSlots.resize(slot.getID() + 1);
+  }
+  auto& entry = fSlots[slot.getID()];
+  if (!entry.valid) {
+    fNumOfSlots++;
+  }
+  /// the same expressions as in the hit creation, so the positions do not change
+  auto radius = slot.getLayer().getRadius();
+  auto theta = TMath::DegToRad() * slot.getTheta();
+  entry.posX = radius * std::cos(theta);
+  entry.posY = radius * std::sin(theta);
+  entry.hasVelocity = hasVelocity;
+  entry.velocity = velocity;
+  entry.valid = true;
+}
+
+const BarrelSlotGeometry::Slot* BarrelSlotGeometry::getSlot(int slotID) const
+{
+  if (slotID < 0 || static_cast<std::size_t>(slotID) >= fSlots.size() || !fSlots[slotID].valid) {
+    return nullptr;
+  }
+  return &fSlots[slotID];
+}
+
+std::size_t BarrelSlotGeometry::getNumOfSlots() const
+{
+  return fNumOfSlots;
+}
+
+vector<JPetHit> HitFinderTools::createHits(JPetStatistics& stats,
+    const SignalsContainer& allSignalsInTimeWindow,
+    const double timeDifferenceWindow,
+    const std::map<int, std::vector<double>>& velMap)
+{
+  return matchSides(stats, allSignalsInTimeWindow, timeDifferenceWindow,
+  [&velMap](const JPetPhysSignal & signalA, const JPetPhysSignal & signalB) {
+    return createHit(signalA, signalB, velMap);
+  });
+}
+
+vector<JPetHit> HitFinderTools::createHits(JPetStatistics& stats,
+    const SignalsContainer& allSignalsInTimeWindow,
+    const double timeDifferenceWindow,
+    const BarrelSlotGeometry& geometry)
+{
+  return matchSides(stats, allSignalsInTimeWindow, timeDifferenceWindow,
+  [&geometry](const JPetPhysSignal & signalA, const JPetPhysSignal & signalB) {
+    return createHit(signalA, signalB, geometry);
+  });
+}
+
+JPetHit HitFinderTools::createHit(const JPetPhysSignal& signalA, const JPetPhysSignal& signalB,
+                                  const std::map<int, std::vector<double>>& velMap)
+{
+  //Creating hit for successfully matched pair of Phys singlas
+  //Setting meaningless parameters of Energy, Position, quality
+  JPetHit hit;
+  hit.setSignalA(signalA);
+  hit.setSignalB(signalB);
+  hit.setTime((signalA.getTime() + signalB.getTime()) / 2.0);
+  hit.setQualityOfTime(-1.0);
+  hit.setTimeDiff(signalA.getTime() - signalB.getTime());
+  hit.setQualityOfTimeDiff(-1.0);
+  hit.setEnergy(-1.0);
+  hit.setQualityOfEnergy(-1.0);
+  hit.setScintillator(signalA.getPM().getScin());
+  hit.setBarrelSlot(signalA.getPM().getBarrelSlot());
+  auto radius = hit.getBarrelSlot().getLayer().getRadius();
+  auto theta = TMath::DegToRad() * hit.getBarrelSlot().getTheta();
+  hit.setPosX(radius * std::cos(theta));
+  hit.setPosY(radius * std::sin(theta));
+  auto search = velMap.find(hit.getBarrelSlot().getID());
+  if (search != velMap.end()) {
+    double vel = search->second.at(0);
+    double position = vel * hit.getTimeDiff() / 2000;
+    hit.setPosZ(position);
+  } else {
+    hit.setPosZ(-1000000.0);
+  }
+  return hit;
+}
+
+JPetHit HitFinderTools::createHit(const JPetPhysSignal& signalA, const JPetPhysSignal& signalB,
+                                  const BarrelSlotGeometry& geometry)
+{
+  const auto& slot = signalA.getPM().getBarrelSlot();
+  auto slotGeometry = geometry.getSlot(slot.getID());
+  if (!slotGeometry) {
+    /// slot missing in the setup the geometry was built from, no velocity known
+    return createHit(signalA, signalB, std::map<int, std::vector<double>>());
+  }
+  JPetHit hit;
+  hit.setSignalA(signalA);
+  hit.setSignalB(signalB);
+  hit.setTime((signalA.getTime() + signalB.getTime()) / 2.0);
+  hit.setQualityOfTime(-1.0);
+  hit.setTimeDiff(signalA.getTime() - signalB.getTime());
+  hit.setQualityOfTimeDiff(-1.0);
+  hit.setEnergy(-1.0);
+  hit.setQualityOfEnergy(-1.0);
+  hit.setScintillator(signalA.getPM().getScin());
+  hit.setBarrelSlot(slot);
+  hit.setPosX(slotGeometry->posX);
+  hit.setPosY(slotGeometry->posY);
+  if (slotGeometry->hasVelocity) {
+    hit.setPosZ(slotGeometry->velocity * hit.getTimeDiff() / 2000);
+  } else {
+    hit.setPosZ(-1000000.0);
+  }
+  return hit;
+}
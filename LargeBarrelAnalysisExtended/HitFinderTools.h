@@ -18,9 +18,47 @@
 
 #include <JPetHit/JPetHit.h>
 #include <JPetStatistics/JPetStatistics.h>
+#include <JPetParamBank/JPetParamBank.h>
+#include "VelocityCalibTools.h"
 
+#include <map>
 #include <vector>
 
+/**
+ * @brief Per barrel slot quantities used to reconstruct the hit position.
+ *
+ * The position of the scintillator in the XY plane (radius of the layer times
+ * cosine and sine of the slot angle) and the effective light velocity are computed
+ * once per slot, so creating a hit needs only one table lookup by the slot ID.
+ */
+class BarrelSlotGeometry
+{
+public:
+  struct Slot {
+    double posX = 0.;
+    double posY = 0.;
+    double velocity = 0.;
+    bool hasVelocity = false;
+    bool valid = false;
+  };
+
+  /// Adds all barrel slots of the setup, velocities are taken from the first
+  /// value stored for the slot ID in the velocity map.
+  void build(const JPetParamBank& paramBank, const std::map<int, std::vector<double>>& velMap);
+  void addSlot(const JPetBarrelSlot& slot, const std::map<int, std::vector<double>>& velMap);
+  /// Versions of the above methods with the velocities of a given threshold taken from the calibration table.
+  void build(const JPetParamBank& paramBank, const VelocityCalibTable& velocities, int threshold);
+  void addSlot(const JPetBarrelSlot& slot, const VelocityCalibTable& velocities, int threshold);
+  /// Returns nullptr for the slots not added to the table.
+  const Slot* getSlot(int slotID) const;
+  std::size_t getNumOfSlots() const;
+
+private:
+  void setSlot(const JPetBarrelSlot& slot, bool hasVelocity, double velocity);
+  std::vector<Slot> fSlots;
+  std::size_t fNumOfSlots = 0;
+};
+
 class HitFinderTools
 {
 public:
@@ -34,12 +72,29 @@ public:
    *
    */
   typedef std::map <int, std::pair < std::vector<JPetPhysSignal>, std::vector<JPetPhysSignal> > > SignalsContainer;
+  /**
+   * Creates a hit for every pair of signals from the opposite sides of one scintillator
+   * closer in time than timeDifferenceWindow. The hits come ordered by scintillator ID,
+   * then by the time of the signal on side A and of the signal on side B.
+   * Both sides are swept once in time order, the signals are not copied.
+   */
+  std::vector<JPetHit> createHits(
+    JPetStatistics& stats,
+    const SignalsContainer& allSignalsInTimeWindow,
+    const double timeDifferenceWindow,
+    const std::map<int, std::vector<double>>& velMap
+  );
+  /// Same as above, with the hit positions taken from the precomputed slot geometry.
   std::vector<JPetHit> createHits(
     JPetStatistics& stats,
     const SignalsContainer& allSignalsInTimeWindow,
     const double timeDifferenceWindow,
-    const std::map<int, std::vector<double>> velMap
+    const BarrelSlotGeometry& geometry
   );
+  static JPetHit createHit(const JPetPhysSignal& signalA, const JPetPhysSignal& signalB,
+                           const std::map<int, std::vector<double>>& velMap);
+  static JPetHit createHit(const JPetPhysSignal& signalA, const JPetPhysSignal& signalB,
+                           const BarrelSlotGeometry& geometry);
 };
 
 #endif /*  !HITFINDERTOOLS_H */
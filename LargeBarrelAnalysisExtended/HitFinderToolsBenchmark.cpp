@@ -0,0 +1,199 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file HitFinderToolsBenchmark.cpp
+ *  @brief Microbenchmark of the matching of the signals from both sides of the scintillators.
+ *
+ *  Compares HitFinderTools::createHits with the previous version, which copied
+ *  and sorted the signals of each scintillator and compared every pair of them,
+ *  for growing numbers of signals per scintillator side in the 192 scintillators
+ *  of the three layers of the big barrel. The sweep is measured both with the hit
+ *  positions computed from the barrel slots and taken from the BarrelSlotGeometry.
+ *  The results are given in ns per signal.
+ *  Usage: HitFinderToolsBenchmark.x [--filter <text>] [--min-time <s>] [--repetitions <n>] [--csv]
+ */
+
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <random>
+#include "BenchmarkTools.h"
+#include "HitFinderTools.h"
+
+namespace
+{
+
+/// default HitFinder_TimeWindowWidth and the length of a DAQ time window, in ps
+const double kTimeDifferenceWindow = 50000.;
+const double kTimeWindowLength = 20000000.;
+const std::vector<long long> kSignalsPerSide = {1, 4, 16, 64, 256};
+
+/// The previous createHits, without filling the histograms.
+std::vector<JPetHit> createHitsByCopying(const HitFinderTools::SignalsContainer& allSignalsInTimeWindow,
+    const double timeDifferenceWindow,
+    const std::map<int, std::vector<double>>& velMap)
+{
+  std::vector<JPetHit> hits;
+  for (auto scintillator : allSignalsInTimeWindow) {
+    auto sideA = scintillator.second.first;
+    auto sideB = scintillator.second.second;
+    if (sideA.size() > 0 && sideB.size() > 0) {
+      auto isEarlier = [] (const JPetPhysSignal & h1, const JPetPhysSignal & h2) {
+        return h1.getTime() < h2.getTime();
+      };
+      std::sort(sideA.begin(), sideA.end(), isEarlier);
+      std::sort(sideB.begin(), sideB.end(), isEarlier);
+      for (auto signalA : sideA) {
+        for (auto signalB : sideB) {
+          if ((signalB.getTime() - signalA.getTime()) > timeDifferenceWindow)
+            break;
+          if (fabs(signalA.getTime() - signalB.getTime()) < timeDifferenceWindow) {
+            hits.push_back(HitFinderTools::createHit(signalA, signalB, velMap));
+          }
+        }
+      }
+    }
+  }
+  return hits;
+}
+
+/// The scintillators of the big barrel: 48, 48 and 96 slots in the three layers.
+class Barrel
+{
+public:
+  Barrel()
+  {
+    const int slotsInLayer[] = {48, 48, 96};
+    const double radii[] = {42.5, 46.75, 57.5};
+    int id = 1;
+    for (int layer = 0; layer < 3; layer++) {
+      fLayers.push_back(JPetLayer(layer + 1, true, "Layer", radii[layer]));
+      for (int slot = 0; slot < slotsInLayer[layer]; slot++, id++) {
+        fSlots.push_back(JPetBarrelSlot(id, true, "slot", 360. * slot / slotsInLayer[layer], slot + 1));
+        fSlots.back().setLayer(fLayers.back());
+        fScins.push_back(JPetScin(id));
+        fScins.back().setBarrelSlot(fSlots.back());
+        for (auto side : {JPetPM::SideA, JPetPM::SideB}) {
+          fPMs.push_back(JPetPM(2 * id + side, "pm"));
+          fPMs.back().setSide(side);
+          fPMs.back().setScin(fScins.back());
+          fPMs.back().setBarrelSlot(fSlots.back());
+        }
+      }
+    }
+  }
+
+  void fillGeometry(BarrelSlotGeometry& geometry, const std::map<int, std::vector<double>>& velMap) const
+  {
+    for (const auto& slot : fSlots) {
+      geometry.addSlot(slot, velMap);
+    }
+  }
+
+  int getNumOfScins() const
+  {
+    return fScins.size();
+  }
+
+  const JPetPM& getPM(int scinID, JPetPM::Side side) const
+  {
+    return fPMs.at(2 * (scinID - 1) + side);
+  }
+
+private:
+  std::deque<JPetLayer> fLayers;
+  std::deque<JPetBarrelSlot> fSlots;
+  std::deque<JPetScin> fScins;
+  std::deque<JPetPM> fPMs;
+};
+
+/// Signals of one time window, in the order of arrival, not sorted by time.
+HitFinderTools::SignalsContainer generateSignals(std::mt19937& generator, const Barrel& barrel,
+    int signalsPerSide, double timeWindowLength)
+{
+  std::uniform_real_distribution<double> time(0., timeWindowLength);
+  HitFinderTools::SignalsContainer signals;
+  for (int scinID = 1; scinID <= barrel.getNumOfScins(); scinID++) {
+    auto& sides = signals[scinID];
+    for (auto side : {JPetPM::SideA, JPetPM::SideB}) {
+      auto& signalsOnSide = side == JPetPM::SideA ? sides.first : sides.second;
+      JPetRawSignal raw;
+      raw.setPM(barrel.getPM(scinID, side));
+      JPetRecoSignal reco;
+      reco.setRawSignal(raw);
+      for (int i = 0; i < signalsPerSide; i++) {
+        JPetPhysSignal signal;
+        signal.setRecoSignal(reco);
+        signal.setTime(time(generator));
+        signalsOnSide.push_back(signal);
+      }
+    }
+  }
+  return signals;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  BenchmarkRunner runner(argc, argv);
+  Barrel barrel;
+  std::map<int, std::vector<double>> velMap;
+  for (int slot = 1; slot <= barrel.getNumOfScins(); slot++) {
+    velMap[slot] = {12.};
+  }
+  JPetStatistics stats;
+  stats.createHistogram(new TH2F("time_diff_per_scin", "", 200, -20000.0, 20000.0, 192, 1.0, 193.0));
+  stats.createHistogram(new TH2F("hit_pos_per_scin", "", 200, -150.0, 150.0, 192, 1.0, 193.0));
+  HitFinderTools tools;
+  BarrelSlotGeometry geometry;
+  barrel.fillGeometry(geometry, velMap);
+
+  /// all the versions must find the same number of hits
+  std::mt19937 generator(2017);
+  for (long long signalsPerSide : kSignalsPerSide) {
+    auto window = generateSignals(generator, barrel, signalsPerSide, kTimeWindowLength);
+    auto copyingHits = createHitsByCopying(window, kTimeDifferenceWindow, velMap).size();
+    if (copyingHits != tools.createHits(stats, window, kTimeDifferenceWindow, velMap).size()
+        || copyingHits != tools.createHits(stats, window, kTimeDifferenceWindow, geometry).size()) {
+      std::cerr << "The versions of createHits give different results!" << std::endl;
+      return 1;
+    }
+  }
+
+  /// one time window of the given number of signals per side, the same for every run
+  typedef std::function<std::size_t(const HitFinderTools::SignalsContainer&)> CreateHits;
+  auto runCreateHits = [&](BenchmarkState & state, const CreateHits & createHits) {
+    std::mt19937 generator(2017);
+    auto window = generateSignals(generator, barrel, state.getParameter(), kTimeWindowLength);
+    state.setObjectsPerIteration(2. * barrel.getNumOfScins() * state.getParameter());
+    while (state.keepRunning()) {
+      doNotOptimize(createHits(window));
+    }
+  };
+  runner.run("createHits/copying", kSignalsPerSide, [&](BenchmarkState & state) {
+    runCreateHits(state, [&](const HitFinderTools::SignalsContainer & window) {
+      return createHitsByCopying(window, kTimeDifferenceWindow, velMap).size();
+    });
+  });
+  runner.run("createHits/sweep", kSignalsPerSide, [&](BenchmarkState & state) {
+    runCreateHits(state, [&](const HitFinderTools::SignalsContainer & window) {
+      return tools.createHits(stats, window, kTimeDifferenceWindow, velMap).size();
+    });
+  });
+  runner.run("createHits/geometry", kSignalsPerSide, [&](BenchmarkState & state) {
+    runCreateHits(state, [&](const HitFinderTools::SignalsContainer & window) {
+      return tools.createHits(stats, window, kTimeDifferenceWindow, geometry).size();
+    });
+  });
+  return 0;
+}
@@ -0,0 +1,215 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE HitFinderToolsTest
+#include <boost/test/unit_test.hpp>
+
+#include <deque>
+#include "HitFinderTools.h"
+
+/// Scintillators of one layer with the photomultipliers on both sides, kept in deques,
+/// because the signals refer to them.
+class Barrel
+{
+public:
+  explicit Barrel(int numOfScins)
+  {
+    fLayers.push_back(JPetLayer(1, true, "Layer01", 42.5));
+    for (int id = 1; id <= numOfScins; id++) {
+      fSlots.push_back(JPetBarrelSlot(id, true, "slot", 7.5 * id, id));
+      fSlots.back().setLayer(fLayers.back());
+      fScins.push_back(JPetScin(id));
+      fScins.back().setBarrelSlot(fSlots.back());
+      for (auto side : {JPetPM::SideA, JPetPM::SideB}) {
+        fPMs.push_back(JPetPM(2 * id + side, "pm"));
+        fPMs.back().setSide(side);
+        fPMs.back().setScin(fScins.back());
+        fPMs.back().setBarrelSlot(fSlots.back());
+      }
+    }
+  }
+
+  void fillGeometry(BarrelSlotGeometry& geometry, const std::map<int, std::vector<double>>& velMap) const
+  {
+    for (const auto& slot : fSlots) {
+      geometry.addSlot(slot, velMap);
+    }
+  }
+
+  void fillGeometry(BarrelSlotGeometry& geometry, const VelocityCalibTable& velocities, int threshold) const
+  {
+    for (const auto& slot : fSlots) {
+      geometry.addSlot(slot, velocities, threshold);
+    }
+  }
+
+  JPetPhysSignal createSignal(int scinID, JPetPM::Side side, double time) const
+  {
+    JPetRawSignal raw;
+    raw.setPM(fPMs.at(2 * (scinID - 1) + side));
+    JPetRecoSignal reco;
+    reco.setRawSignal(raw);
+    JPetPhysSignal signal;
+    signal.setRecoSignal(reco);
+    signal.setTime(time);
+    return signal;
+  }
+
+  void addSignal(HitFinderTools::SignalsContainer& signals, int scinID, JPetPM::Side side, double time) const
+  {
+    auto& sides = signals[scinID];
+    (side == JPetPM::SideA ? sides.first : sides.second).push_back(createSignal(scinID, side, time));
+  }
+
+private:
+  std::deque<JPetLayer> fLayers;
+  std::deque<JPetBarrelSlot> fSlots;
+  std::deque<JPetScin> fScins;
+  std::deque<JPetPM> fPMs;
+};
+
+struct HitFinderToolsFixture {
+  HitFinderToolsFixture(): barrel(8)
+  {
+    stats.createHistogram(new TH2F("time_diff_per_scin", "", 200, -20000.0, 20000.0, 192, 1.0, 193.0));
+    stats.createHistogram(new TH2F("hit_pos_per_scin", "", 200, -150.0, 150.0, 192, 1.0, 193.0));
+  }
+  Barrel barrel;
+  JPetStatistics stats;
+  HitFinderTools tools;
+  std::map<int, std::vector<double>> velMap = {{1, {10.}}};
+};
+
+void checkHit(const JPetHit& hit, int scinID, double timeA, double timeB)
+{
+  BOOST_REQUIRE_EQUAL(hit.getScintillator().getID(), scinID);
+  BOOST_REQUIRE_EQUAL(hit.getSignalA().getTime(), timeA);
+  BOOST_REQUIRE_EQUAL(hit.getSignalB().getTime(), timeB);
+}
+
+BOOST_FIXTURE_TEST_SUITE(HitFinderToolsSuite, HitFinderToolsFixture)
+
+BOOST_AUTO_TEST_CASE( createHits_empty )
+{
+  HitFinderTools::SignalsContainer signals;
+  BOOST_REQUIRE(tools.createHits(stats, signals, 50000., velMap).empty());
+  barrel.addSignal(signals, 1, JPetPM::SideA, 10.);
+  barrel.addSignal(signals, 2, JPetPM::SideB, 10.);
+  BOOST_REQUIRE(tools.createHits(stats, signals, 50000., velMap).empty());
+}
+
+BOOST_AUTO_TEST_CASE( createHits )
+{
+  HitFinderTools::SignalsContainer signals;
+  barrel.addSignal(signals, 1, JPetPM::SideA, 20.);
+  barrel.addSignal(signals, 1, JPetPM::SideA, 0.);
+  barrel.addSignal(signals, 1, JPetPM::SideB, 31.);
+  barrel.addSignal(signals, 1, JPetPM::SideB, 15.);
+  barrel.addSignal(signals, 1, JPetPM::SideB, 5.);
+  /// the time difference equal to the window does not make a hit
+  barrel.addSignal(signals, 2, JPetPM::SideA, 100.);
+  barrel.addSignal(signals, 2, JPetPM::SideB, 90.);
+  barrel.addSignal(signals, 2, JPetPM::SideB, 110.);
+  barrel.addSignal(signals, 2, JPetPM::SideB, 109.);
+
+  auto hits = tools.createHits(stats, signals, 10., velMap);
+  BOOST_REQUIRE_EQUAL(hits.size(), 3u);
+  BOOST_REQUIRE_EQUAL(hits[0].getSignalA().getTime(), 0.);
+  BOOST_REQUIRE_EQUAL(hits[0].getSignalB().getTime(), 5.);
+  BOOST_REQUIRE_EQUAL(hits[1].getSignalA().getTime(), 20.);
+  BOOST_REQUIRE_EQUAL(hits[1].getSignalB().getTime(), 15.);
+  BOOST_REQUIRE_EQUAL(hits[2].getSignalA().getTime(), 100.);
+  BOOST_REQUIRE_EQUAL(hits[2].getSignalB().getTime(), 109.);
+  for (int i = 0; i < 2; i++) {
+    BOOST_REQUIRE_EQUAL(hits[i].getScintillator().getID(), 1);
+    BOOST_REQUIRE_CLOSE(hits[i].getTime(), (hits[i].getSignalA().getTime() + hits[i].getSignalB().getTime()) / 2., 0.001);
+    BOOST_REQUIRE_CLOSE(hits[i].getPosZ(), 10. * hits[i].getTimeDiff() / 2000., 0.001);
+  }
+  BOOST_REQUIRE_EQUAL(hits[2].getScintillator().getID(), 2);
+  BOOST_REQUIRE_EQUAL(hits[2].getPosZ(), -1000000.0);
+}
+
+BOOST_AUTO_TEST_CASE( createHits_overlappingPairs )
+{
+  /// a signal can be a part of many hits, every pair closer than the window is taken
+  HitFinderTools::SignalsContainer signals;
+  barrel.addSignal(signals, 3, JPetPM::SideA, 4.);
+  barrel.addSignal(signals, 3, JPetPM::SideA, 0.);
+  barrel.addSignal(signals, 3, JPetPM::SideB, 6.);
+  barrel.addSignal(signals, 3, JPetPM::SideB, 2.);
+  /// equal times on both sides
+  barrel.addSignal(signals, 4, JPetPM::SideA, 50.);
+  barrel.addSignal(signals, 4, JPetPM::SideB, 50.);
+  barrel.addSignal(signals, 4, JPetPM::SideB, 50.);
+  BarrelSlotGeometry geometry;
+  barrel.fillGeometry(geometry, velMap);
+  for (const auto& hits : {tools.createHits(stats, signals, 5., velMap), tools.createHits(stats, signals, 5., geometry)}) {
+    BOOST_REQUIRE_EQUAL(hits.size(), 5u);
+    checkHit(hits[0], 3, 0., 2.);
+    checkHit(hits[1], 3, 4., 2.);
+    checkHit(hits[2], 3, 4., 6.);
+    checkHit(hits[3], 4, 50., 50.);
+    checkHit(hits[4], 4, 50., 50.);
+    BOOST_REQUIRE_EQUAL(hits[3].getTimeDiff(), 0.);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( barrelSlotGeometry )
+{
+  BarrelSlotGeometry geometry;
+  BOOST_REQUIRE_EQUAL(geometry.getNumOfSlots(), 0u);
+  BOOST_REQUIRE(!geometry.getSlot(1));
+  barrel.fillGeometry(geometry, velMap);
+  BOOST_REQUIRE_EQUAL(geometry.getNumOfSlots(), 8u);
+  BOOST_REQUIRE(!geometry.getSlot(0));
+  BOOST_REQUIRE(!geometry.getSlot(9));
+  BOOST_REQUIRE(!geometry.getSlot(-1));
+  BOOST_REQUIRE(geometry.getSlot(1)->hasVelocity);
+  BOOST_REQUIRE_EQUAL(geometry.getSlot(1)->velocity, 10.);
+  BOOST_REQUIRE(!geometry.getSlot(2)->hasVelocity);
+  /// the slot 8 is at 60 degrees
+  BOOST_REQUIRE_CLOSE(geometry.getSlot(8)->posX, 42.5 * std::cos(TMath::DegToRad() * 60.), 0.001);
+  BOOST_REQUIRE_CLOSE(geometry.getSlot(8)->posY, 42.5 * std::sin(TMath::DegToRad() * 60.), 0.001);
+
+  /// a slot missing in the geometry gives the hit without the position along the scintillator
+  HitFinderTools::SignalsContainer signals;
+  barrel.addSignal(signals, 1, JPetPM::SideA, 0.);
+  barrel.addSignal(signals, 1, JPetPM::SideB, 5.);
+  BarrelSlotGeometry empty;
+  auto hits = tools.createHits(stats, signals, 10., empty);
+  BOOST_REQUIRE_EQUAL(hits.size(), 1u);
+  BOOST_REQUIRE_EQUAL(hits[0].getPosZ(), -1000000.0);
+  hits = tools.createHits(stats, signals, 10., geometry);
+  BOOST_REQUIRE_EQUAL(hits.size(), 1u);
+  BOOST_REQUIRE_CLOSE(hits[0].getPosZ(), 10. * -5. / 2000., 0.001);
+}
+
+BOOST_AUTO_TEST_CASE( barrelSlotGeometry_velocityCalibTable )
+{
+  VelocityCalibTable velocities;
+  velocities.setVelocity(1, 1, 10., 0.1);
+  velocities.setVelocity(1, 2, 12., 0.1);
+  velocities.setVelocity(3, 1, 11., 0.1);
+  BarrelSlotGeometry geometry;
+  barrel.fillGeometry(geometry, velocities, 2);
+  BOOST_REQUIRE_EQUAL(geometry.getNumOfSlots(), 8u);
+  BOOST_REQUIRE(geometry.getSlot(1)->hasVelocity);
+  BOOST_REQUIRE_EQUAL(geometry.getSlot(1)->velocity, 12.);
+  BOOST_REQUIRE(!geometry.getSlot(3)->hasVelocity);
+
+  /// the positions along the scintillators with the velocities of the first threshold
+  BarrelSlotGeometry firstThreshold;
+  barrel.fillGeometry(firstThreshold, velocities, 1);
+  HitFinderTools::SignalsContainer signals;
+  for (int scinID : {1, 2, 3}) {
+    barrel.addSignal(signals, scinID, JPetPM::SideA, 100. * scinID);
+    barrel.addSignal(signals, scinID, JPetPM::SideB, 100. * scinID + 7.);
+  }
+  auto hits = tools.createHits(stats, signals, 10., firstThreshold);
+  BOOST_REQUIRE_EQUAL(hits.size(), 3u);
+  BOOST_REQUIRE_CLOSE(hits[0].getPosZ(), 10. * -7. / 2000., 0.001);
+  BOOST_REQUIRE_EQUAL(hits[1].getPosZ(), -1000000.0);
+  BOOST_REQUIRE_CLOSE(hits[2].getPosZ(), 11. * -7. / 2000., 0.001);
+  BOOST_REQUIRE_CLOSE(hits[2].getPosX(), 42.5 * std::cos(TMath::DegToRad() * 22.5), 0.001);
+  BOOST_REQUIRE_CLOSE(hits[2].getPosY(), 42.5 * std::sin(TMath::DegToRad() * 22.5), 0.001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
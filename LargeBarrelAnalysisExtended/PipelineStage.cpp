@@ -0,0 +1,63 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file PipelineStage.cpp
+ */
+
+#include <chrono>
+#include "PipelineStage.h"
+
+PipelineStage::PipelineStage(const char* name, const char* description):
+  JPetTask(name, description) {}
+
+PipelineStage::~PipelineStage() {}
+
+void PipelineStage::setWriter(JPetWriter* writer)
+{
+  fWriter = writer;
+}
+
+void PipelineStage::setNextStage(PipelineStage* next)
+{
+  fNextStage = next;
+}
+
+PipelineStage* PipelineStage::getNextStage() const
+{
+  return fNextStage;
+}
+
+void PipelineStage::setOutputQueue(StageQueue* queue)
+{
+  fOutputQueue = queue;
+}
+
+double PipelineStage::process(TObject* obj)
+{
+  auto start = std::chrono::steady_clock::now();
+  setEvent(obj);
+  exec();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fCounters.objectsIn++;
+  fCounters.execWallTime += elapsed;
+  return elapsed;
+}
+
+const PipelineStage::Counters& PipelineStage::getCounters() const
+{
+  return fCounters;
+}
+
+long long PipelineStage::getNumOfOutputObjects() const
+{
+  return fCounters.objectsOut;
+}
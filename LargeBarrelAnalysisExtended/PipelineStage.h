@@ -0,0 +1,102 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file PipelineStage.h
+ *  @brief Base class of the tasks that can be chained in memory by FusedPipeline.
+ */
+
+#ifndef PIPELINESTAGE_H
+#define PIPELINESTAGE_H
+
+#include <JPetTask/JPetTask.h>
+#include <JPetWriter/JPetWriter.h>
+#include "BoundedQueue.h"
+#include "ProfiledTask.h"
+
+#ifdef __CINT__
+//when cint is used instead of compiler, override word is not recognized
+//nevertheless it's needed for checking if the structure of project is correct
+#	define override
+#endif
+
+/**
+ * @brief Task which passes its output objects either to a writer,
+ * to the next stage in memory, or to both.
+ *
+ * When the task is run by a JPetTaskLoader, only the writer is set and the
+ * stage behaves like a plain JPetTask. When it is a part of a FusedPipeline,
+ * every object given to forward() is immediately processed by the exec()
+ * of the next stage, so no intermediate file has to be written and read back.
+ * The writer is then set only if the user asked to keep the intermediate output.
+ * In the threaded mode of the FusedPipeline each stage runs in its own thread and
+ * the copies of the forwarded objects are pushed to the output queue instead.
+ */
+class PipelineStage: public JPetTask, public OutputCounter
+{
+public:
+  typedef BoundedQueue<TObject*> StageQueue;
+
+  /// Objects and wall time (in s) of the stage, for the summary of the FusedPipeline.
+  struct Counters {
+    long long objectsIn = 0;
+    long long objectsOut = 0;
+    /// time of exec(), including the next stages run from forward()
+    double execWallTime = 0.;
+    /// time of the next stages run from forward(), in exec() and terminate()
+    double downstreamWallTime = 0.;
+  };
+
+  PipelineStage(const char* name, const char* description);
+  virtual ~PipelineStage();
+  virtual void setWriter(JPetWriter* writer) override;
+  /// Sets the stage which consumes the objects produced by this one.
+  /// nullptr means that this is the last stage of the chain.
+  void setNextStage(PipelineStage* next);
+  PipelineStage* getNextStage() const;
+  /// Sets the queue read by the thread of the next stage. The queue takes precedence
+  /// over the next stage set with setNextStage(). The consumer owns the pushed objects.
+  void setOutputQueue(StageQueue* queue);
+  /// Runs exec() for the object, updating the counters. Returns the time spent in s.
+  double process(TObject* obj);
+  const Counters& getCounters() const;
+  virtual long long getNumOfOutputObjects() const override;
+
+protected:
+  /// Method passes the object downstream. It must be used by the derived classes
+  /// instead of calling fWriter->write() directly.
+  template <class T>
+  void forward(const T& obj);
+
+  JPetWriter* fWriter = nullptr;
+  PipelineStage* fNextStage = nullptr;
+  StageQueue* fOutputQueue = nullptr;
+  Counters fCounters;
+};
+
+template <class T>
+void PipelineStage::forward(const T& obj)
+{
+  assert(fWriter || fNextStage || fOutputQueue);
+  fCounters.objectsOut++;
+  if (fWriter) {
+    fWriter->write(obj);
+  }
+  if (fOutputQueue) {
+    fOutputQueue->push(new T(obj));
+  } else if (fNextStage) {
+    /// The object lives only until this call returns,
+    /// the next stage must copy whatever it wants to keep.
+    fCounters.downstreamWallTime += fNextStage->process(const_cast<T*>(&obj));
+  }
+}
+
+#endif /*  !PIPELINESTAGE_H */
@@ -0,0 +1,270 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file ProfiledTask.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+#include "ProfiledTask.h"
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Difference of two measurements, -1 if any of them is not known.
+long long difference(long long end, long long start)
+{
+  return (end < 0 || start < 0) ? -1 : end - start;
+}
+
+/// Column of the summary table, "-" for the quantities not measured.
+std::string formatColumn(double value, int precision, double scale = 1.)
+{
+  if (value < 0.) {
+    return "-";
+  }
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(precision) << value / scale;
+  return out.str();
+}
+
+std::string escapeJson(const std::string& text)
+{
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+}
+
+double TaskProfile::getTotalWallTime() const
+{
+  return initWallTime + execWallTime + terminateWallTime;
+}
+
+double TaskProfile::getInputRate() const
+{
+  return execWallTime > 0. ? objectsIn / execWallTime : 0.;
+}
+
+double TaskProfile::getOutputRate() const
+{
+  return (execWallTime > 0. && objectsOut >= 0) ? objectsOut / execWallTime : 0.;
+}
+
+ResourceUsage ResourceUsage::now()
+{
+  ResourceUsage usage;
+  usage.cpuTime = getThreadCPUTime();
+  rusage self;
+  if (getrusage(RUSAGE_SELF, &self) == 0) {
+    usage.peakRSS = self.ru_maxrss;
+  }
+  std::ifstream io("/proc/thread-self/io");
+  std::string key;
+  long long value = 0;
+  while (io >> key >> value) {
+    if (key == "rchar:") {
+      usage.bytesRead = value;
+    } else if (key == "wchar:") {
+      usage.bytesWritten = value;
+    }
+  }
+  return usage;
+}
+
+double ResourceUsage::getThreadCPUTime()
+{
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return -1.;
+  }
+  return time.tv_sec + time.tv_nsec * 1.e-9;
+}
+
+TaskProfiler& TaskProfiler::getProfiler()
+{
+  static TaskProfiler profiler;
+  return profiler;
+}
+
+void TaskProfiler::addProfile(const TaskProfile& profile)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fProfiles.push_back(profile);
+}
+
+std::vector<TaskProfile> TaskProfiler::getProfiles() const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  return fProfiles;
+}
+
+void TaskProfiler::setJsonFileName(const std::string& fileName)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fJsonFileName = fileName;
+}
+
+void TaskProfiler::clear()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fProfiles.clear();
+  fJsonFileName.clear();
+}
+
+void TaskProfiler::printSummary(std::ostream& out) const
+{
+  const double kMB = 1024. * 1024.;
+  out << std::left << std::setw(40) << "task" << std::right
+      << std::setw(10) << "init [s]" << std::setw(10) << "exec [s]" << std::setw(10) << "term [s]"
+      << std::setw(10) << "CPU [s]" << std::setw(12) << "in" << std::setw(12) << "in/s"
+      << std::setw(12) << "out" << std::setw(12) << "out/s"
+      << std::setw(11) << "read [MB]" << std::setw(11) << "wrote [MB]" << std::setw(10) << "RSS [MB]" << std::endl;
+  for (const auto& profile : getProfiles()) {
+    out << std::left << std::setw(40) << profile.name << std::right
+        << std::setw(10) << formatColumn(profile.initWallTime, 3)
+        << std::setw(10) << formatColumn(profile.execWallTime, 3)
+        << std::setw(10) << formatColumn(profile.terminateWallTime, 3)
+        << std::setw(10) << formatColumn(profile.cpuTime, 3)
+        << std::setw(12) << profile.objectsIn
+        << std::setw(12) << formatColumn(profile.getInputRate(), 0)
+        << std::setw(12) << formatColumn(profile.objectsOut, 0)
+        << std::setw(12) << formatColumn(profile.objectsOut < 0 ? -1. : profile.getOutputRate(), 0)
+        << std::setw(11) << formatColumn(profile.bytesRead, 1, kMB)
+        << std::setw(11) << formatColumn(profile.bytesWritten, 1, kMB)
+        << std::setw(10) << formatColumn(profile.peakRSS, 1, 1024.) << std::endl;
+  }
+}
+
+void TaskProfiler::writeJson(std::ostream& out) const
+{
+  auto profiles = getProfiles();
+  out << "{\n  \"tasks\": [";
+  for (std::size_t i = 0; i < profiles.size(); i++) {
+    const auto& profile = profiles[i];
+    out << (i == 0 ? "\n" : ",\n")
+        << "    {\"name\": \"" << escapeJson(profile.name) << "\""
+        << ", \"initWallTime\": " << profile.initWallTime
+        << ", \"execWallTime\": " << profile.execWallTime
+        << ", \"terminateWallTime\": " << profile.terminateWallTime
+        << ", \"cpuTime\": " << profile.cpuTime
+        << ", \"objectsIn\": " << profile.objectsIn
+        << ", \"objectsOut\": " << profile.objectsOut
+        << ", \"bytesRead\": " << profile.bytesRead
+        << ", \"bytesWritten\": " << profile.bytesWritten
+        << ", \"peakRSS\": " << profile.peakRSS << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void TaskProfiler::finish(std::ostream& out)
+{
+  printSummary(out);
+  std::string fileName;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fileName = fJsonFileName;
+  }
+  if (fileName.empty()) {
+    return;
+  }
+  std::ofstream json(fileName);
+  if (!json) {
+    ERROR("Task profiles can not be saved to " + fileName);
+    return;
+  }
+  writeJson(json);
+  INFO("Task profiles saved to " + fileName);
+}
+
+ProfiledTask::ProfiledTask(JPetTask* task):
+  JPetTask(task->getName(), ""),
+  fTask(task)
+{
+  fProfile.name = task->getName();
+}
+
+ProfiledTask::~ProfiledTask() {}
+
+void ProfiledTask::init(const JPetTaskInterface::Options& opts)
+{
+  if (opts.count(kJsonFileParamKey)) {
+    TaskProfiler::getProfiler().setJsonFileName(opts.at(kJsonFileParamKey));
+  }
+  fStartUsage = ResourceUsage::now();
+  auto start = Clock::now();
+  /// the statistics and auxiliary data are set by the loader only in this task
+  fTask->setStatistics(&getStatistics());
+  fTask->setAuxilliaryData(&getAuxilliaryData());
+  fTask->init(opts);
+  fProfile.initWallTime = secondsSince(start);
+}
+
+void ProfiledTask::exec()
+{
+  auto start = Clock::now();
+  fTask->setEvent(getEvent());
+  fTask->exec();
+  fProfile.execWallTime += secondsSince(start);
+  fProfile.objectsIn++;
+}
+
+void ProfiledTask::terminate()
+{
+  auto start = Clock::now();
+  fTask->terminate();
+  fProfile.terminateWallTime = secondsSince(start);
+  auto endUsage = ResourceUsage::now();
+  fProfile.cpuTime = (endUsage.cpuTime < 0. || fStartUsage.cpuTime < 0.) ? -1.
+                     : endUsage.cpuTime - fStartUsage.cpuTime;
+  fProfile.bytesRead = difference(endUsage.bytesRead, fStartUsage.bytesRead);
+  fProfile.bytesWritten = difference(endUsage.bytesWritten, fStartUsage.bytesWritten);
+  fProfile.peakRSS = endUsage.peakRSS;
+  if (auto counter = dynamic_cast<const OutputCounter*>(fTask.get())) {
+    fProfile.objectsOut = counter->getNumOfOutputObjects();
+  }
+  TaskProfiler::getProfiler().addProfile(fProfile);
+}
+
+void ProfiledTask::setWriter(JPetWriter* writer)
+{
+  fTask->setWriter(writer);
+}
+
+void ProfiledTask::setParamManager(JPetParamManager* paramManager)
+{
+  fTask->setParamManager(paramManager);
+  JPetTask::setParamManager(paramManager);
+}
+
+const TaskProfile& ProfiledTask::getProfile() const
+{
+  return fProfile;
+}
@@ -0,0 +1,150 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file ProfiledTask.h
+ *  @brief Timing and resource usage of the tasks, with the summary printed after the run.
+ */
+
+#ifndef PROFILEDTASK_H
+#define PROFILEDTASK_H
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <JPetTask/JPetTask.h>
+
+#ifdef __CINT__
+//when cint is used instead of compiler, override word is not recognized
+//nevertheless it's needed for checking if the structure of project is correct
+#	define override
+#endif
+
+/**
+ * @brief Where the time of one task went. Times are in seconds,
+ * the negative values mean that the quantity was not measured.
+ */
+struct TaskProfile {
+  std::string name;
+  double initWallTime = 0.;
+  double execWallTime = 0.;
+  double terminateWallTime = 0.;
+  double cpuTime = -1.;
+  long long objectsIn = 0;
+  long long objectsOut = -1;
+  long long bytesRead = -1;
+  long long bytesWritten = -1;
+  /// peak resident memory of the whole process at the end of the task, in kB,
+  /// it includes the other tasks run in parallel in the batch mode
+  long peakRSS = -1;
+
+  double getTotalWallTime() const;
+  /// objects per second of the exec() time, 0 if not known
+  double getInputRate() const;
+  double getOutputRate() const;
+};
+
+/**
+ * @brief Resource usage of the calling thread at a given moment.
+ *
+ * The CPU time and the bytes are the ones of the calling thread, so in the batch
+ * mode the tasks of the other input files, run in other threads, are not counted.
+ * The bytes are the ones passed to the read and write calls, taken from
+ * /proc/thread-self/io, so they are -1 on the systems without it.
+ * The peak memory can only be measured for the whole process.
+ */
+struct ResourceUsage {
+  double cpuTime = 0.;
+  long peakRSS = -1;
+  long long bytesRead = -1;
+  long long bytesWritten = -1;
+
+  static ResourceUsage now();
+  /// CPU time of the calling thread, in seconds
+  static double getThreadCPUTime();
+};
+
+/**
+ * @brief Collects the profiles of all the tasks run by the JPetManager.
+ *
+ * The summary is printed by finish(), called after manager.run().
+ * With the user option "TaskProfiler_JsonFile":"<file name>" the profiles
+ * are also saved in the JSON format, to compare the runs of different versions.
+ */
+class TaskProfiler
+{
+public:
+  static TaskProfiler& getProfiler();
+
+  void addProfile(const TaskProfile& profile);
+  std::vector<TaskProfile> getProfiles() const;
+  void setJsonFileName(const std::string& fileName);
+  void clear();
+
+  void printSummary(std::ostream& out) const;
+  void writeJson(std::ostream& out) const;
+  /// Prints the summary and saves the JSON file if it was requested.
+  void finish(std::ostream& out);
+
+private:
+  mutable std::mutex fMutex;
+  std::vector<TaskProfile> fProfiles;
+  std::string fJsonFileName;
+};
+
+/**
+ * @brief Interface of the tasks which count the objects they produce,
+ * so that the ProfiledTask wrapping them can report the output rate.
+ */
+class OutputCounter
+{
+public:
+  virtual ~OutputCounter() {}
+  /// Number of the output objects produced so far.
+  virtual long long getNumOfOutputObjects() const = 0;
+};
+
+/**
+ * @brief Task measuring the init(), exec() and terminate() of the task it wraps.
+ *
+ * It is registered in the JPetTaskLoader instead of the wrapped task, e.g.
+ *   new JPetTaskLoader("hld", "tslot.raw", new ProfiledTask(new TaskA(...)));
+ * The wall time of exec() is summed over the calls. The CPU time and the bytes
+ * read and written by the thread of the task are measured from the start of init()
+ * to the end of terminate(), so they also include the reading and writing
+ * of the objects by the loader.
+ * The output objects are counted only if the wrapped task implements OutputCounter,
+ * as the PipelineStage does, for the other tasks they are reported as not measured.
+ */
+class ProfiledTask: public JPetTask
+{
+public:
+  /// The profiled task takes the ownership of the wrapped one.
+  explicit ProfiledTask(JPetTask* task);
+  virtual ~ProfiledTask();
+  virtual void init(const JPetTaskInterface::Options& opts) override;
+  virtual void exec() override;
+  virtual void terminate() override;
+  virtual void setWriter(JPetWriter* writer) override;
+  virtual void setParamManager(JPetParamManager* paramManager) override;
+
+  const TaskProfile& getProfile() const;
+
+protected:
+  std::unique_ptr<JPetTask> fTask;
+  TaskProfile fProfile;
+  ResourceUsage fStartUsage;
+  const std::string kJsonFileParamKey = "TaskProfiler_JsonFile";
+};
+
+#endif /*  !PROFILEDTASK_H */
@@ -0,0 +1,145 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ProfiledTaskTest
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <thread>
+#include "ProfiledTask.h"
+
+/// Remembers the calls and the events given by the profiled task.
+class CountingTask: public JPetTask
+{
+public:
+  CountingTask(std::vector<TObject*>& events, int& terminated):
+    JPetTask("CountingTask", ""), fEvents(events), fTerminated(terminated) {}
+  virtual void exec() override
+  {
+    fEvents.push_back(getEvent());
+  }
+  virtual void terminate() override
+  {
+    fTerminated++;
+  }
+  std::vector<TObject*>& fEvents;
+  int& fTerminated;
+};
+
+/// Produces two output objects for every input one.
+class DoublingTask: public JPetTask, public OutputCounter
+{
+public:
+  DoublingTask(): JPetTask("DoublingTask", "") {}
+  virtual void exec() override
+  {
+    fNumOfOutputObjects += 2;
+  }
+  virtual long long getNumOfOutputObjects() const override
+  {
+    return fNumOfOutputObjects;
+  }
+  long long fNumOfOutputObjects = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(ProfiledTaskSuite)
+
+BOOST_AUTO_TEST_CASE(forwardsAndCounts)
+{
+  TaskProfiler::getProfiler().clear();
+  std::vector<TObject*> events;
+  int terminated = 0;
+  JPetStatistics stats;
+  JPetAuxilliaryData auxData;
+  ProfiledTask task(new CountingTask(events, terminated));
+  task.setStatistics(&stats);
+  task.setAuxilliaryData(&auxData);
+  task.init(JPetTaskInterface::Options());
+  TObject first, second, third;
+  for (auto event : {&first, &second, &third}) {
+    task.setEvent(event);
+    task.exec();
+  }
+  task.terminate();
+
+  BOOST_REQUIRE_EQUAL(events.size(), 3u);
+  BOOST_REQUIRE_EQUAL(events[0], &first);
+  BOOST_REQUIRE_EQUAL(events[2], &third);
+  BOOST_REQUIRE_EQUAL(terminated, 1);
+  const auto& profile = task.getProfile();
+  BOOST_REQUIRE_EQUAL(profile.objectsIn, 3);
+  BOOST_REQUIRE_EQUAL(profile.objectsOut, -1);
+  BOOST_REQUIRE(profile.execWallTime >= 0.);
+  BOOST_REQUIRE(profile.cpuTime >= 0.);
+  BOOST_REQUIRE_EQUAL(TaskProfiler::getProfiler().getProfiles().size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(countsOutputObjects)
+{
+  TaskProfiler::getProfiler().clear();
+  JPetStatistics stats;
+  JPetAuxilliaryData auxData;
+  ProfiledTask task(new DoublingTask());
+  task.setStatistics(&stats);
+  task.setAuxilliaryData(&auxData);
+  task.init(JPetTaskInterface::Options());
+  TObject event;
+  for (int i = 0; i < 3; i++) {
+    task.setEvent(&event);
+    task.exec();
+  }
+  task.terminate();
+  BOOST_REQUIRE_EQUAL(task.getProfile().objectsIn, 3);
+  BOOST_REQUIRE_EQUAL(task.getProfile().objectsOut, 6);
+}
+
+BOOST_AUTO_TEST_CASE(usageOfCallingThread)
+{
+  auto start = ResourceUsage::now();
+  /// CPU burnt by another thread, e.g. the task chain of another input file
+  std::thread other([]() {
+    auto otherStart = ResourceUsage::getThreadCPUTime();
+    volatile double sum = 0.;
+    while (ResourceUsage::getThreadCPUTime() - otherStart < 0.2) {
+      sum = sum + 1.;
+    }
+  });
+  other.join();
+  auto end = ResourceUsage::now();
+  BOOST_REQUIRE(end.cpuTime - start.cpuTime < 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(rates)
+{
+  TaskProfile profile;
+  profile.execWallTime = 2.;
+  profile.objectsIn = 100;
+  BOOST_REQUIRE_CLOSE(profile.getInputRate(), 50., 1.e-9);
+  BOOST_REQUIRE_EQUAL(profile.getOutputRate(), 0.);
+  profile.objectsOut = 10;
+  BOOST_REQUIRE_CLOSE(profile.getOutputRate(), 5., 1.e-9);
+  profile.initWallTime = 0.5;
+  profile.terminateWallTime = 0.25;
+  BOOST_REQUIRE_CLOSE(profile.getTotalWallTime(), 2.75, 1.e-9);
+}
+
+BOOST_AUTO_TEST_CASE(summaryAndJson)
+{
+  auto& profiler = TaskProfiler::getProfiler();
+  profiler.clear();
+  TaskProfile profile;
+  profile.name = "FusedPipeline/\"HitFinder\"";
+  profile.objectsIn = 42;
+  profiler.addProfile(profile);
+
+  std::ostringstream summary;
+  profiler.printSummary(summary);
+  BOOST_REQUIRE(summary.str().find("FusedPipeline/\"HitFinder\"") != std::string::npos);
+
+  std::ostringstream json;
+  profiler.writeJson(json);
+  BOOST_REQUIRE(json.str().find("\"name\": \"FusedPipeline/\\\"HitFinder\\\"\"") != std::string::npos);
+  BOOST_REQUIRE(json.str().find("\"objectsIn\": 42") != std::string::npos);
+  BOOST_REQUIRE(json.str().find("\"objectsOut\": -1") != std::string::npos);
+  profiler.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SharedCache.h
+ *  @brief Read-only objects loaded once and shared by the task chains of all input files.
+ */
+
+#ifndef SHAREDCACHE_H
+#define SHAREDCACHE_H
+
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Cache of the objects of one type, e.g. the calibration tables, with one instance per process.
+ *
+ * In the batch mode the input files are processed by concurrent task chains,
+ * each of which would parse the same calibration files in init(). The first
+ * task asking for a key loads the object, the tasks asking for the same key
+ * in the meantime wait for it, and all of them get the same constant object.
+ * The key must identify everything the object is built from, e.g. the file
+ * name and the run number.
+ */
+template <class Value>
+class SharedCache
+{
+public:
+  typedef std::shared_ptr<const Value> Pointer;
+
+  static SharedCache& getCache()
+  {
+    static SharedCache cache;
+    return cache;
+  }
+
+  /// Returns the object of the key, calling load() to create it if it is not in the cache.
+  /// An exception thrown by load() is passed to all tasks waiting for the key.
+  template <class Load>
+  Pointer get(const std::string& key, const Load& load)
+  {
+    std::promise<Pointer> promise;
+    std::shared_future<Pointer> loaded;
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      auto entry = fEntries.find(key);
+      if (entry != fEntries.end()) {
+        loaded = entry->second;
+      } else {
+        fEntries.emplace(key, promise.get_future().share());
+      }
+    }
+    /// waiting outside of the lock, so the other keys can be loaded at the same time
+    if (loaded.valid()) {
+      return loaded.get();
+    }
+    try {
+      Pointer value = std::make_shared<const Value>(load());
+      promise.set_value(value);
+      return value;
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+      std::lock_guard<std::mutex> lock(fMutex);
+      fEntries.erase(key);
+      throw;
+    }
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fEntries.size();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fEntries.clear();
+  }
+
+private:
+  mutable std::mutex fMutex;
+  std::map<std::string, std::shared_future<Pointer>> fEntries;
+};
+
+#endif /*  !SHAREDCACHE_H */
@@ -0,0 +1,76 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SharedCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "SharedCache.h"
+
+BOOST_AUTO_TEST_SUITE(SharedCacheSuite)
+
+BOOST_AUTO_TEST_CASE(loadsOncePerKey)
+{
+  SharedCache<std::vector<int>> cache;
+  int numOfLoads = 0;
+  auto load = [&numOfLoads]() {
+    numOfLoads++;
+    return std::vector<int> {1, 2, 3};
+  };
+  auto first = cache.get("a", load);
+  auto second = cache.get("a", load);
+  BOOST_REQUIRE_EQUAL(numOfLoads, 1);
+  BOOST_REQUIRE_EQUAL(first.get(), second.get());
+  BOOST_REQUIRE_EQUAL(first->size(), 3u);
+
+  auto other = cache.get("b", load);
+  BOOST_REQUIRE_EQUAL(numOfLoads, 2);
+  BOOST_REQUIRE(other.get() != first.get());
+  BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+
+  /// the objects taken from the cache stay valid after clearing it
+  cache.clear();
+  BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+  BOOST_REQUIRE_EQUAL(first->at(2), 3);
+  cache.get("a", load);
+  BOOST_REQUIRE_EQUAL(numOfLoads, 3);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentRequestsWaitForOneLoad)
+{
+  SharedCache<int> cache;
+  std::atomic<int> numOfLoads(0);
+  std::vector<SharedCache<int>::Pointer> results(8);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < results.size(); i++) {
+    threads.emplace_back([&cache, &numOfLoads, &results, i]() {
+      results[i] = cache.get("setup", [&numOfLoads]() {
+        numOfLoads++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return 42;
+      });
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_REQUIRE_EQUAL(numOfLoads.load(), 1);
+  for (const auto& result : results) {
+    BOOST_REQUIRE_EQUAL(result.get(), results.front().get());
+    BOOST_REQUIRE_EQUAL(*result, 42);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(failedLoadIsRetried)
+{
+  SharedCache<int> cache;
+  BOOST_REQUIRE_THROW(cache.get("a", []() -> int { throw std::runtime_error("missing file"); }), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+  BOOST_REQUIRE_EQUAL(*cache.get("a", []() {
+    return 7;
+  }), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SigChBuffer.cpp
+ */
+
+#include <algorithm>
+#include "SigChBuffer.h"
+
+SigChBuffer::SigChBuffer() {}
+
+SigChBuffer::~SigChBuffer() {}
+
+void SigChBuffer::add(unsigned int daqChannel, JPetSigCh::EdgeType type, int thresholdNumber, float value)
+{
+  fDAQChannels.push_back(daqChannel);
+  fTypes.push_back(type);
+  fThresholdNumbers.push_back(thresholdNumber);
+  fValues.push_back(value);
+}
+
+void SigChBuffer::reserve(std::size_t size)
+{
+  fDAQChannels.reserve(size);
+  fTypes.reserve(size);
+  fThresholdNumbers.reserve(size);
+  fValues.reserve(size);
+}
+
+std::size_t SigChBuffer::size() const
+{
+  return fValues.size();
+}
+
+void SigChBuffer::Clear(Option_t*)
+{
+  fDAQChannels.clear();
+  fTypes.clear();
+  fThresholdNumbers.clear();
+  fValues.clear();
+  fIndex = 0;
+}
+
+unsigned int SigChBuffer::getDAQChannel(std::size_t i) const
+{
+  return fDAQChannels[i];
+}
+
+JPetSigCh::EdgeType SigChBuffer::getType(std::size_t i) const
+{
+  return static_cast<JPetSigCh::EdgeType>(fTypes[i]);
+}
+
+int SigChBuffer::getThresholdNumber(std::size_t i) const
+{
+  return fThresholdNumbers[i];
+}
+
+float SigChBuffer::getValue(std::size_t i) const
+{
+  return fValues[i];
+}
+
+void SigChBuffer::setValue(std::size_t i, float value)
+{
+  fValues[i] = value;
+}
+
+const std::vector<unsigned int>& SigChBuffer::getDAQChannels() const
+{
+  return fDAQChannels;
+}
+
+const std::vector<char>& SigChBuffer::getTypes() const
+{
+  return fTypes;
+}
+
+std::vector<float>& SigChBuffer::getValues()
+{
+  return fValues;
+}
+
+void SigChBuffer::setIndex(unsigned int index)
+{
+  fIndex = index;
+}
+
+unsigned int SigChBuffer::getIndex() const
+{
+  return fIndex;
+}
+
+JPetSigCh SigChBuffer::createSigCh(std::size_t i, const JPetParamBank& paramBank) const
+{
+  JPetSigCh sigCh = createSigCh(paramBank.getTOMBChannel(fDAQChannels[i]), getType(i));
+  sigCh.setThresholdNumber(fThresholdNumbers[i]);
+  sigCh.setValue(fValues[i]);
+  return sigCh;
+}
+
+JPetTimeWindow SigChBuffer::toTimeWindow(const JPetParamBank& paramBank) const
+{
+  JPetTimeWindow window;
+  window.setIndex(fIndex);
+  for (std::size_t i = 0; i < size(); i++) {
+    window.addCh(createSigCh(i, paramBank));
+  }
+  return window;
+}
+
+JPetSigCh SigChBuffer::createSigCh(const JPetTOMBChannel& channel, JPetSigCh::EdgeType edge)
+{
+  JPetSigCh sigch;
+  sigch.setDAQch(channel.getChannel());
+  sigch.setType(edge);
+  sigch.setThresholdNumber(channel.getLocalChannelNumber());
+  sigch.setThreshold(channel.getThreshold());
+  sigch.setPM(channel.getPM());
+  sigch.setFEB(channel.getFEB());
+  sigch.setTRB(channel.getTRB());
+  sigch.setTOMBChannel(channel);
+  return sigch;
+}
+
+void SigChChannelTable::build(const JPetParamBank& paramBank)
+{
+  std::size_t size = 0;
+  for (const auto& tombChannel : paramBank.getTOMBChannels()) {
+    size = std::max(size, static_cast<std::size_t>(tombChannel.first) + 1);
+  }
+  fPMIDs.assign(size, -1);
+  fLeadingTemplates.assign(size, JPetSigCh());
+  fTrailingTemplates.assign(size, JPetSigCh());
+  for (const auto& tombChannel : paramBank.getTOMBChannels()) {
+    const JPetTOMBChannel& channel = *tombChannel.second;
+    fPMIDs[tombChannel.first] = channel.getPM().getID();
+    fLeadingTemplates[tombChannel.first] = SigChBuffer::createSigCh(channel, JPetSigCh::Leading);
+    fTrailingTemplates[tombChannel.first] = SigChBuffer::createSigCh(channel, JPetSigCh::Trailing);
+  }
+}
+
+bool SigChChannelTable::contains(unsigned int daqChannel) const
+{
+  return getPMID(daqChannel) != -1;
+}
+
+int SigChChannelTable::getPMID(unsigned int daqChannel) const
+{
+  return daqChannel < fPMIDs.size() ? fPMIDs[daqChannel] : -1;
+}
+
+const JPetPM& SigChChannelTable::getPM(unsigned int daqChannel) const
+{
+  return fLeadingTemplates[daqChannel].getPM();
+}
+
+JPetSigCh SigChChannelTable::createSigCh(const SigChBuffer& buffer, std::size_t i) const
+{
+  const unsigned int daqChannel = buffer.getDAQChannel(i);
+  JPetSigCh sigCh = buffer.getType(i) == JPetSigCh::Leading ?
+                    fLeadingTemplates[daqChannel] : fTrailingTemplates[daqChannel];
+  sigCh.setThresholdNumber(buffer.getThresholdNumber(i));
+  sigCh.setValue(buffer.getValue(i));
+  return sigCh;
+}
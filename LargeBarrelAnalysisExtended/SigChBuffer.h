@@ -0,0 +1,113 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SigChBuffer.h
+ *  @brief Compact in-memory representation of the Signal Channels of one time window.
+ */
+
+#ifndef SIGCHBUFFER_H
+#define SIGCHBUFFER_H
+
+#include <vector>
+#include <TObject.h>
+#include <JPetSigCh/JPetSigCh.h>
+#include <JPetTimeWindow/JPetTimeWindow.h>
+#include <JPetParamBank/JPetParamBank.h>
+#include <JPetTOMBChannel/JPetTOMBChannel.h>
+
+#ifdef __CINT__
+//when cint is used instead of compiler, override word is not recognized
+//nevertheless it's needed for checking if the structure of project is correct
+#	define override
+#endif
+
+/**
+ * @brief Signal Channels of one time window stored as parallel arrays.
+ *
+ * Only the DAQ (TOMB) channel number, edge type, threshold number and time
+ * are kept for every Signal Channel. The PM, FEB, TRB and TOMB channel
+ * objects, which JPetSigCh carries for every edge, are resolved by the
+ * channel number only when a full JPetSigCh is needed, see SigChChannelTable.
+ * The buffer is meant to be passed between the stages of a FusedPipeline,
+ * it has no ROOT dictionary and is never written to a file: a stage which
+ * saves its output converts it first with toTimeWindow().
+ */
+class SigChBuffer: public TObject
+{
+public:
+  SigChBuffer();
+  virtual ~SigChBuffer();
+
+  void add(unsigned int daqChannel, JPetSigCh::EdgeType type, int thresholdNumber, float value);
+  void reserve(std::size_t size);
+  std::size_t size() const;
+  virtual void Clear(Option_t* opt = "") override;
+
+  unsigned int getDAQChannel(std::size_t i) const;
+  JPetSigCh::EdgeType getType(std::size_t i) const;
+  int getThresholdNumber(std::size_t i) const;
+  float getValue(std::size_t i) const;
+  void setValue(std::size_t i, float value);
+
+  /// Direct access to the arrays, for the passes over the whole buffer.
+  const std::vector<unsigned int>& getDAQChannels() const;
+  const std::vector<char>& getTypes() const;
+  std::vector<float>& getValues();
+
+  void setIndex(unsigned int index);
+  unsigned int getIndex() const;
+
+  /// Creates the full Signal Channel, the channel must exist in the param bank.
+  JPetSigCh createSigCh(std::size_t i, const JPetParamBank& paramBank) const;
+  /// Creates the time window with the full Signal Channels, in the same order.
+  JPetTimeWindow toTimeWindow(const JPetParamBank& paramBank) const;
+
+  /// Creates the Signal Channel of a given edge with all the parametric
+  /// objects taken from the TOMB channel, the time value is not set.
+  static JPetSigCh createSigCh(const JPetTOMBChannel& channel, JPetSigCh::EdgeType edge);
+
+protected:
+  std::vector<unsigned int> fDAQChannels;
+  std::vector<char> fTypes;
+  std::vector<char> fThresholdNumbers;
+  std::vector<float> fValues;
+  unsigned int fIndex = 0;
+};
+
+/**
+ * @brief Parametric objects of the TOMB channels of the setup, indexed by the DAQ channel number.
+ *
+ * Built once from the JPetParamBank, it gives the PM of a SigChBuffer entry
+ * without a map lookup, and the templates of the leading and trailing
+ * Signal Channels with the PM, FEB, TRB and TOMB channel already set,
+ * from which the full JPetSigCh of an entry is created.
+ */
+class SigChChannelTable
+{
+public:
+  void build(const JPetParamBank& paramBank);
+  /// False for the channels which are not in the setup.
+  bool contains(unsigned int daqChannel) const;
+  /// -1 for the channels which are not in the setup.
+  int getPMID(unsigned int daqChannel) const;
+  /// The channel must be in the setup.
+  const JPetPM& getPM(unsigned int daqChannel) const;
+  /// Full Signal Channel of the i-th entry of the buffer, its channel must be in the setup.
+  JPetSigCh createSigCh(const SigChBuffer& buffer, std::size_t i) const;
+
+private:
+  std::vector<int> fPMIDs;
+  std::vector<JPetSigCh> fLeadingTemplates;
+  std::vector<JPetSigCh> fTrailingTemplates;
+};
+
+#endif /*  !SIGCHBUFFER_H */
@@ -0,0 +1,52 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SigChBufferTest
+#include <boost/test/unit_test.hpp>
+
+#include "SigChBuffer.h"
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( emptyBuffer )
+{
+  SigChBuffer buffer;
+  BOOST_REQUIRE_EQUAL(buffer.size(), 0);
+  BOOST_REQUIRE_EQUAL(buffer.getIndex(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( addAndGet )
+{
+  SigChBuffer buffer;
+  buffer.setIndex(12);
+  buffer.add(101, JPetSigCh::Leading, 1, -1000.5);
+  buffer.add(101, JPetSigCh::Trailing, 1, -500.);
+  buffer.add(230, JPetSigCh::Leading, 4, -2000.);
+  BOOST_REQUIRE_EQUAL(buffer.size(), 3);
+  BOOST_REQUIRE_EQUAL(buffer.getIndex(), 12);
+  BOOST_REQUIRE_EQUAL(buffer.getDAQChannel(0), 101);
+  BOOST_REQUIRE_EQUAL(buffer.getType(0), JPetSigCh::Leading);
+  BOOST_REQUIRE_EQUAL(buffer.getType(1), JPetSigCh::Trailing);
+  BOOST_REQUIRE_EQUAL(buffer.getDAQChannel(2), 230);
+  BOOST_REQUIRE_EQUAL(buffer.getThresholdNumber(2), 4);
+  auto epsilon = 0.0001;
+  BOOST_REQUIRE_CLOSE(buffer.getValue(0), -1000.5, epsilon);
+  BOOST_REQUIRE_CLOSE(buffer.getValue(2), -2000., epsilon);
+
+  buffer.setValue(1, -400.);
+  BOOST_REQUIRE_CLOSE(buffer.getValue(1), -400., epsilon);
+}
+
+BOOST_AUTO_TEST_CASE( copyAndClear )
+{
+  SigChBuffer buffer;
+  buffer.setIndex(3);
+  buffer.add(101, JPetSigCh::Leading, 2, -10.);
+  SigChBuffer copy(buffer);
+  buffer.Clear();
+  BOOST_REQUIRE_EQUAL(buffer.size(), 0);
+  BOOST_REQUIRE_EQUAL(buffer.getIndex(), 0);
+  BOOST_REQUIRE_EQUAL(copy.size(), 1);
+  BOOST_REQUIRE_EQUAL(copy.getIndex(), 3);
+  BOOST_REQUIRE_EQUAL(copy.getThresholdNumber(0), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
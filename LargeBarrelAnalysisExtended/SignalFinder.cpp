@@ -15,15 +15,19 @@
 
 using namespace std;
 
+#include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <string>
 #include <vector>
-#include <JPetWriter/JPetWriter.h>
+#include <TDirectory.h>
+#include <TROOT.h> /// ROOT::EnableThreadSafety()
 #include "SignalFinderTools.h"
 #include "SignalFinder.h"
+#include "SigChBuffer.h"
 
 SignalFinder::SignalFinder(const char* name, const char* description, bool saveControlHistos)
-	: JPetTask(name, description)
+	: PipelineStage(name, description)
 {
 	fSaveControlHistos = saveControlHistos;
 }
@@ -43,15 +47,74 @@ void SignalFinder::init(const JPetTaskInterface::Options& opts)
 		kSigChLeadTrailMaxTime = std::atof(opts.at(fLeadTrailMaxTimeParamKey).c_str());
 	}
 
+	if (opts.count(fNumOfThreadsParamKey)) {
+		fNumOfThreads = std::max(1, std::atoi(opts.at(fNumOfThreadsParamKey).c_str()));
+	}
+
+	int numOfThresholds = getNumOfThresholdsFromSetup();
+	if (SignalFinderTools::isSupportedNumOfThresholds(numOfThresholds)) {
+		fNumOfThresholds = numOfThresholds;
+	} else {
+		WARNING("Number of thresholds in the setup (" + std::to_string(numOfThresholds)
+			+ ") is not supported, using " + std::to_string(fNumOfThresholds));
+	}
+	INFO("Signal finding with " + std::to_string(fNumOfThresholds) + " thresholds.");
+
+	fChannels.build(getParamBank());
+	createControlHistos(getStatistics());
+
+	if (fNumOfThreads > 1) {
+		INFO("Signal finding in " + std::to_string(fNumOfThreads) + " threads.");
+		ROOT::EnableThreadSafety();
+		for (unsigned int i = 0; i < fNumOfThreads; i++) {
+			fWorkerStatistics.push_back(std::unique_ptr<JPetStatistics>(new JPetStatistics()));
+			createControlHistos(*fWorkerStatistics.back());
+		}
+		fWorkerPMBuckets.resize(fNumOfThreads);
+		fPool.reset(new WorkStealingPool(fNumOfThreads));
+	}
+}
+
+//the threshold number of a Signal Channel is the local number of its TOMB channel
+int SignalFinder::getNumOfThresholdsFromSetup()
+{
+	int numOfThresholds = 0;
+	for (const auto & tombChannel : getParamBank().getTOMBChannels()) {
+		numOfThresholds = std::max(numOfThresholds, (int) tombChannel.second->getLocalChannelNumber());
+	}
+	return numOfThresholds;
+}
+
+void SignalFinder::createControlHistos(JPetStatistics& stats)
+{
 	if (fSaveControlHistos) {
-		getStatistics().createHistogram(
-			new TH1F("remainig_leading_sig_ch_per_thr",
-				"Remainig Leading Signal Channels",
-				4, 0.5, 4.5));
-		getStatistics().createHistogram(
-			new TH1F("remainig_trailing_sig_ch_per_thr",
-				"Remainig Trailing Signal Channels",
-				4, 0.5, 4.5));
+		TH1F* leading = nullptr;
+		TH1F* trailing = nullptr;
+		{
+			//worker copies are created with no current directory, the TH1 constructor would append
+			//them to it and so replace the task histograms of the same name
+			TDirectory::TContext context(&stats == &getStatistics() ? gDirectory : nullptr);
+			leading = new TH1F("remainig_leading_sig_ch_per_thr",
+					"Remainig Leading Signal Channels",
+					fNumOfThresholds, 0.5, fNumOfThresholds + 0.5);
+			trailing = new TH1F("remainig_trailing_sig_ch_per_thr",
+					"Remainig Trailing Signal Channels",
+					fNumOfThresholds, 0.5, fNumOfThresholds + 0.5);
+		}
+		stats.createHistogram(leading);
+		stats.createHistogram(trailing);
+	}
+}
+
+void SignalFinder::mergeControlHistos()
+{
+	if (!fSaveControlHistos) {
+		return;
+	}
+	for (auto & stats : fWorkerStatistics) {
+		for (auto name : {"remainig_leading_sig_ch_per_thr", "remainig_trailing_sig_ch_per_thr"}) {
+			getStatistics().getHisto1D(name).Add(&stats->getHisto1D(name));
+		}
 	}
 }
 
@@ -61,29 +124,104 @@ void SignalFinder::exec()
 
 	//getting the data from event in apropriate format
 	if(auto timeWindow = dynamic_cast<const JPetTimeWindow* const>(getEvent())) {
+		processWindow(*timeWindow);
+	} else if (auto buffer = dynamic_cast<const SigChBuffer* const>(getEvent())) {
+		processWindow(*buffer);
+	}
+}
+
+template <class Window>
+void SignalFinder::processWindow(const Window& window)
+{
+	if (fPool) {
+		submitWindow(window);
+		saveFinishedWindows(kWindowsInFlightPerThread * fNumOfThreads);
+	} else {
+		saveRawSignals(findSignals(window, getStatistics(), fPMBuckets));
+	}
+}
 
-		//mapping method invocation
-		map<int, vector<JPetSigCh>> sigChsPMMap = SignalFinderTools::getSigChsPMMapById(timeWindow);
+vector<JPetRawSignal> SignalFinder::findSignals(const JPetTimeWindow& timeWindow, JPetStatistics& stats,
+		SigChPMBuckets& pmBuckets)
+{
+	//grouping the Signal Channels by PM
+	pmBuckets.fill(timeWindow);
+
+	//building signals method invocation
+	return SignalFinderTools::buildAllSignals(
+		timeWindow.getIndex(),
+		pmBuckets,
+		fNumOfThresholds,
+		stats,
+		fSaveControlHistos,
+		kSigChEdgeMaxTime,
+		kSigChLeadTrailMaxTime);
+}
 
-		//building signals method invocation
-		vector<JPetRawSignal> allSignals = SignalFinderTools::buildAllSignals(
-							timeWindow->getIndex(),
-    							sigChsPMMap,
-    							kNumOfThresholds ,
-    							getStatistics(),
-    							fSaveControlHistos,
-    							kSigChEdgeMaxTime,
-    							kSigChLeadTrailMaxTime);
+vector<JPetRawSignal> SignalFinder::findSignals(const SigChBuffer& buffer, JPetStatistics& stats,
+		SigChPMBuckets& pmBuckets)
+{
+	//grouping the buffer entries by PM, no Signal Channel is created yet
+	pmBuckets.fill(buffer, fChannels);
+
+	return SignalFinderTools::buildAllSignals(
+		buffer.getIndex(),
+		buffer,
+		pmBuckets,
+		fChannels,
+		fNumOfThresholds,
+		stats,
+		fSaveControlHistos,
+		kSigChEdgeMaxTime,
+		kSigChLeadTrailMaxTime);
+}
 
-		//saving method invocation
-		saveRawSignals(allSignals);
+template <class Window>
+void SignalFinder::submitWindow(const Window& timeWindow)
+{
+	//the window given by the reader is reused, the worker needs its own copy
+	auto window = std::make_shared<Window>(timeWindow);
+	auto windowNumber = fSubmittedWindows++;
+	fPool->submit([this, window, windowNumber](unsigned int workerIndex) {
+		auto signals = findSignals(*window, *fWorkerStatistics[workerIndex], fWorkerPMBuckets[workerIndex]);
+		{
+			std::lock_guard<std::mutex> lock(fFinishedWindowsMutex);
+			fFinishedWindows[windowNumber] = std::move(signals);
+		}
+		fWindowFinished.notify_all();
+	});
+}
 
+void SignalFinder::saveFinishedWindows(unsigned long maxWindowsInFlight)
+{
+	std::unique_lock<std::mutex> lock(fFinishedWindowsMutex);
+	while (true) {
+		auto next = fFinishedWindows.find(fSavedWindows);
+		if (next != fFinishedWindows.end()) {
+			auto signals = std::move(next->second);
+			fFinishedWindows.erase(next);
+			fSavedWindows++;
+			//the downstream stages are run without holding the lock
+			lock.unlock();
+			saveRawSignals(signals);
+			lock.lock();
+		} else if (fSubmittedWindows - fSavedWindows > maxWindowsInFlight) {
+			fWindowFinished.wait(lock);
+		} else {
+			return;
+		}
 	}
 }
 
 //SignalFinder finish method
 void SignalFinder::terminate()
 {
+	if (fPool) {
+		saveFinishedWindows(0);
+		INFO("Time windows stolen by idle threads: " + std::to_string(fPool->getNumOfSteals()));
+		fPool.reset();
+		mergeControlHistos();
+	}
 	INFO("Signal finding ended.");
 }
 
@@ -91,13 +229,7 @@ void SignalFinder::terminate()
 //saving method
 void SignalFinder::saveRawSignals(const vector<JPetRawSignal>& sigChVec)
 {
-	assert(fWriter);
 	for (const auto & sigCh : sigChVec) {
-		fWriter->write(sigCh);
+		forward(sigCh);
 	}
 }
-
-void SignalFinder::setWriter(JPetWriter* writer)
-{
-	fWriter = writer;
-}
@@ -16,18 +16,34 @@
 #ifndef SIGNALFINDER_H
 #define SIGNALFINDER_H
 
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <JPetTask/JPetTask.h>
 #include <JPetRawSignal/JPetRawSignal.h>
 #include <JPetTimeWindow/JPetTimeWindow.h>
-
-class JPetWriter;
+#include "PipelineStage.h"
+#include "SignalFinderTools.h"
+#include "WorkStealingPool.h"
 
 #ifdef __CINT__
 #define override
 #endif
 
-class SignalFinder: public JPetTask
+/**
+ * @brief Module building JPetRawSignal objects from the JPetSigCh of each time window.
+ *
+ * The input can be also the compact SigChBuffer. Its entries are grouped by PM
+ * through a table indexed by the DAQ channel, built in init(), and the full
+ * Signal Channels are created only for the entries added to the signals.
+ * The number of thresholds (2, 4 or 8) is taken from the TOMB channels of the setup.
+ * With the user option "SignalFinder_NumOfThreads" greater than 1 the time windows
+ * are processed in parallel by a WorkStealingPool. The signals are still saved
+ * in the order of the incoming time windows. Each worker fills its own copy of
+ * the control histograms, which are added to the task statistics in terminate().
+ */
+class SignalFinder: public PipelineStage
 {
 public:
   SignalFinder(const char* name, const char* description, bool printStats);
@@ -35,17 +51,45 @@ public:
   virtual void init(const JPetTaskInterface::Options& opts) override;
   virtual void exec() override;
   virtual void terminate() override;
-  virtual void setWriter(JPetWriter* writer) override;
   bool fSaveControlHistos = true;
 
 protected:
-  JPetWriter* fWriter;
   void saveRawSignals(const std::vector<JPetRawSignal>& sigChVec);
+  template <class Window>
+  void processWindow(const Window& window);
+  std::vector<JPetRawSignal> findSignals(const JPetTimeWindow& timeWindow, JPetStatistics& stats,
+                                         SigChPMBuckets& pmBuckets);
+  std::vector<JPetRawSignal> findSignals(const SigChBuffer& buffer, JPetStatistics& stats,
+                                         SigChPMBuckets& pmBuckets);
+  void createControlHistos(JPetStatistics& stats);
+  /// Highest local channel number among the TOMB channels of the setup.
+  int getNumOfThresholdsFromSetup();
+  void mergeControlHistos();
+  template <class Window>
+  void submitWindow(const Window& window);
+  /// Saves the signals of the finished windows in the order of submission.
+  /// Waits until at most maxWindowsInFlight windows are submitted but not saved.
+  void saveFinishedWindows(unsigned long maxWindowsInFlight);
   const std::string fEdgeMaxTimeParamKey = "SignalFinder_EdgeMaxTime"; 
   const std::string fLeadTrailMaxTimeParamKey = "SignalFinder_LeadTrailMaxTime";
+  const std::string fNumOfThreadsParamKey = "SignalFinder_NumOfThreads";
+  const unsigned int kWindowsInFlightPerThread = 4;
+  unsigned int fNumOfThreads = 1;
+  std::unique_ptr<WorkStealingPool> fPool;
+  std::vector<std::unique_ptr<JPetStatistics>> fWorkerStatistics;
+  /// buffers for grouping the Signal Channels by PM, reused for all the windows
+  SigChPMBuckets fPMBuckets;
+  /// PMs and Signal Channel templates of the DAQ channels, for the SigChBuffer input
+  SigChChannelTable fChannels;
+  std::vector<SigChPMBuckets> fWorkerPMBuckets;
+  std::map<unsigned long, std::vector<JPetRawSignal>> fFinishedWindows;
+  std::mutex fFinishedWindowsMutex;
+  std::condition_variable fWindowFinished;
+  unsigned long fSubmittedWindows = 0;
+  unsigned long fSavedWindows = 0;
   Float_t kSigChEdgeMaxTime = 20000; //[ps]
   Float_t kSigChLeadTrailMaxTime = 300000; //[ps]
-  const int kNumOfThresholds = 4;
+  int fNumOfThresholds = 4;
 };
 #endif
 /*  !SIGNALFINDER_H */
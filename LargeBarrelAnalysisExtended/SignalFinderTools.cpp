@@ -13,9 +13,23 @@
  *  @file SignalFinderToolsTools.cpp
  */
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include "SignalFinderTools.h"
 using namespace std;
 
+namespace
+{
+bool isEarlier(const JPetSigCh& sigCh1, const JPetSigCh& sigCh2)
+{
+	return sigCh1.getValue() < sigCh2.getValue();
+}
+}
+
+//Signal Channels of every PM are sorted by time, the order of the
+//Signal Channels with equal times is kept
 map<int, vector<JPetSigCh>> SignalFinderTools::getSigChsPMMapById(const JPetTimeWindow* timeWindow)
 {
 	map<int, vector<JPetSigCh>> sigChsPMMap;
@@ -27,24 +41,133 @@ map<int, vector<JPetSigCh>> SignalFinderTools::getSigChsPMMapById(const JPetTime
 	//map Signal Channels in this Time window according to PM they belong to
 	const unsigned int nSigChs = timeWindow->getNumberOfSigCh();
 	for(unsigned int i = 0; i < nSigChs; i++) {
-		JPetSigCh sigCh = timeWindow->operator[](i);
-		int pmt_id = sigCh.getPM().getID();
-		auto search = sigChsPMMap.find(pmt_id);
-		if (search == sigChsPMMap.end()) {
-			vector<JPetSigCh> tmp;
-			tmp.push_back(sigCh);
-			sigChsPMMap.insert(pair<int, vector<JPetSigCh>>(pmt_id, tmp));
-		} else {
-			search->second.push_back(sigCh);
-		}
+		const JPetSigCh& sigCh = timeWindow->operator[](i);
+		sigChsPMMap[sigCh.getPM().getID()].push_back(sigCh);
+	}
+	for (auto & sigChPair : sigChsPMMap) {
+		stable_sort(sigChPair.second.begin(), sigChPair.second.end(), isEarlier);
 	}
 
 	return sigChsPMMap;
 }
 
+void SigChPMBuckets::sortByPM()
+{
+	fPMIDs.clear();
+	fOffsets.assign(1, 0);
+	fMinPMID = numeric_limits<int>::max();
+	int maxPMID = numeric_limits<int>::min();
+	for (int pmID : fSigChPMIDs) {
+		if (pmID != -1) {
+			fMinPMID = min(fMinPMID, pmID);
+			maxPMID = max(maxPMID, pmID);
+		}
+	}
+	if (maxPMID < fMinPMID) {
+		fIndices.clear();
+		fMinPMID = 0;
+		return;
+	}
+
+	//counting sort, fOffsets[k] is the beginning of the bucket of PM fMinPMID + k
+	const unsigned int nIDs = maxPMID - fMinPMID + 1;
+	fOffsets.assign(nIDs + 1, 0);
+	for (int pmID : fSigChPMIDs) {
+		if (pmID != -1) {
+			fOffsets[pmID - fMinPMID + 1]++;
+		}
+	}
+	for (unsigned int k = 0; k < nIDs; k++) {
+		fOffsets[k + 1] += fOffsets[k];
+		if (fOffsets[k + 1] > fOffsets[k]) {
+			fPMIDs.push_back(fMinPMID + k);
+		}
+	}
+	fIndices.resize(fOffsets[nIDs]);
+	fCursors.assign(fOffsets.begin(), fOffsets.end() - 1);
+	for (unsigned int i = 0; i < fSigChPMIDs.size(); i++) {
+		if (fSigChPMIDs[i] != -1) {
+			fIndices[fCursors[fSigChPMIDs[i] - fMinPMID]++] = i;
+		}
+	}
+}
+
+//the counting sort is stable, so is the sorting by time of every bucket
+template <class IsEarlier>
+void SigChPMBuckets::sortBucketsByTime(const IsEarlier& isEarlierIndex)
+{
+	for (unsigned int bucket = 0; bucket < fPMIDs.size(); bucket++) {
+		auto begin = fIndices.begin() + fOffsets[fPMIDs[bucket] - fMinPMID];
+		auto end = fIndices.begin() + fOffsets[fPMIDs[bucket] - fMinPMID + 1];
+		stable_sort(begin, end, isEarlierIndex);
+	}
+}
+
+void SigChPMBuckets::fill(const JPetTimeWindow& timeWindow)
+{
+	const unsigned int nSigChs = timeWindow.getNumberOfSigCh();
+	fSigChPMIDs.resize(nSigChs);
+	for (unsigned int i = 0; i < nSigChs; i++) {
+		fSigChPMIDs[i] = timeWindow[i].getPM().getID();
+	}
+	sortByPM();
+	sortBucketsByTime([&timeWindow](unsigned int i, unsigned int j) {
+		return isEarlier(timeWindow[i], timeWindow[j]);
+	});
+	fSigChs.resize(fIndices.size());
+	for (unsigned int k = 0; k < fIndices.size(); k++) {
+		fSigChs[k] = &timeWindow[fIndices[k]];
+	}
+}
+
+void SigChPMBuckets::fill(const SigChBuffer& buffer, const SigChChannelTable& channels)
+{
+	const unsigned int nSigChs = buffer.size();
+	fSigChPMIDs.resize(nSigChs);
+	const auto& daqChannels = buffer.getDAQChannels();
+	for (unsigned int i = 0; i < nSigChs; i++) {
+		fSigChPMIDs[i] = channels.getPMID(daqChannels[i]);
+	}
+	sortByPM();
+	sortBucketsByTime([&buffer](unsigned int i, unsigned int j) {
+		return buffer.getValue(i) < buffer.getValue(j);
+	});
+	fSigChs.clear();
+}
+
+unsigned int SigChPMBuckets::getNumOfPMs() const
+{
+	return fPMIDs.size();
+}
+
+int SigChPMBuckets::getPMID(unsigned int bucket) const
+{
+	return fPMIDs[bucket];
+}
+
+SigChPMBuckets::Iterator SigChPMBuckets::begin(unsigned int bucket) const
+{
+	return fSigChs.data() + fOffsets[fPMIDs[bucket] - fMinPMID];
+}
+
+SigChPMBuckets::Iterator SigChPMBuckets::end(unsigned int bucket) const
+{
+	return fSigChs.data() + fOffsets[fPMIDs[bucket] - fMinPMID + 1];
+}
+
+SigChPMBuckets::IndexIterator SigChPMBuckets::beginIndices(unsigned int bucket) const
+{
+	return fIndices.data() + fOffsets[fPMIDs[bucket] - fMinPMID];
+}
+
+SigChPMBuckets::IndexIterator SigChPMBuckets::endIndices(unsigned int bucket) const
+{
+	return fIndices.data() + fOffsets[fPMIDs[bucket] - fMinPMID + 1];
+}
+
 //method with loop of building raw signals for whole PM map
 vector<JPetRawSignal> SignalFinderTools::buildAllSignals(Int_t timeWindowIndex,
-					map<int, vector<JPetSigCh>> sigChsPMMap,
+					const map<int, vector<JPetSigCh>>& sigChsPMMap,
 					int numOfThresholds,
 					JPetStatistics& stats,
 					bool saveControlHistos,
@@ -62,13 +185,164 @@ vector<JPetRawSignal> SignalFinderTools::buildAllSignals(Int_t timeWindowIndex,
 	return allSignals;
 }
 
-//sorting method
-bool sortByTimeValue(JPetSigCh sig1, JPetSigCh sig2)
+//method with loop of building raw signals for all the PM buckets
+vector<JPetRawSignal> SignalFinderTools::buildAllSignals(Int_t timeWindowIndex,
+					const SigChPMBuckets& sigChsPMBuckets,
+					int numOfThresholds,
+					JPetStatistics& stats,
+					bool saveControlHistos,
+					double sigChEdgeMaxTime,
+					double sigChLeadTrailMaxTime)
 {
-	return (sig1.getValue() < sig2.getValue());
+	vector<JPetRawSignal> allSignals;
+	for (unsigned int bucket = 0; bucket < sigChsPMBuckets.getNumOfPMs(); bucket++) {
+		buildRawSignals(timeWindowIndex, sigChsPMBuckets.begin(bucket), sigChsPMBuckets.end(bucket),
+			numOfThresholds, stats, saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, allSignals);
+	}
+	return allSignals;
+}
+
+namespace
+{
+
+//Signal Channels of one threshold and one edge type, stored as their
+//positions in the edges of the PM and their times, in the input order. The matching conditions used by buildRawSignals
+//select a range of contiguous times around the reference time, so the channels
+//are additionally viewed sorted by time and a minimum segment tree over that view
+//gives the first not yet used channel (in the input order) inside the range
+//in O(log n), without erasing anything from the vectors.
+class ThresholdSigChs
+{
+public:
+	void add(int edge, float time)
+	{
+		fEdges.push_back(edge);
+		fTimes.push_back(time);
+	}
+
+	//keeps the allocated memory for the next PM
+	void clear()
+	{
+		fEdges.clear();
+		fTimes.clear();
+	}
+
+	void prepare()
+	{
+		const int n = fTimes.size();
+		fSorted.resize(n);
+		for (int i = 0; i < n; i++) {
+			fSorted[i] = i;
+		}
+		//input from getSigChsPMMapById and SigChPMBuckets is already sorted
+		auto isEarlierIndex = [this](int i, int j) {
+			return fTimes[i] < fTimes[j];
+		};
+		if (!std::is_sorted(fSorted.begin(), fSorted.end(), isEarlierIndex)) {
+			std::stable_sort(fSorted.begin(), fSorted.end(), isEarlierIndex);
+		}
+		fSortedPos.resize(n);
+		fLeafs = 1;
+		while (fLeafs < n) {
+			fLeafs <<= 1;
+		}
+		fTree.assign(2 * fLeafs, kUsed);
+		for (int p = 0; p < n; p++) {
+			fSortedPos[fSorted[p]] = p;
+			fTree[fLeafs + p] = fSorted[p];
+		}
+		for (int node = fLeafs - 1; node > 0; node--) {
+			fTree[node] = std::min(fTree[2 * node], fTree[2 * node + 1]);
+		}
+		fRemaining = n;
+	}
+
+	//position of the Signal Channel in the edges of the PM
+	int getEdge(int index) const
+	{
+		return fEdges[index];
+	}
+
+	float getTime(int index) const
+	{
+		return fTimes[index];
+	}
+
+	int size() const
+	{
+		return fTimes.size();
+	}
+
+	int remaining() const
+	{
+		return fRemaining;
+	}
+
+	//Returns the smallest input index of a not used Signal Channel whose time
+	//fulfills inWindow, or -1. inWindow must be true for a contiguous range of times
+	//around refTime, which holds for the |refTime - time| < maxTime conditions.
+	template <class Condition>
+	int findFirstUnused(float refTime, const Condition& inWindow) const
+	{
+		auto begin = fSorted.begin();
+		auto lo = std::partition_point(begin, fSorted.end(), [&](int i) {
+			return fTimes[i] < refTime && !inWindow(fTimes[i]);
+		});
+		auto hi = std::partition_point(lo, fSorted.end(), [&](int i) {
+			return fTimes[i] < refTime || inWindow(fTimes[i]);
+		});
+		int first = queryMin(lo - begin, hi - begin);
+		return first == kUsed ? -1 : first;
+	}
+
+	void markUsed(int index)
+	{
+		int node = fLeafs + fSortedPos[index];
+		fTree[node] = kUsed;
+		for (node /= 2; node > 0; node /= 2) {
+			fTree[node] = std::min(fTree[2 * node], fTree[2 * node + 1]);
+		}
+		fRemaining--;
+	}
+
+private:
+	static const int kUsed = std::numeric_limits<int>::max();
+
+	//minimum over the sorted positions [lo, hi)
+	int queryMin(int lo, int hi) const
+	{
+		int result = kUsed;
+		for (lo += fLeafs, hi += fLeafs; lo < hi; lo /= 2, hi /= 2) {
+			if (lo & 1) {
+				result = std::min(result, fTree[lo++]);
+			}
+			if (hi & 1) {
+				result = std::min(result, fTree[--hi]);
+			}
+		}
+		return result;
+	}
+
+	std::vector<int> fEdges;
+	std::vector<float> fTimes;
+	std::vector<int> fSorted;
+	std::vector<int> fSortedPos;
+	std::vector<int> fTree;
+	int fLeafs = 1;
+	int fRemaining = 0;
+};
+
+const int ThresholdSigChs::kUsed;
+
 }
 
 //method creating Raw signals form vector of Signal Channels
+//For every leading Signal Channel on the first threshold (in the input order)
+//the first unused Signal Channels on the other thresholds are searched:
+//leading ones not more than sigChEdgeMaxTime away and trailing ones not more
+//than sigChLeadTrailMaxTime away from the first threshold leading edge.
+//Trailing edge on a higher threshold is looked for only if the leading edge
+//on this threshold was found.
 vector<JPetRawSignal> SignalFinderTools::buildRawSignals(Int_t timeWindowIndex,
 					const vector<JPetSigCh>& sigChFromSamePM,
 					int numOfThresholds,
@@ -77,173 +351,273 @@ vector<JPetRawSignal> SignalFinderTools::buildRawSignals(Int_t timeWindowIndex,
 					double sigChEdgeMaxTime,
 					double sigChLeadTrailMaxTime)
 {
-	vector<JPetRawSignal> rawSigVec;
-
-	//Threshold number check - fixed number equal 4
-	if (numOfThresholds != 4) {
-		ERROR("This function is ment to work with 4 thresholds only!");
-		return rawSigVec;
+	vector<const JPetSigCh*> sigChPointers;
+	sigChPointers.reserve(sigChFromSamePM.size());
+	for (const JPetSigCh & sigCh : sigChFromSamePM) {
+		sigChPointers.push_back(&sigCh);
 	}
+	vector<JPetRawSignal> rawSigVec;
+	buildRawSignals(timeWindowIndex, sigChPointers.data(), sigChPointers.data() + sigChPointers.size(),
+		numOfThresholds, stats, saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, rawSigVec);
+	return rawSigVec;
+}
 
-	vector<JPetSigCh> tmp;
-	vector<vector<JPetSigCh>> thresholdSigCh(2 * numOfThresholds, tmp);
-
-	bool errorOccured = false;
+namespace
+{
 
-	//division into subvectors according to threshold number:
-	//0-3 leading, 4-7 trailing
-	for (const JPetSigCh & sigCh : sigChFromSamePM) {
-		auto threshNum = sigCh.getThresholdNumber();
-		if ((threshNum <= 0) || (threshNum > 2 * numOfThresholds)) {
-			ERROR("Threshold number out of range:" + std::to_string(threshNum));
-			errorOccured = true;
-			break;
-		}
+//Signal Channels of one PM given by the pointers to them
+class SigChPointerEdges
+{
+public:
+	SigChPointerEdges(SigChPMBuckets::Iterator begin, SigChPMBuckets::Iterator end):
+		fBegin(begin), fSize(end - begin) {}
 
-		if (sigCh.getType() == JPetSigCh::Leading) {
-			thresholdSigCh.at(sigCh.getThresholdNumber() - 1).push_back(sigCh);
-		} else if (sigCh.getType() == JPetSigCh::Trailing) {
-			thresholdSigCh.at(sigCh.getThresholdNumber() + numOfThresholds - 1)
-							.push_back(sigCh);
-		}
+	int size() const
+	{
+		return fSize;
 	}
 
-	if (errorOccured) {
-		return rawSigVec;
+	float getValue(int edge) const
+	{
+		return fBegin[edge]->getValue();
 	}
 
-	//probably not needed vector sorting according to Signal channel time values
-	for (auto thrVec : thresholdSigCh) {
-		sort(thrVec.begin(), thrVec.end(), sortByTimeValue);
+	JPetSigCh::EdgeType getType(int edge) const
+	{
+		return fBegin[edge]->getType();
 	}
 
-	assert(thresholdSigCh.size() > 0);
-	while (thresholdSigCh.at(0).size() > 0) {
-
-		JPetRawSignal rawSig;
-		rawSig.setTimeWindowIndex(timeWindowIndex);
-		rawSig.setPM(thresholdSigCh.at(0).at(0).getPM());
-		rawSig.setBarrelSlot(thresholdSigCh.at(0).at(0).getPM().getBarrelSlot());
+	int getThresholdNumber(int edge) const
+	{
+		return fBegin[edge]->getThresholdNumber();
+	}
 
-		//first leading added by default
-		rawSig.addPoint(thresholdSigCh.at(0).at(0));
+	const JPetPM& getPM(int edge) const
+	{
+		return fBegin[edge]->getPM();
+	}
 
-		//looking for points from other thresholds that belong to the same leading edge
-		//and search for equivalent trailing edge points
-		//first thr trailing
+	const JPetSigCh& getSigCh(int edge) const
+	{
+		return *fBegin[edge];
+	}
 
-		assert(thresholdSigCh.at(0).size() > 0);
-		assert(thresholdSigCh.size() > 4);
+private:
+	SigChPMBuckets::Iterator fBegin;
+	int fSize;
+};
 
-		int closestTrailingSigCh0 = findTrailingSigCh(
-						thresholdSigCh.at(0).at(0),
-						thresholdSigCh.at(4),
-						sigChLeadTrailMaxTime);
+//Signal Channels of one PM given by their indices in a SigChBuffer,
+//the full Signal Channel is created only for an edge added to a signal
+class SigChBufferEdges
+{
+public:
+	SigChBufferEdges(const SigChBuffer& buffer, const SigChChannelTable& channels,
+		SigChPMBuckets::IndexIterator begin, SigChPMBuckets::IndexIterator end):
+		fBuffer(buffer), fChannels(channels), fBegin(begin), fSize(end - begin) {}
+
+	int size() const
+	{
+		return fSize;
+	}
 
-		if (closestTrailingSigCh0 != -1) {
-			rawSig.addPoint(thresholdSigCh.at(4).at(closestTrailingSigCh0));
-			thresholdSigCh.at(4).erase(thresholdSigCh.at(4).begin()
-							+ closestTrailingSigCh0);
-		}
+	float getValue(int edge) const
+	{
+		return fBuffer.getValue(fBegin[edge]);
+	}
 
-		//second thr leading and trailing
-		int nextThrSigChIndex1 = findSigChOnNextThr(
-						thresholdSigCh.at(0).at(0).getValue(),
-						thresholdSigCh.at(1),
-						sigChEdgeMaxTime);
+	JPetSigCh::EdgeType getType(int edge) const
+	{
+		return fBuffer.getType(fBegin[edge]);
+	}
 
-		if (nextThrSigChIndex1 != -1) {
+	int getThresholdNumber(int edge) const
+	{
+		return fBuffer.getThresholdNumber(fBegin[edge]);
+	}
 
-			int closestTrailingSigCh1 = findTrailingSigCh(
-							thresholdSigCh.at(0).at(0),
-							thresholdSigCh.at(5),
-							sigChLeadTrailMaxTime);
+	const JPetPM& getPM(int edge) const
+	{
+		return fChannels.getPM(fBuffer.getDAQChannel(fBegin[edge]));
+	}
 
-			if (closestTrailingSigCh1 != -1) {
-				rawSig.addPoint(thresholdSigCh.at(5).at(closestTrailingSigCh1));
-				thresholdSigCh.at(5).erase(thresholdSigCh.at(5).begin()
-								+ closestTrailingSigCh1);
-      			}
+	JPetSigCh getSigCh(int edge) const
+	{
+		return fChannels.createSigCh(fBuffer, fBegin[edge]);
+	}
 
-			rawSig.addPoint(thresholdSigCh.at(1).at(nextThrSigChIndex1));
-			thresholdSigCh.at(1).erase(thresholdSigCh.at(1).begin()
-								+ nextThrSigChIndex1);
+private:
+	const SigChBuffer& fBuffer;
+	const SigChChannelTable& fChannels;
+	SigChPMBuckets::IndexIterator fBegin;
+	int fSize;
+};
+
+//Builds the signals of one PM for a fixed number of thresholds N,
+//so the loops over the thresholds have compile time bounds.
+template <int N, class Edges>
+void buildRawSignalsWithThresholds(Int_t timeWindowIndex,
+					const Edges& edges,
+					JPetStatistics& stats,
+					bool saveControlHistos,
+					double sigChEdgeMaxTime,
+					double sigChLeadTrailMaxTime,
+					vector<JPetRawSignal>& rawSigVec)
+{
+	//division into subvectors according to threshold number:
+	//0 - (N-1) leading, N - (2N-1) trailing
+	//the subvectors are kept between the calls, one set per thread
+	static thread_local array<ThresholdSigChs, 2 * N> thresholdSigCh;
+	for (auto & thrSigChs : thresholdSigCh) {
+		thrSigChs.clear();
+	}
+	for (int edge = 0; edge < edges.size(); edge++) {
+		auto threshNum = edges.getThresholdNumber(edge);
+		if ((threshNum <= 0) || (threshNum > N)) {
+			ERROR("Threshold number out of range:" + std::to_string(threshNum));
+			return;
+		}
+		if (edges.getType(edge) == JPetSigCh::Leading) {
+			thresholdSigCh[threshNum - 1].add(edge, edges.getValue(edge));
+		} else if (edges.getType(edge) == JPetSigCh::Trailing) {
+			thresholdSigCh[threshNum + N - 1].add(edge, edges.getValue(edge));
 		}
+	}
+	for (auto & thrSigChs : thresholdSigCh) {
+		thrSigChs.prepare();
+	}
 
-		//third thr leading and trailing
-		int nextThrSigChIndex2 = findSigChOnNextThr(
-						thresholdSigCh.at(0).at(0).getValue(),
-						thresholdSigCh.at(2),
-						sigChEdgeMaxTime);
+	const ThresholdSigChs& firstThrLeading = thresholdSigCh[0];
+	for (int leadIndex = 0; leadIndex < firstThrLeading.size(); leadIndex++) {
+		const int firstLeading = firstThrLeading.getEdge(leadIndex);
+		const float firstLeadingValue = firstThrLeading.getTime(leadIndex);
+		const Double_t firstLeadingTime = firstLeadingValue;
 
-		if (nextThrSigChIndex2 != -1) {
+		auto isOnSameEdge = [firstLeadingTime, sigChEdgeMaxTime](float time) {
+			return fabs(firstLeadingTime - time) < sigChEdgeMaxTime;
+		};
+		auto isMatchingTrailing = [firstLeadingTime, sigChLeadTrailMaxTime](float time) {
+			return fabs(firstLeadingTime - time) < sigChLeadTrailMaxTime;
+		};
 
-			int closestTrailingSigCh2 = findTrailingSigCh(
-							thresholdSigCh.at(0).at(0),
-							thresholdSigCh.at(6),
-							sigChLeadTrailMaxTime);
+		JPetRawSignal rawSig;
+		rawSig.setTimeWindowIndex(timeWindowIndex);
+		const JPetPM& pm = edges.getPM(firstLeading);
+		rawSig.setPM(pm);
+		rawSig.setBarrelSlot(pm.getBarrelSlot());
 
-			if (closestTrailingSigCh2 != -1) {
-				rawSig.addPoint(thresholdSigCh.at(6).at(closestTrailingSigCh2));
-				thresholdSigCh.at(6).erase(thresholdSigCh.at(6).begin()
-								+ closestTrailingSigCh2);
-			}
+		//first leading added by default
+		rawSig.addPoint(edges.getSigCh(firstLeading));
 
-			rawSig.addPoint(thresholdSigCh.at(2).at(nextThrSigChIndex2));
-			thresholdSigCh.at(2).erase(thresholdSigCh.at(2).begin()
-								+ nextThrSigChIndex2);
+		//first thr trailing
+		ThresholdSigChs& firstThrTrailing = thresholdSigCh[N];
+		int trailIndex = firstThrTrailing.findFirstUnused(firstLeadingValue, isMatchingTrailing);
+		if (trailIndex != -1) {
+			rawSig.addPoint(edges.getSigCh(firstThrTrailing.getEdge(trailIndex)));
+			firstThrTrailing.markUsed(trailIndex);
 		}
 
-		//fourth thr leading and trailing
-		int nextThrSigChIndex3 = findSigChOnNextThr(
-				thresholdSigCh.at(0).at(0).getValue(),
-				thresholdSigCh.at(3),
-				sigChEdgeMaxTime);
-
-		if (nextThrSigChIndex3 != -1) {
-
-			int closestTrailingSigCh3 = findTrailingSigCh(
-							thresholdSigCh.at(0).at(0),
-							thresholdSigCh.at(7),
-							sigChLeadTrailMaxTime);
-
-			if (closestTrailingSigCh3 != -1) {
-				rawSig.addPoint(thresholdSigCh.at(7).at(closestTrailingSigCh3));
-				thresholdSigCh.at(7).erase(thresholdSigCh.at(7).begin()
-								+ closestTrailingSigCh3);
+		//next thresholds leading and trailing
+		for (int thr = 1; thr < N; thr++) {
+			ThresholdSigChs& leading = thresholdSigCh[thr];
+			int nextThrIndex = leading.findFirstUnused(firstLeadingValue, isOnSameEdge);
+			if (nextThrIndex == -1) {
+				continue;
 			}
-
-			rawSig.addPoint(thresholdSigCh.at(3).at(nextThrSigChIndex3));
-			thresholdSigCh.at(3).erase(thresholdSigCh.at(3).begin()
-								+ nextThrSigChIndex3);
+			ThresholdSigChs& trailing = thresholdSigCh[thr + N];
+			int nextTrailIndex = trailing.findFirstUnused(firstLeadingValue, isMatchingTrailing);
+			if (nextTrailIndex != -1) {
+				rawSig.addPoint(edges.getSigCh(trailing.getEdge(nextTrailIndex)));
+				trailing.markUsed(nextTrailIndex);
+			}
+			rawSig.addPoint(edges.getSigCh(leading.getEdge(nextThrIndex)));
+			leading.markUsed(nextThrIndex);
 		}
 
 		//adding created Raw Signal to vector
 		rawSigVec.push_back(rawSig);
-		thresholdSigCh.at(0).erase(thresholdSigCh.at(0).begin() + 0);
 	}
 
 	//filling controll histograms
+	//all the leading Signal Channels on the first threshold are always used
 	if (saveControlHistos) {
-		stats.getHisto1D("remainig_leading_sig_ch_per_thr")
-					.Fill(1, thresholdSigCh.at(0).size());
-		stats.getHisto1D("remainig_leading_sig_ch_per_thr")
-					.Fill(2, thresholdSigCh.at(1).size());
-		stats.getHisto1D("remainig_leading_sig_ch_per_thr")
-					.Fill(3, thresholdSigCh.at(2).size());
-		stats.getHisto1D("remainig_leading_sig_ch_per_thr")
-					.Fill(4, thresholdSigCh.at(3).size());
-		stats.getHisto1D("remainig_trailing_sig_ch_per_thr")
-					.Fill(1, thresholdSigCh.at(4).size());
-		stats.getHisto1D("remainig_trailing_sig_ch_per_thr")
-					.Fill(2, thresholdSigCh.at(5).size());
-		stats.getHisto1D("remainig_trailing_sig_ch_per_thr")
-					.Fill(3, thresholdSigCh.at(6).size());
-		stats.getHisto1D("remainig_trailing_sig_ch_per_thr")
-					.Fill(4, thresholdSigCh.at(7).size());
+		TH1F& remainingLeading = stats.getHisto1D("remainig_leading_sig_ch_per_thr");
+		TH1F& remainingTrailing = stats.getHisto1D("remainig_trailing_sig_ch_per_thr");
+		for (int thr = 0; thr < N; thr++) {
+			remainingLeading.Fill(thr + 1, thr == 0 ? 0 : thresholdSigCh[thr].remaining());
+			remainingTrailing.Fill(thr + 1, thresholdSigCh[thr + N].remaining());
+		}
 	}
+}
 
-	return rawSigVec;
+template <class Edges>
+void buildRawSignalsOfEdges(Int_t timeWindowIndex,
+					const Edges& edges,
+					int numOfThresholds,
+					JPetStatistics& stats,
+					bool saveControlHistos,
+					double sigChEdgeMaxTime,
+					double sigChLeadTrailMaxTime,
+					vector<JPetRawSignal>& rawSigVec)
+{
+	switch (numOfThresholds) {
+	case 2:
+		buildRawSignalsWithThresholds<2>(timeWindowIndex, edges, stats,
+			saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, rawSigVec);
+		break;
+	case 4:
+		buildRawSignalsWithThresholds<4>(timeWindowIndex, edges, stats,
+			saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, rawSigVec);
+		break;
+	case 8:
+		buildRawSignalsWithThresholds<8>(timeWindowIndex, edges, stats,
+			saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, rawSigVec);
+		break;
+	default:
+		ERROR("Number of thresholds " + std::to_string(numOfThresholds) + " not supported, only 2, 4 and 8 are!");
+	}
+}
+
+}
+
+bool SignalFinderTools::isSupportedNumOfThresholds(int numOfThresholds)
+{
+	return numOfThresholds == 2 || numOfThresholds == 4 || numOfThresholds == 8;
+}
+
+void SignalFinderTools::buildRawSignals(Int_t timeWindowIndex,
+					SigChPMBuckets::Iterator sigChBegin,
+					SigChPMBuckets::Iterator sigChEnd,
+					int numOfThresholds,
+					JPetStatistics& stats,
+					bool saveControlHistos,
+					double sigChEdgeMaxTime,
+					double sigChLeadTrailMaxTime,
+					vector<JPetRawSignal>& rawSigVec)
+{
+	buildRawSignalsOfEdges(timeWindowIndex, SigChPointerEdges(sigChBegin, sigChEnd), numOfThresholds,
+		stats, saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, rawSigVec);
+}
+
+//method with loop of building raw signals for the buffer entries of all the PM buckets
+vector<JPetRawSignal> SignalFinderTools::buildAllSignals(Int_t timeWindowIndex,
+					const SigChBuffer& buffer,
+					const SigChPMBuckets& sigChsPMBuckets,
+					const SigChChannelTable& channels,
+					int numOfThresholds,
+					JPetStatistics& stats,
+					bool saveControlHistos,
+					double sigChEdgeMaxTime,
+					double sigChLeadTrailMaxTime)
+{
+	vector<JPetRawSignal> allSignals;
+	for (unsigned int bucket = 0; bucket < sigChsPMBuckets.getNumOfPMs(); bucket++) {
+		SigChBufferEdges edges(buffer, channels,
+			sigChsPMBuckets.beginIndices(bucket), sigChsPMBuckets.endIndices(bucket));
+		buildRawSignalsOfEdges(timeWindowIndex, edges, numOfThresholds,
+			stats, saveControlHistos, sigChEdgeMaxTime, sigChLeadTrailMaxTime, allSignals);
+	}
+	return allSignals;
 }
 
 
@@ -251,7 +625,7 @@ vector<JPetRawSignal> SignalFinderTools::buildRawSignals(Int_t timeWindowIndex,
 //not more than sigChEdgeMaxTime away. Defined in ps.
 int SignalFinderTools::findSigChOnNextThr(Double_t sigChValue, const vector<JPetSigCh>& sigChVec, double sigChEdgeMaxTime)
 {
-	for (Int_t i = 0; i < sigChVec.size(); i++) {
+	for (unsigned int i = 0; i < sigChVec.size(); i++) {
 		if (fabs(sigChValue - sigChVec.at(i).getValue()) < sigChEdgeMaxTime) {
 			return i;
 		}
@@ -265,12 +639,45 @@ int SignalFinderTools::findSigChOnNextThr(Double_t sigChValue, const vector<JPet
 //that is equivalent of SigCh earliest in time
 int SignalFinderTools::findTrailingSigCh(const JPetSigCh& leadingSigCh, const vector<JPetSigCh>& trailingSigChVec, double sigChLeadTrailMaxTime)
 {
-	vector<int> trailingFoundIdices;
-	for (Int_t i = 0; i < trailingSigChVec.size(); i++) {
-		if (fabs(leadingSigCh.getValue() - trailingSigChVec.at(i).getValue()) < sigChLeadTrailMaxTime)
-		trailingFoundIdices.push_back(i);
-	}
-	if (trailingFoundIdices.size() == 0) return -1;
-	sort(trailingFoundIdices.begin(), trailingFoundIdices.end());
-	return trailingFoundIdices.at(0);
+	for (unsigned int i = 0; i < trailingSigChVec.size(); i++) {
+		if (fabs(leadingSigCh.getValue() - trailingSigChVec.at(i).getValue()) < sigChLeadTrailMaxTime) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+//The Signal Channels fulfilling |refTime - time| < maxTime form a contiguous
+//range of a time-sorted vector. The comparator is true exactly for the Signal
+//Channels before this range, so lower_bound returns its first element.
+//The condition is evaluated in the same way as in the linear versions,
+//so both versions give the same result for sorted input.
+int SignalFinderTools::findSigChOnNextThrSorted(Double_t sigChValue, const vector<JPetSigCh>& sortedSigChVec, double sigChEdgeMaxTime)
+{
+	auto isOnSameEdge = [sigChEdgeMaxTime](Double_t refTime, const JPetSigCh & sigCh) {
+		return fabs(refTime - sigCh.getValue()) < sigChEdgeMaxTime;
+	};
+	auto found = lower_bound(sortedSigChVec.begin(), sortedSigChVec.end(), sigChValue,
+	[&isOnSameEdge](const JPetSigCh & sigCh, Double_t refTime) {
+		return sigCh.getValue() < refTime && !isOnSameEdge(refTime, sigCh);
+	});
+	if (found == sortedSigChVec.end() || !isOnSameEdge(sigChValue, *found)) {
+		return -1;
+	}
+	return found - sortedSigChVec.begin();
+}
+
+int SignalFinderTools::findTrailingSigChSorted(const JPetSigCh& leadingSigCh, const vector<JPetSigCh>& sortedTrailingSigChVec, double sigChLeadTrailMaxTime)
+{
+	auto isMatchingTrailing = [&leadingSigCh, sigChLeadTrailMaxTime](const JPetSigCh & sigCh) {
+		return fabs(leadingSigCh.getValue() - sigCh.getValue()) < sigChLeadTrailMaxTime;
+	};
+	auto found = lower_bound(sortedTrailingSigChVec.begin(), sortedTrailingSigChVec.end(), leadingSigCh.getValue(),
+	[&isMatchingTrailing](const JPetSigCh & sigCh, float leadingTime) {
+		return sigCh.getValue() < leadingTime && !isMatchingTrailing(sigCh);
+	});
+	if (found == sortedTrailingSigChVec.end() || !isMatchingTrailing(*found)) {
+		return -1;
+	}
+	return found - sortedTrailingSigChVec.begin();
 }
@@ -21,6 +21,51 @@
 #include <JPetSigCh/JPetSigCh.h>
 #include <JPetTimeWindow/JPetTimeWindow.h>
 #include <JPetStatistics/JPetStatistics.h>
+#include "SigChBuffer.h"
+
+//Signal Channels of one time window grouped by the PM they belong to.
+//A counting sort over the range of PM IDs present in the window puts the
+//indices of the Signal Channels into one contiguous buffer, with the offsets
+//of the buckets of every PM, and each bucket is then sorted by time.
+//The window is given either as a JPetTimeWindow, then begin() and end()
+//give the pointers to its Signal Channels, or as a SigChBuffer, then the
+//PM of every entry is taken from the SigChChannelTable and beginIndices()
+//and endIndices() give the indices of the entries. The entries of channels
+//which are not in the table are skipped.
+//The buffers are reused by the next fill(), so once the largest time window
+//was seen nothing is allocated per window. The pointers are valid as long
+//as the filled time window is not changed.
+class SigChPMBuckets
+{
+public:
+	typedef const JPetSigCh* const* Iterator;
+	typedef const unsigned int* IndexIterator;
+
+	void fill(const JPetTimeWindow& timeWindow);
+	void fill(const SigChBuffer& buffer, const SigChChannelTable& channels);
+	//number of PMs with at least one Signal Channel,
+	//the buckets are ordered by PM id
+	unsigned int getNumOfPMs() const;
+	int getPMID(unsigned int bucket) const;
+	Iterator begin(unsigned int bucket) const;
+	Iterator end(unsigned int bucket) const;
+	IndexIterator beginIndices(unsigned int bucket) const;
+	IndexIterator endIndices(unsigned int bucket) const;
+
+private:
+	//groups the indices [0, fSigChPMIDs.size()) with the PM id other than -1
+	void sortByPM();
+	template <class IsEarlier>
+	void sortBucketsByTime(const IsEarlier& isEarlier);
+
+	std::vector<const JPetSigCh*> fSigChs;
+	std::vector<unsigned int> fIndices;
+	std::vector<int> fSigChPMIDs;
+	std::vector<unsigned int> fOffsets;
+	std::vector<unsigned int> fCursors;
+	std::vector<int> fPMIDs;
+	int fMinPMID = 0;
+};
 
 class SignalFinderTools
 {
@@ -28,13 +73,26 @@ public:
 
 	//Method returns a map of vectors of JPetSigCh ordered by photomultiplier id.
 	//The map is based on the JPetSigCh from a given timeWindow.
+	//The vectors are sorted by the Signal Channel time.
 	static std::map<int, std::vector<JPetSigCh>> getSigChsPMMapById(const JPetTimeWindow* timeWindow);
 
 	//Method reconstructs all signals based on the signal channels
 	//from the SigChPMMap
 	static std::vector<JPetRawSignal> buildAllSignals(
   				Int_t timeWindowIndex,
-				std::map<int, std::vector<JPetSigCh>> sigChsPMMap,
+				const std::map<int, std::vector<JPetSigCh>>& sigChsPMMap,
+				int numOfThresholds,
+				JPetStatistics& stats,
+				bool saveControlHistos,
+				double sigChEdgeMaxTime,
+				double sigChLeadTrailMaxTime
+	);
+
+	//Method reconstructs all signals based on the signal channels
+	//grouped in the buckets, gives the same result as the map version
+	static std::vector<JPetRawSignal> buildAllSignals(
+				Int_t timeWindowIndex,
+				const SigChPMBuckets& sigChsPMBuckets,
 				int numOfThresholds,
 				JPetStatistics& stats,
 				bool saveControlHistos,
@@ -42,6 +100,24 @@ public:
 				double sigChLeadTrailMaxTime
 	);
 
+	//Version of the above method for the entries of a SigChBuffer grouped
+	//in the buckets, the full Signal Channels are created from the channel
+	//table only for the entries added to the signals
+	static std::vector<JPetRawSignal> buildAllSignals(
+				Int_t timeWindowIndex,
+				const SigChBuffer& buffer,
+				const SigChPMBuckets& sigChsPMBuckets,
+				const SigChChannelTable& channels,
+				int numOfThresholds,
+				JPetStatistics& stats,
+				bool saveControlHistos,
+				double sigChEdgeMaxTime,
+				double sigChLeadTrailMaxTime
+	);
+
+	//Numbers of thresholds the signals can be built for: 2, 4 and 8
+	static bool isSupportedNumOfThresholds(int numOfThresholds);
+
 	//Method reconstructs signals based on the signal channels
 	//from the sigChFromSamePM container
 	static std::vector<JPetRawSignal> buildRawSignals(Int_t timeWindowIndex,
@@ -53,6 +129,19 @@ public:
 				double sigChLeadTrailMaxTime
 	);
 
+	//Version of the above method for a range of pointers to the Signal Channels,
+	//the signals are appended to rawSigVec
+	static void buildRawSignals(Int_t timeWindowIndex,
+				SigChPMBuckets::Iterator sigChBegin,
+				SigChPMBuckets::Iterator sigChEnd,
+				int numOfThresholds,
+				JPetStatistics& stats,
+				bool saveControlHistos,
+				double sigChEdgeMaxTime,
+				double sigChLeadTrailMaxTime,
+				std::vector<JPetRawSignal>& rawSigVec
+	);
+
   	//Methods for checking relative between Signal Channel times
 	//and if they fit in defined time windows
 	static int findSigChOnNextThr(Double_t sigChValue,
@@ -63,5 +152,15 @@ public:
 				const std::vector<JPetSigCh>& trailingSigChVec,
 				double sigChLeadTrailMaxTime);
 
+	//Versions of the above methods for vectors sorted by time,
+	//using binary search instead of the linear scan
+	static int findSigChOnNextThrSorted(Double_t sigChValue,
+				const std::vector<JPetSigCh>& sortedSigChVec,
+				double sigChEdgeMaxTime);
+
+	static int findTrailingSigChSorted(const JPetSigCh& leadingSigCh,
+				const std::vector<JPetSigCh>& sortedTrailingSigChVec,
+				double sigChLeadTrailMaxTime);
+
 };
 #endif /*  !SIGNALFINDERTOOLS_H */
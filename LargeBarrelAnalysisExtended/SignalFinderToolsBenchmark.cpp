@@ -0,0 +1,226 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SignalFinderToolsBenchmark.cpp
+ *  @brief Microbenchmarks of the SignalFinderTools, in ns per Signal Channel.
+ *
+ *  The searches findSigChOnNextThr/findTrailingSigCh are compared with their
+ *  binary search versions for growing numbers of Signal Channels per threshold.
+ *  The grouping of a time window by PM and the building of the raw signals
+ *  are measured for growing numbers of pulses per PM, in 100 PMs read out
+ *  on 4 thresholds.
+ *  Usage: SignalFinderToolsBenchmark.x [--filter <text>] [--min-time <s>] [--repetitions <n>] [--csv]
+ */
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "BenchmarkTools.h"
+#include "SignalFinderTools.h"
+
+namespace
+{
+
+/// typical cuts used in the SignalFinder, in ps
+const double kSigChEdgeMaxTime = 5000.;
+const double kSigChLeadTrailMaxTime = 23000.;
+/// mean distance between the Signal Channels on one threshold is kept
+/// constant, so more Signal Channels correspond to longer time windows
+const double kMeanDistance = 200000.;
+const int kNumOfPMs = 100;
+const int kNumOfThresholds = 4;
+const std::vector<long long> kSigChsPerThreshold = {4, 16, 64, 256, 1024, 4096, 16384};
+const std::vector<long long> kPulsesPerPM = {1, 4, 16, 64, 256};
+
+std::vector<JPetSigCh> generateSortedSigChs(std::mt19937& generator, int numOfSigChs, double timeRange)
+{
+  std::uniform_real_distribution<double> time(0., timeRange);
+  std::vector<JPetSigCh> sigChs;
+  sigChs.reserve(numOfSigChs);
+  for (int i = 0; i < numOfSigChs; i++) {
+    sigChs.push_back(JPetSigCh(JPetSigCh::Trailing, time(generator)));
+  }
+  std::stable_sort(sigChs.begin(), sigChs.end(), [](const JPetSigCh & sigCh1, const JPetSigCh & sigCh2) {
+    return sigCh1.getValue() < sigCh2.getValue();
+  });
+  return sigChs;
+}
+
+/// Signal Channels of one time window, in the order of arrival. Every pulse
+/// gives the leading and trailing Signal Channels on all thresholds, with
+/// shorter TOTs on the higher thresholds.
+class SigChWindow
+{
+public:
+  SigChWindow(int pulsesPerPM)
+  {
+    std::mt19937 generator(2017);
+    std::uniform_real_distribution<double> pulseTime(-kMeanDistance * pulsesPerPM, 0.);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::normal_distribution<double> jitter(0., 500.);
+    std::vector<JPetSigCh> sigChs;
+    for (int pmID = 1; pmID <= kNumOfPMs; pmID++) {
+      fPMs.push_back(JPetPM(pmID));
+      for (int i = 0; i < pulsesPerPM; i++) {
+        double time = pulseTime(generator);
+        double tot = 60000. * (0.3 + uniform(generator));
+        for (int thr = 1; thr <= kNumOfThresholds; thr++) {
+          JPetSigCh leading(JPetSigCh::Leading, time + 300. * thr + jitter(generator));
+          JPetSigCh trailing(JPetSigCh::Trailing, time + tot * (1. - 0.15 * thr) + jitter(generator));
+          for (auto sigCh : {leading, trailing}) {
+            sigCh.setPM(fPMs.back());
+            sigCh.setThresholdNumber(thr);
+            sigChs.push_back(sigCh);
+          }
+        }
+      }
+    }
+    std::shuffle(sigChs.begin(), sigChs.end(), generator);
+    for (const auto& sigCh : sigChs) {
+      fTimeWindow.addCh(sigCh);
+    }
+  }
+
+  const JPetTimeWindow& getTimeWindow() const
+  {
+    return fTimeWindow;
+  }
+
+  double getNumOfSigChs() const
+  {
+    return fTimeWindow.getNumberOfSigCh();
+  }
+
+private:
+  std::deque<JPetPM> fPMs;
+  JPetTimeWindow fTimeWindow;
+};
+
+/// The linear and the binary searches must find the same Signal Channels.
+bool searchesAgree()
+{
+  std::mt19937 generator(2017);
+  for (long long numOfSigChs : kSigChsPerThreshold) {
+    const double timeRange = numOfSigChs * kMeanDistance;
+    auto sigChs = generateSortedSigChs(generator, numOfSigChs, timeRange);
+    for (const auto& lead : generateSortedSigChs(generator, 1024, timeRange)) {
+      if (SignalFinderTools::findSigChOnNextThr(lead.getValue(), sigChs, kSigChEdgeMaxTime)
+          != SignalFinderTools::findSigChOnNextThrSorted(lead.getValue(), sigChs, kSigChEdgeMaxTime)
+          || SignalFinderTools::findTrailingSigCh(lead, sigChs, kSigChLeadTrailMaxTime)
+          != SignalFinderTools::findTrailingSigChSorted(lead, sigChs, kSigChLeadTrailMaxTime)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// Runs search for the shuffled leading Signal Channels, one query per object.
+template <class Search>
+void runSearch(BenchmarkState& state, const Search& search)
+{
+  std::mt19937 generator(2017);
+  const double timeRange = state.getParameter() * kMeanDistance;
+  auto sigChs = generateSortedSigChs(generator, state.getParameter(), timeRange);
+  auto leadings = generateSortedSigChs(generator, 1024, timeRange);
+  std::shuffle(leadings.begin(), leadings.end(), generator);
+  state.setObjectsPerIteration(leadings.size());
+  while (state.keepRunning()) {
+    for (const auto& lead : leadings) {
+      doNotOptimize(search(lead, sigChs));
+    }
+  }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  BenchmarkRunner runner(argc, argv);
+  if (!searchesAgree()) {
+    std::cerr << "The linear and sorted searches give different results!" << std::endl;
+    return 1;
+  }
+  JPetStatistics stats;
+
+  runner.run("findSigChOnNextThr/linear", kSigChsPerThreshold, [](BenchmarkState & state) {
+    runSearch(state, [](const JPetSigCh & lead, const std::vector<JPetSigCh>& sigChs) {
+      return SignalFinderTools::findSigChOnNextThr(lead.getValue(), sigChs, kSigChEdgeMaxTime);
+    });
+  });
+  runner.run("findSigChOnNextThr/sorted", kSigChsPerThreshold, [](BenchmarkState & state) {
+    runSearch(state, [](const JPetSigCh & lead, const std::vector<JPetSigCh>& sigChs) {
+      return SignalFinderTools::findSigChOnNextThrSorted(lead.getValue(), sigChs, kSigChEdgeMaxTime);
+    });
+  });
+  runner.run("findTrailingSigCh/linear", kSigChsPerThreshold, [](BenchmarkState & state) {
+    runSearch(state, [](const JPetSigCh & lead, const std::vector<JPetSigCh>& sigChs) {
+      return SignalFinderTools::findTrailingSigCh(lead, sigChs, kSigChLeadTrailMaxTime);
+    });
+  });
+  runner.run("findTrailingSigCh/sorted", kSigChsPerThreshold, [](BenchmarkState & state) {
+    runSearch(state, [](const JPetSigCh & lead, const std::vector<JPetSigCh>& sigChs) {
+      return SignalFinderTools::findTrailingSigChSorted(lead, sigChs, kSigChLeadTrailMaxTime);
+    });
+  });
+
+  runner.run("getSigChsPMMapById", kPulsesPerPM, [](BenchmarkState & state) {
+    SigChWindow window(state.getParameter());
+    state.setObjectsPerIteration(window.getNumOfSigChs());
+    while (state.keepRunning()) {
+      doNotOptimize(SignalFinderTools::getSigChsPMMapById(&window.getTimeWindow()));
+    }
+  });
+  runner.run("SigChPMBuckets::fill", kPulsesPerPM, [](BenchmarkState & state) {
+    SigChWindow window(state.getParameter());
+    SigChPMBuckets buckets;
+    state.setObjectsPerIteration(window.getNumOfSigChs());
+    while (state.keepRunning()) {
+      buckets.fill(window.getTimeWindow());
+      doNotOptimize(buckets);
+    }
+  });
+  runner.run("buildRawSignals", kPulsesPerPM, [&stats](BenchmarkState & state) {
+    SigChWindow window(state.getParameter());
+    auto sigChsPMMap = SignalFinderTools::getSigChsPMMapById(&window.getTimeWindow());
+    state.setObjectsPerIteration(window.getNumOfSigChs());
+    while (state.keepRunning()) {
+      for (const auto& sigChPair : sigChsPMMap) {
+        doNotOptimize(SignalFinderTools::buildRawSignals(0, sigChPair.second, kNumOfThresholds, stats, false,
+                      kSigChEdgeMaxTime, kSigChLeadTrailMaxTime));
+      }
+    }
+  });
+  /// the whole SignalFinder step: grouping by PM and building the signals
+  runner.run("buildAllSignals/map", kPulsesPerPM, [&stats](BenchmarkState & state) {
+    SigChWindow window(state.getParameter());
+    state.setObjectsPerIteration(window.getNumOfSigChs());
+    while (state.keepRunning()) {
+      auto sigChsPMMap = SignalFinderTools::getSigChsPMMapById(&window.getTimeWindow());
+      doNotOptimize(SignalFinderTools::buildAllSignals(0, sigChsPMMap, kNumOfThresholds, stats, false,
+                    kSigChEdgeMaxTime, kSigChLeadTrailMaxTime));
+    }
+  });
+  runner.run("buildAllSignals/buckets", kPulsesPerPM, [&stats](BenchmarkState & state) {
+    SigChWindow window(state.getParameter());
+    SigChPMBuckets buckets;
+    state.setObjectsPerIteration(window.getNumOfSigChs());
+    while (state.keepRunning()) {
+      buckets.fill(window.getTimeWindow());
+      doNotOptimize(SignalFinderTools::buildAllSignals(0, buckets, kNumOfThresholds, stats, false,
+                    kSigChEdgeMaxTime, kSigChLeadTrailMaxTime));
+    }
+  });
+  return 0;
+}
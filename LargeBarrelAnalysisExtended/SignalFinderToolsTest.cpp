@@ -2,9 +2,78 @@
 #define BOOST_TEST_MODULE SignalFinderToolsTest
 #include <boost/test/unit_test.hpp>
 
+#include <random>
 #include "SignalFinderTools.h"
 #include "../j-pet-framework/JPetLoggerInclude.h"
 
+/// Generates Signal Channels of one PM similar to the ones recorded by the large barrel:
+/// pulses crossing the thresholds with some edges missing, plus random noise edges.
+/// The Signal Channels are grouped by DAQ channel, as they are created by TimeWindowCreator,
+/// so they are not ordered in time.
+std::vector<JPetSigCh> generatePMSigChs(std::mt19937& generator, int numOfPulses, int numOfNoiseSigChs,
+                                        int numOfThresholds = 4)
+{
+  std::uniform_real_distribution<double> pulseTime(-1.e6, 0.);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::normal_distribution<double> jitter(0., 500.);
+  std::vector<std::vector<JPetSigCh>> channels(numOfThresholds);
+  for (int i = 0; i < numOfPulses; i++) {
+    double time = pulseTime(generator);
+    double tot = 60000. * (0.3 + uniform(generator));
+    for (int thr = 1; thr <= numOfThresholds; thr++) {
+      double lead = time + 1200. / numOfThresholds * thr + jitter(generator);
+      double trail = time + tot * (1. - 0.6 / numOfThresholds * thr) + jitter(generator);
+      if (uniform(generator) < 0.9) {
+        JPetSigCh sigCh(JPetSigCh::Leading, lead);
+        sigCh.setThresholdNumber(thr);
+        channels.at(thr - 1).push_back(sigCh);
+      }
+      if (uniform(generator) < 0.9) {
+        JPetSigCh sigCh(JPetSigCh::Trailing, trail);
+        sigCh.setThresholdNumber(thr);
+        channels.at(thr - 1).push_back(sigCh);
+      }
+    }
+  }
+  std::uniform_int_distribution<int> threshold(1, numOfThresholds);
+  for (int i = 0; i < numOfNoiseSigChs; i++) {
+    JPetSigCh sigCh(uniform(generator) < 0.5 ? JPetSigCh::Leading : JPetSigCh::Trailing, pulseTime(generator));
+    sigCh.setThresholdNumber(threshold(generator));
+    channels.at(sigCh.getThresholdNumber() - 1).push_back(sigCh);
+  }
+  std::shuffle(channels.begin(), channels.end(), generator);
+  std::vector<JPetSigCh> sigChs;
+  for (const auto& channel : channels) {
+    sigChs.insert(sigChs.end(), channel.begin(), channel.end());
+  }
+  return sigChs;
+}
+
+void checkSamePoints(const std::vector<JPetSigCh>& points, const std::vector<JPetSigCh>& expected)
+{
+  BOOST_REQUIRE_EQUAL(points.size(), expected.size());
+  for (unsigned int i = 0; i < points.size(); i++) {
+    BOOST_REQUIRE_EQUAL(points.at(i).getThresholdNumber(), expected.at(i).getThresholdNumber());
+    BOOST_REQUIRE_EQUAL(points.at(i).getValue(), expected.at(i).getValue());
+  }
+}
+
+JPetSigCh createSigCh(JPetSigCh::EdgeType type, double time, int threshold, int daqChannel = 0)
+{
+  JPetSigCh sigCh(type, time);
+  sigCh.setThresholdNumber(threshold);
+  sigCh.setDAQch(daqChannel);
+  return sigCh;
+}
+
+/// Times of the edges of the signal by threshold number
+void checkEdges(const JPetRawSignal& signal, const std::map<int, double>& leading, const std::map<int, double>& trailing)
+{
+  auto leadingTimes = signal.getTimesVsThresholdNumber(JPetSigCh::Leading);
+  auto trailingTimes = signal.getTimesVsThresholdNumber(JPetSigCh::Trailing);
+  BOOST_REQUIRE(leadingTimes == leading);
+  BOOST_REQUIRE(trailingTimes == trailing);
+}
 
 BOOST_AUTO_TEST_SUITE(FirstSuite)
 
@@ -95,6 +164,120 @@ BOOST_AUTO_TEST_CASE( findSigChOnNextThr)
 }
 
 
+BOOST_AUTO_TEST_CASE( getSigChsPMMapById_sortedByTime )
+{
+  JPetTimeWindow window;
+  JPetPM pm(1);
+  std::vector<std::pair<double, int>> timesAndThresholds = {{30., 1}, {10., 1}, {20., 1}, {10., 2}};
+  for (const auto& timeAndThreshold : timesAndThresholds) {
+    auto sigCh = JPetSigCh(JPetSigCh::Leading, timeAndThreshold.first);
+    sigCh.setPM(pm);
+    sigCh.setThresholdNumber(timeAndThreshold.second);
+    window.addCh(sigCh);
+  }
+  auto results =  SignalFinderTools::getSigChsPMMapById(&window);
+  BOOST_REQUIRE_EQUAL(results.at(1).size(), 4);
+  auto epsilon = 0.0001;
+  BOOST_REQUIRE_CLOSE(results.at(1).at(0).getValue(), 10, epsilon);
+  BOOST_REQUIRE_EQUAL(results.at(1).at(0).getThresholdNumber(), 1);
+  BOOST_REQUIRE_CLOSE(results.at(1).at(1).getValue(), 10, epsilon);
+  BOOST_REQUIRE_EQUAL(results.at(1).at(1).getThresholdNumber(), 2);
+  BOOST_REQUIRE_CLOSE(results.at(1).at(2).getValue(), 20, epsilon);
+  BOOST_REQUIRE_CLOSE(results.at(1).at(3).getValue(), 30, epsilon);
+}
+
+BOOST_AUTO_TEST_CASE( sigChPMBuckets_empty )
+{
+  JPetTimeWindow window;
+  SigChPMBuckets buckets;
+  buckets.fill(window);
+  BOOST_REQUIRE_EQUAL(buckets.getNumOfPMs(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( sigChPMBuckets_sameAsMap )
+{
+  std::mt19937 generator(7);
+  SigChPMBuckets buckets;
+  for (int windowNumber = 0; windowNumber < 20; windowNumber++) {
+    JPetTimeWindow window;
+    std::vector<JPetSigCh> sigChs;
+    for (int pmID : {385, 3, 17, 200, 4}) {
+      if ((pmID + windowNumber) % 3 == 0) {
+        continue;
+      }
+      JPetPM pm(pmID);
+      for (auto sigCh : generatePMSigChs(generator, 1 + windowNumber, 3)) {
+        sigCh.setPM(pm);
+        sigChs.push_back(sigCh);
+      }
+    }
+    std::shuffle(sigChs.begin(), sigChs.end(), generator);
+    for (const auto& sigCh : sigChs) {
+      window.addCh(sigCh);
+    }
+    /// the same object is filled with windows of different sizes
+    buckets.fill(window);
+    auto sigChsPMMap = SignalFinderTools::getSigChsPMMapById(&window);
+    BOOST_REQUIRE_EQUAL(buckets.getNumOfPMs(), sigChsPMMap.size());
+    unsigned int bucket = 0;
+    for (const auto& sigChPair : sigChsPMMap) {
+      BOOST_REQUIRE_EQUAL(buckets.getPMID(bucket), sigChPair.first);
+      BOOST_REQUIRE_EQUAL(buckets.end(bucket) - buckets.begin(bucket), sigChPair.second.size());
+      for (unsigned int i = 0; i < sigChPair.second.size(); i++) {
+        BOOST_REQUIRE_EQUAL(buckets.begin(bucket)[i]->getValue(), sigChPair.second.at(i).getValue());
+        BOOST_REQUIRE_EQUAL(buckets.begin(bucket)[i]->getThresholdNumber(), sigChPair.second.at(i).getThresholdNumber());
+        BOOST_REQUIRE_EQUAL(buckets.begin(bucket)[i]->getType(), sigChPair.second.at(i).getType());
+      }
+      bucket++;
+    }
+
+    JPetStatistics stats;
+    auto results = SignalFinderTools::buildAllSignals(3, buckets, 4, stats, false, 20000, 300000);
+    auto expected = SignalFinderTools::buildAllSignals(3, sigChsPMMap, 4, stats, false, 20000, 300000);
+    BOOST_REQUIRE_EQUAL(results.size(), expected.size());
+    for (unsigned int i = 0; i < results.size(); i++) {
+      checkSamePoints(results.at(i).getPoints(JPetSigCh::Leading), expected.at(i).getPoints(JPetSigCh::Leading));
+      checkSamePoints(results.at(i).getPoints(JPetSigCh::Trailing), expected.at(i).getPoints(JPetSigCh::Trailing));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( findSigChOnNextThrSorted )
+{
+  auto window = 10;
+  std::vector<JPetSigCh> empty;
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(1, empty, window), -1);
+
+  std::vector<JPetSigCh> others = {JPetSigCh(JPetSigCh::Leading, -20), JPetSigCh(JPetSigCh::Leading, 3),
+                                   JPetSigCh(JPetSigCh::Leading, 7), JPetSigCh(JPetSigCh::Leading, 15)
+                                  };
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(1, others, window), 1);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(-12, others, window), 0);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(16, others, window), 2);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(-9, others, window), -1);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(40, others, window), -1);
+
+  /// the first of the Signal Channels with equal times, as in the linear search
+  std::vector<JPetSigCh> equalTimes = {JPetSigCh(JPetSigCh::Leading, 3), JPetSigCh(JPetSigCh::Leading, 3)};
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThrSorted(1, equalTimes, window), 0);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findSigChOnNextThr(1, equalTimes, window), 0);
+}
+
+BOOST_AUTO_TEST_CASE( findTrailingSigChSorted )
+{
+  auto window = 10;
+  JPetSigCh lead(JPetSigCh::Leading, 1);
+  std::vector<JPetSigCh> empty;
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findTrailingSigChSorted(lead, empty, window), -1);
+
+  std::vector<JPetSigCh> trailings = {JPetSigCh(JPetSigCh::Trailing, -30), JPetSigCh(JPetSigCh::Trailing, 2),
+                                      JPetSigCh(JPetSigCh::Trailing, 5), JPetSigCh(JPetSigCh::Trailing, 12)
+                                     };
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findTrailingSigChSorted(lead, trailings, window), 1);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findTrailingSigChSorted(JPetSigCh(JPetSigCh::Leading, 20), trailings, window), 3);
+  BOOST_REQUIRE_EQUAL(SignalFinderTools::findTrailingSigChSorted(JPetSigCh(JPetSigCh::Leading, -15), trailings, window), -1);
+}
+
 BOOST_AUTO_TEST_CASE( buildRawSignals_empty )
 {
   JPetStatistics stats;
@@ -161,4 +344,169 @@ BOOST_AUTO_TEST_CASE(buildRawSignals_2)
   BOOST_REQUIRE_CLOSE(points_trail.at(0).getValue(), 6, epsilon);
 }
 
+BOOST_AUTO_TEST_CASE(buildRawSignals_twoPulses)
+{
+  JPetStatistics stats;
+  /// the leading edges on the first threshold are taken in the input order, not in time order
+  std::vector<JPetSigCh> sigChs = {
+    createSigCh(JPetSigCh::Leading, 300, 1), createSigCh(JPetSigCh::Leading, 100, 1),
+    createSigCh(JPetSigCh::Trailing, 150, 1), createSigCh(JPetSigCh::Trailing, 350, 1),
+    createSigCh(JPetSigCh::Leading, 102, 2), createSigCh(JPetSigCh::Leading, 302, 2),
+    createSigCh(JPetSigCh::Trailing, 340, 2), createSigCh(JPetSigCh::Trailing, 140, 2)
+  };
+  auto results = SignalFinderTools::buildRawSignals(4, sigChs, 4, stats, false, 5, 100);
+  BOOST_REQUIRE_EQUAL(results.size(), 2u);
+  checkEdges(results.at(0), {{1, 300}, {2, 302}}, {{1, 350}, {2, 340}});
+  checkEdges(results.at(1), {{1, 100}, {2, 102}}, {{1, 150}, {2, 140}});
+  /// the same signals are built with 2 thresholds
+  results = SignalFinderTools::buildRawSignals(4, sigChs, 2, stats, false, 5, 100);
+  BOOST_REQUIRE_EQUAL(results.size(), 2u);
+  checkEdges(results.at(0), {{1, 300}, {2, 302}}, {{1, 350}, {2, 340}});
+  checkEdges(results.at(1), {{1, 100}, {2, 102}}, {{1, 150}, {2, 140}});
+}
+
+BOOST_AUTO_TEST_CASE(buildRawSignals_windowBoundaries)
+{
+  JPetStatistics stats;
+  std::vector<JPetSigCh> sigChs = {
+    createSigCh(JPetSigCh::Leading, 100, 1),
+    /// exactly sigChEdgeMaxTime and sigChLeadTrailMaxTime away, so not matched
+    createSigCh(JPetSigCh::Leading, 105, 2),
+    createSigCh(JPetSigCh::Trailing, 110, 1),
+    /// the trailing edge on the second threshold is not used without its leading edge
+    createSigCh(JPetSigCh::Trailing, 103, 2),
+    /// only the time distance counts, the trailing edge may be earlier
+    createSigCh(JPetSigCh::Trailing, 91, 1),
+    createSigCh(JPetSigCh::Leading, 104.5, 3),
+    createSigCh(JPetSigCh::Trailing, 108, 3)
+  };
+  auto results = SignalFinderTools::buildRawSignals(4, sigChs, 4, stats, false, 5, 10);
+  BOOST_REQUIRE_EQUAL(results.size(), 1u);
+  checkEdges(results.at(0), {{1, 100}, {3, 104.5}}, {{1, 91}, {3, 108}});
+}
+
+BOOST_AUTO_TEST_CASE(buildRawSignals_equalTimes)
+{
+  JPetStatistics stats;
+  /// among the edges with equal times the first one in the input is used first
+  std::vector<JPetSigCh> sigChs = {
+    createSigCh(JPetSigCh::Leading, 10, 1, 1), createSigCh(JPetSigCh::Leading, 10, 1, 2),
+    createSigCh(JPetSigCh::Leading, 12, 2, 3), createSigCh(JPetSigCh::Leading, 12, 2, 4),
+    createSigCh(JPetSigCh::Trailing, 50, 1, 5), createSigCh(JPetSigCh::Trailing, 50, 1, 6)
+  };
+  auto results = SignalFinderTools::buildRawSignals(4, sigChs, 4, stats, false, 5, 100);
+  BOOST_REQUIRE_EQUAL(results.size(), 2u);
+  for (unsigned int i = 0; i < results.size(); i++) {
+    auto leading = results.at(i).getPoints(JPetSigCh::Leading);
+    auto trailing = results.at(i).getPoints(JPetSigCh::Trailing);
+    BOOST_REQUIRE_EQUAL(leading.size(), 2u);
+    BOOST_REQUIRE_EQUAL(trailing.size(), 1u);
+    BOOST_REQUIRE_EQUAL(leading.at(0).getDAQch(), 1 + i);
+    BOOST_REQUIRE_EQUAL(leading.at(1).getDAQch(), 3 + i);
+    BOOST_REQUIRE_EQUAL(trailing.at(0).getDAQch(), 5 + i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(buildRawSignals_thresholdOutOfRange)
+{
+  JPetStatistics stats;
+  /// a Signal Channel with a wrong threshold number drops all the signals of the PM
+  for (int wrongThreshold : {0, -1, 5}) {
+    std::vector<JPetSigCh> sigChs = {
+      createSigCh(JPetSigCh::Leading, 10, 1), createSigCh(JPetSigCh::Trailing, 50, 1),
+      createSigCh(JPetSigCh::Leading, 11, wrongThreshold)
+    };
+    BOOST_REQUIRE(SignalFinderTools::buildRawSignals(4, sigChs, 4, stats, false, 5, 100).empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(buildRawSignals_8Thresholds_allPoints)
+{
+  JPetStatistics stats;
+  std::vector<JPetSigCh> sigChFromSamePM;
+  for (int thr = 1; thr <= 8; thr++) {
+    auto leading = JPetSigCh(JPetSigCh::Leading, 100 + thr);
+    leading.setThresholdNumber(thr);
+    auto trailing = JPetSigCh(JPetSigCh::Trailing, 200 - thr);
+    trailing.setThresholdNumber(thr);
+    sigChFromSamePM.push_back(leading);
+    sigChFromSamePM.push_back(trailing);
+  }
+  auto results = SignalFinderTools::buildRawSignals(4, sigChFromSamePM, 8, stats, false, 10, 150);
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  BOOST_REQUIRE_EQUAL(results.at(0).getPoints(JPetSigCh::Leading).size(), 8);
+  BOOST_REQUIRE_EQUAL(results.at(0).getPoints(JPetSigCh::Trailing).size(), 8);
+  /// threshold 5 is not supported by the 4 thresholds builder
+  BOOST_REQUIRE(SignalFinderTools::buildRawSignals(4, sigChFromSamePM, 4, stats, false, 10, 150).empty());
+}
+
+BOOST_AUTO_TEST_CASE(buildRawSignals_unsupportedNumOfThresholds)
+{
+  JPetStatistics stats;
+  auto sigCh1 = JPetSigCh(JPetSigCh::Leading, 10);
+  sigCh1.setThresholdNumber(1);
+  std::vector<JPetSigCh> sigChFromSamePM = {sigCh1};
+  BOOST_REQUIRE(SignalFinderTools::buildRawSignals(4, sigChFromSamePM, 3, stats, false, 5, 5).empty());
+  BOOST_REQUIRE(SignalFinderTools::isSupportedNumOfThresholds(2));
+  BOOST_REQUIRE(SignalFinderTools::isSupportedNumOfThresholds(4));
+  BOOST_REQUIRE(SignalFinderTools::isSupportedNumOfThresholds(8));
+  BOOST_REQUIRE(!SignalFinderTools::isSupportedNumOfThresholds(1));
+  BOOST_REQUIRE(!SignalFinderTools::isSupportedNumOfThresholds(3));
+}
+
+BOOST_AUTO_TEST_CASE(buildAllSignals_sigChBuffer)
+{
+  JPetPM pm1(1), pm2(2);
+  std::vector<JPetTOMBChannel> tombChannels = {JPetTOMBChannel(1), JPetTOMBChannel(2), JPetTOMBChannel(3)};
+  tombChannels.at(0).setPM(pm1);
+  tombChannels.at(0).setLocalChannelNumber(1);
+  tombChannels.at(1).setPM(pm1);
+  tombChannels.at(1).setLocalChannelNumber(2);
+  tombChannels.at(2).setPM(pm2);
+  tombChannels.at(2).setLocalChannelNumber(1);
+  JPetParamBank paramBank;
+  for (auto& channel : tombChannels) {
+    paramBank.addTOMBChannel(channel);
+  }
+  SigChChannelTable channels;
+  channels.build(paramBank);
+  BOOST_REQUIRE_EQUAL(channels.getPMID(3), 2);
+  BOOST_REQUIRE_EQUAL(channels.getPMID(0), -1);
+  BOOST_REQUIRE_EQUAL(channels.getPMID(7), -1);
+
+  SigChBuffer buffer;
+  buffer.setIndex(6);
+  buffer.add(2, JPetSigCh::Leading, 2, 105.);
+  buffer.add(1, JPetSigCh::Leading, 1, 300.);
+  buffer.add(1, JPetSigCh::Leading, 1, 100.);
+  buffer.add(1, JPetSigCh::Trailing, 1, 150.);
+  buffer.add(2, JPetSigCh::Trailing, 2, 140.);
+  buffer.add(3, JPetSigCh::Leading, 1, 50.);
+  /// channel not in the setup, skipped
+  buffer.add(7, JPetSigCh::Leading, 1, 60.);
+  buffer.add(3, JPetSigCh::Trailing, 1, 80.);
+
+  SigChPMBuckets buckets;
+  buckets.fill(buffer, channels);
+  BOOST_REQUIRE_EQUAL(buckets.getNumOfPMs(), 2);
+  BOOST_REQUIRE_EQUAL(buckets.endIndices(0) - buckets.beginIndices(0), 5);
+  BOOST_REQUIRE_EQUAL(*buckets.beginIndices(0), 2);
+
+  JPetStatistics stats;
+  auto signals = SignalFinderTools::buildAllSignals(buffer.getIndex(), buffer, buckets, channels,
+                 4, stats, false, 20, 100);
+  BOOST_REQUIRE_EQUAL(signals.size(), 3);
+  checkEdges(signals.at(0), {{1, 100.}, {2, 105.}}, {{1, 150.}, {2, 140.}});
+  checkEdges(signals.at(1), {{1, 300.}}, {});
+  checkEdges(signals.at(2), {{1, 50.}}, {{1, 80.}});
+  BOOST_REQUIRE_EQUAL(signals.at(0).getPM().getID(), 1);
+  BOOST_REQUIRE_EQUAL(signals.at(2).getPM().getID(), 2);
+  BOOST_REQUIRE_EQUAL(signals.at(0).getTimeWindowIndex(), 6);
+  /// the Signal Channels are created from the templates of their DAQ channels
+  auto leading = signals.at(0).getPoints(JPetSigCh::Leading);
+  BOOST_REQUIRE_EQUAL(leading.at(0).getDAQch(), 1);
+  BOOST_REQUIRE_EQUAL(leading.at(1).getDAQch(), 2);
+  BOOST_REQUIRE_EQUAL(leading.at(1).getPM().getID(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,10 +14,9 @@
  */
 
 #include "SignalTransformer.h"
-#include "JPetWriter/JPetWriter.h"
 
 SignalTransformer::SignalTransformer(const char* name, const char* description):
-	JPetTask(name, description) { }
+	PipelineStage(name, description) { }
 
 void SignalTransformer::init(const JPetTaskInterface::Options& opts)
 {
@@ -103,7 +102,6 @@ JPetPhysSignal SignalTransformer::createPhysSignal(JPetRecoSignal& recoSignal)
 
 void SignalTransformer::savePhysSignal(JPetPhysSignal sig)
 {
-	assert(fWriter);
-	fWriter->write(sig);
+	forward(sig);
 }
 
@@ -16,16 +16,14 @@
 #ifndef SIGNALTRANSFORMER_H
 #define SIGNALTRANSFORMER_H
 
-#include "JPetTask/JPetTask.h"
 #include "JPetRecoSignal/JPetRecoSignal.h"
+#include "PipelineStage.h"
 
 #ifdef __CINT__
 #   define override
 #endif
 
-class JPetWriter;
-
-class SignalTransformer: public JPetTask
+class SignalTransformer: public PipelineStage
 {
 
 public:
@@ -33,14 +31,10 @@ public:
 	virtual void init(const JPetTaskInterface::Options& opts)override;
 	virtual void exec()override;
 	virtual void terminate()override;
-	virtual void setWriter(JPetWriter* writer) override{
-		fWriter = writer;
-	}
 
 protected:
 	JPetRecoSignal createRecoSignal(JPetRawSignal& rawSignal);
 	JPetPhysSignal createPhysSignal(JPetRecoSignal& signals);
 	void savePhysSignal( JPetPhysSignal signal);
-	JPetWriter* fWriter;
 };
 #endif /*  !SIGNALTRANSFORMER_H */
@@ -15,11 +15,15 @@
 
 #include "TimeCalibLoader.h"
 #include "TimeCalibTools.h"
+#include "SigChBuffer.h"
+#include "BatchTools.h"
+#include "SharedCache.h"
 #include "JPetGeomMapping/JPetGeomMapping.h"
 #include <JPetParamManager/JPetParamManager.h>
+#include <cstdlib>
 
 TimeCalibLoader::TimeCalibLoader(const char* name, const char* description):
-  JPetTask(name, description)
+  PipelineStage(name, description)
 {
   /**/
 }
@@ -33,42 +37,113 @@ void TimeCalibLoader::init(const JPetTaskInterface::Options& opts)
     calibFile = opts.at(fConfigFileParamKey);
   }
   assert(fParamManager);
-  JPetGeomMapping mapper(fParamManager->getParamBank());
-  auto tombMap = mapper.getTOMBMapping();
-  fTimeCalibration = TimeCalibTools::loadTimeCalibration(calibFile, tombMap);
+  auto cacheDir = opts.count(fCacheDirParamKey) ? opts.at(fCacheDirParamKey) : std::string();
+  auto runId = opts.count("runId") ? std::atoi(opts.at("runId").c_str()) : -1;
+  /// in the batch mode the table is loaded once for all input files
+  auto key = BatchTools::getSetupKey(opts) + "|" + calibFile + "|" + cacheDir;
+  fTimeCalibration = *SharedCache<TimeCalibTable>::getCache().get(key, [&]() {
+    return cacheDir.empty() ? loadTimeCalibration(calibFile)
+           : loadTimeCalibrationWithCache(calibFile, cacheDir, opts, runId);
+  });
   if (fTimeCalibration.empty()) {
     ERROR("Time calibration seems to be empty");
+  } else {
+    INFO("Time calibration loaded for " + std::to_string(fTimeCalibration.getNumOfChannels()) + " channels");
+  }
+  /// In the FusedPipeline the input window is not used by anyone else after this stage.
+  fInPlace = fNextStage != nullptr;
+  if (opts.count(fInPlaceParamKey)) {
+    fInPlace = opts.at(fInPlaceParamKey) == "true";
   }
 }
 
+TimeCalibTable TimeCalibLoader::loadTimeCalibration(const std::string& calibFile)
+{
+  JPetGeomMapping mapper(fParamManager->getParamBank());
+  auto tombMap = mapper.getTOMBMapping();
+  return TimeCalibTools::loadTimeCalibTable(calibFile, tombMap);
+}
+
+TimeCalibTable TimeCalibLoader::loadTimeCalibrationWithCache(const std::string& calibFile, const std::string& cacheDir,
+    const JPetTaskInterface::Options& opts, int runId)
+{
+  auto calibFileHash = TimeCalibTools::hashFile(calibFile);
+  if (calibFileHash == 0) {
+    /// the missing file is reported by the normal loading
+    return loadTimeCalibration(calibFile);
+  }
+  /// the TOMB mapping is taken from the setup, a changed setup file gives another cache
+  uint64_t setupFileHash = 0;
+  if (opts.count("localDB")) {
+    setupFileHash = TimeCalibTools::hashFile(opts.at("localDB"));
+    if (setupFileHash == 0) {
+      WARNING("Can not read the setup file " + opts.at("localDB") + ", the time calibration cache is not used");
+      return loadTimeCalibration(calibFile);
+    }
+  }
+  auto cacheFile = TimeCalibTools::getTimeCalibCacheFileName(cacheDir, calibFileHash, setupFileHash, runId);
+  TimeCalibTable table;
+  if (TimeCalibTools::loadTimeCalibCache(cacheFile, calibFileHash, setupFileHash, runId, table)) {
+    INFO("Time calibration loaded from the cache:" + cacheFile);
+    return table;
+  }
+  table = loadTimeCalibration(calibFile);
+  if (!table.empty() && TimeCalibTools::saveTimeCalibCache(cacheFile, calibFileHash, setupFileHash, runId, table)) {
+    INFO("Time calibration cache created:" + cacheFile);
+  }
+  return table;
+}
+
 void TimeCalibLoader::exec()
 {
-  if (auto oldTimeWindow = dynamic_cast<const JPetTimeWindow* const>(getEvent())) {
+  if (fInPlace) {
+    calibrateInPlace();
+  } else if (auto oldTimeWindow = dynamic_cast<const JPetTimeWindow* const>(getEvent())) {
     JPetTimeWindow correctedWindow;
     auto newSigChs = oldTimeWindow->getSigChVect();
-    for (auto & sigCh : newSigChs) {
-      /// Calibration time is ns so we should change it to ps, cause all the time is in ps.
-      sigCh.setValue(sigCh.getValue() + 1000. * TimeCalibTools::getTimeCalibCorrection(fTimeCalibration, sigCh.getTOMBChannel().getChannel()));
+    fTimeCalibration.applyCorrections(newSigChs.data(), newSigChs.data() + newSigChs.size());
+    for (const auto & sigCh : newSigChs) {
       correctedWindow.addCh(sigCh);
     }
     correctedWindow.setIndex(oldTimeWindow->getIndex());
     saveTimeWindow(correctedWindow);
+  } else if (auto oldBuffer = dynamic_cast<const SigChBuffer* const>(getEvent())) {
+    SigChBuffer correctedBuffer(*oldBuffer);
+    fTimeCalibration.applyCorrections(correctedBuffer);
+    if (fWriter) {
+      /// the compact buffer can not be saved
+      saveTimeWindow(correctedBuffer.toTimeWindow(fParamManager->getParamBank()));
+    } else {
+      forward(correctedBuffer);
+    }
   }
 }
 
-void TimeCalibLoader::saveTimeWindow(const JPetTimeWindow& window)
+void TimeCalibLoader::calibrateInPlace()
 {
-  assert(fWriter);
-  fWriter->write(window);
+  if (auto timeWindow = dynamic_cast<JPetTimeWindow*>(getEvent())) {
+    /// JPetTimeWindow gives only the const access to its Signal Channels
+    auto& sigChs = const_cast<std::vector<JPetSigCh>&>(timeWindow->getSigChVect());
+    fTimeCalibration.applyCorrections(sigChs.data(), sigChs.data() + sigChs.size());
+    saveTimeWindow(*timeWindow);
+  } else if (auto buffer = dynamic_cast<SigChBuffer*>(getEvent())) {
+    fTimeCalibration.applyCorrections(*buffer);
+    if (fWriter) {
+      /// the compact buffer can not be saved
+      saveTimeWindow(buffer->toTimeWindow(fParamManager->getParamBank()));
+    } else {
+      forward(*buffer);
+    }
+  }
 }
 
-void TimeCalibLoader::terminate()
+void TimeCalibLoader::saveTimeWindow(const JPetTimeWindow& window)
 {
+  forward(window);
 }
 
-void TimeCalibLoader::setWriter(JPetWriter* writer)
+void TimeCalibLoader::terminate()
 {
-  fWriter = writer;
 }
 
 void TimeCalibLoader::setParamManager(JPetParamManager* paramManager)
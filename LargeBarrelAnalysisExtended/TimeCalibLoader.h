@@ -22,8 +22,8 @@
 #	define override
 #endif
 
-#include <JPetTask/JPetTask.h>
-#include <map>
+#include "PipelineStage.h"
+#include "TimeCalibTools.h"
 
 /**
  * @brief module to apply the time calibration in J-PET. It takes
@@ -36,13 +36,24 @@
  * is not set.
  * The current correction has a following formula: raw_time + 1000 * correction_constant
  * 1000 factor is needed because current calib constants are expressed in ns, while
- * JPetSigCh time is in ps.
- * If a calibration constant is missing for a given channel, then the 0 is returned.
- * Also, info to log will be sent if DEBUG level is activated.
+ * JPetSigCh time is in ps. For the trailing edges the correction constant is the sum
+ * of the leading and trailing offsets from the file.
+ * If a calibration constant is missing for a given channel, then the 0 is used.
  * The calibration is applied based on the TOMB identifier.
+ * The compact SigChBuffer produced by the TimeWindowCreator is calibrated as well
+ * and passed on in the same form, unless the output of this task is saved.
+ * When the task is run in the FusedPipeline, the times are corrected in place
+ * in the input window instead of building a new one. This can be changed with the
+ * user option "TimeCalibLoader_InPlace":"true" or "false".
+ * With the user option "TimeCalibLoader_CacheDir":"path_to_directory" the calibration
+ * table is stored in a binary file in this directory, named after the hashes of the
+ * calibration file and the setup file ("localDB") and the run number. The next jobs
+ * with the same calibration, setup and run read this file instead of parsing
+ * the calibration and mapping the TOMB channels.
+ * In the batch mode the table is loaded once and shared by the task chains of all input files.
  *
  */
-class TimeCalibLoader : public JPetTask
+class TimeCalibLoader : public PipelineStage
 {
 public:
   TimeCalibLoader(const char* name, const char* description);
@@ -50,14 +61,20 @@ public:
   virtual void init(const JPetTaskInterface::Options& opts) override;
   virtual void exec() override;
   virtual void terminate() override;
-  virtual void setWriter(JPetWriter* writer) override;
   virtual void setParamManager(JPetParamManager* paramManager) override;
 protected:
   void saveTimeWindow(const JPetTimeWindow& window);
+  TimeCalibTable loadTimeCalibration(const std::string& calibFile);
+  TimeCalibTable loadTimeCalibrationWithCache(const std::string& calibFile, const std::string& cacheDir,
+      const JPetTaskInterface::Options& opts, int runId);
+  /// Corrects the times in the input object itself, without copying it.
+  void calibrateInPlace();
 
   const std::string fConfigFileParamKey = "TimeCalibLoader_ConfigFile";  ///Name of the option for which the value would correspond to the time calibration file name.
-  JPetWriter* fWriter = nullptr;
+  const std::string fInPlaceParamKey = "TimeCalibLoader_InPlace";
+  const std::string fCacheDirParamKey = "TimeCalibLoader_CacheDir";
+  bool fInPlace = false;
   JPetParamManager* fParamManager = nullptr;
-  std::map<unsigned int, double> fTimeCalibration;
+  TimeCalibTable fTimeCalibration;
 };
 #endif /*  !TIMECALIBLOADER_H */
@@ -16,18 +16,122 @@
 #include <boost/algorithm/string/predicate.hpp> /// for starts_with
 #include <boost/filesystem.hpp> /// for exists()
 #include <algorithm> /// for any_of()
+#include <cstdio> /// for rename()
+#include <cstring>
+#include <fstream>
 #include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "TimeCalibTools.h"
+#include "SigChBuffer.h"
 #include "JPetLoggerInclude.h"
 
+void TimeCalibTable::setCorrection(unsigned int channel, double leadingOffset, double trailingOffset)
+{
+  if (channel >= fValid.size()) {
+    fLeadingCorrections.resize(channel + 1, 0.f);
+    fTrailingCorrections.resize(channel + 1, 0.f);
+    fValid.resize(channel + 1, false);
+  }
+  if (!fValid[channel]) {
+    fValid[channel] = true;
+    fNumOfChannels++;
+  }
+  /// Calibration constants are in ns, the Signal Channel times in ps.
+  fLeadingCorrections[channel] = 1000. * leadingOffset;
+  fTrailingCorrections[channel] = 1000. * (leadingOffset + trailingOffset);
+}
+
+bool TimeCalibTable::isValid(unsigned int channel) const
+{
+  return channel < fValid.size() && fValid[channel];
+}
+
+float TimeCalibTable::getCorrection(unsigned int channel, JPetSigCh::EdgeType type) const
+{
+  if (channel >= fValid.size()) {
+    return 0.f;
+  }
+  return type == JPetSigCh::Trailing ? fTrailingCorrections[channel] : fLeadingCorrections[channel];
+}
+
+std::size_t TimeCalibTable::getNumOfChannels() const
+{
+  return fNumOfChannels;
+}
+
+bool TimeCalibTable::empty() const
+{
+  return fNumOfChannels == 0;
+}
+
+void TimeCalibTable::applyCorrections(JPetSigCh* begin, JPetSigCh* end) const
+{
+  for (auto sigCh = begin; sigCh != end; ++sigCh) {
+    sigCh->setValue(sigCh->getValue() + getCorrection(sigCh->getDAQch(), sigCh->getType()));
+  }
+}
+
+/// Single pass over the arrays of the buffer, without calls and branches
+/// other than the check of the channel range.
+void TimeCalibTable::applyCorrections(SigChBuffer& buffer) const
+{
+  const unsigned int* channels = buffer.getDAQChannels().data();
+  const char* types = buffer.getTypes().data();
+  float* values = buffer.getValues().data();
+  const float* leading = fLeadingCorrections.data();
+  const float* trailing = fTrailingCorrections.data();
+  const std::size_t tableSize = fLeadingCorrections.size();
+  const std::size_t size = buffer.size();
+  for (std::size_t i = 0; i < size; i++) {
+    const unsigned int channel = channels[i];
+    if (channel < tableSize) {
+      values[i] += types[i] == JPetSigCh::Trailing ? trailing[channel] : leading[channel];
+    }
+  }
+}
+
 double TimeCalibTools::getTimeCalibCorrection(const TOMBChToCorrection& timeCalibration, const unsigned int channel)
 {
-  if (timeCalibration.find(channel) == timeCalibration.end()) {
+  auto correction = timeCalibration.find(channel);
+  if (correction == timeCalibration.end()) {
     DEBUG("No time calibration available for the channel" + std::to_string(channel));
     return 0.0;
   } else {
-    return timeCalibration.at(channel);
+    return correction->second;
+  }
+}
+
+TimeCalibTable TimeCalibTools::loadTimeCalibTable(const std::string& calibFile, const TimeCalibTools::TOMBChMap& tombMap)
+{
+  INFO("Loading time calibration from:" + calibFile);
+  if ( !boost::filesystem::exists(calibFile)) {
+    ERROR("Calibration file does not exist:" + calibFile + " Returning empty timeCalibration");
+    return TimeCalibTable();
+  }
+  auto calibRecords = readCalibrationRecordsFromFile(calibFile);
+  return generateTimeCalibTable(calibRecords, tombMap);
+}
+
+TimeCalibTable TimeCalibTools::generateTimeCalibTable(const std::vector<TimeCalibRecord>& calibRecords,  const TimeCalibTools::TOMBChMap& tombMap)
+{
+  TimeCalibTable timeCalibration;
+  if (!areCorrectTimeCalibRecords(calibRecords)) {
+    ERROR("Empty calibration will be returned");
+    return timeCalibration;
   }
+  for (const auto& r : calibRecords) {
+    auto key = std::make_tuple(r.layer, r.slot, r.side, r.threshold);
+    auto tombCh = tombMap.find(key);
+    if (tombCh != tombMap.end()) {
+      timeCalibration.setCorrection(tombCh->second, r.offset_value_leading, r.offset_value_trailing);
+    } else {
+      ERROR("No TOMB channel number in TOMB MAP for the combination: layer=" + std::to_string(r.layer) + ",slot=" + std::to_string(r.slot) + ",side=" + std::to_string(r.side) + ",threshold=" + std::to_string(r.threshold));
+    }
+  }
+  return timeCalibration;
 }
 
 TimeCalibTools::TOMBChToCorrection TimeCalibTools::loadTimeCalibration(const std::string& calibFile, const TimeCalibTools::TOMBChMap& tombMap)
@@ -66,6 +170,127 @@ TimeCalibTools::TOMBChToCorrection TimeCalibTools::generateTimeCalibration(const
   return timeCalibration;
 }
 
+namespace
+{
+const char kCacheMagic[8] = {'J', 'P', 'E', 'T', 'T', 'C', 'C', '2'};
+
+/// The header is followed by the leading corrections, the trailing corrections
+/// (both as tableSize floats) and the validity flags (tableSize bytes).
+struct TimeCalibCacheHeader {
+  char magic[8];
+  uint64_t calibFileHash;
+  uint64_t setupFileHash;
+  int64_t runId;
+  uint64_t tableSize;
+};
+
+std::size_t getCacheFileSize(uint64_t tableSize)
+{
+  return sizeof(TimeCalibCacheHeader) + tableSize * (2 * sizeof(float) + 1);
+}
+}
+
+std::string TimeCalibTools::getTimeCalibCacheFileName(const std::string& cacheDir, uint64_t calibFileHash,
+    uint64_t setupFileHash, int runId)
+{
+  char name[80];
+  snprintf(name, sizeof(name), "timeCalib_%016llx_%016llx_run%d.bin", static_cast<unsigned long long>(calibFileHash),
+           static_cast<unsigned long long>(setupFileHash), runId);
+  return cacheDir.empty() ? std::string(name) : cacheDir + "/" + name;
+}
+
+bool TimeCalibTools::loadTimeCalibCache(const std::string& cacheFile, uint64_t calibFileHash,
+                                        uint64_t setupFileHash, int runId, TimeCalibTable& table)
+{
+  int fd = open(cacheFile.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || static_cast<std::size_t>(fileStat.st_size) < sizeof(TimeCalibCacheHeader)) {
+    close(fd);
+    return false;
+  }
+  const std::size_t fileSize = fileStat.st_size;
+  void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  const char* data = static_cast<const char*>(mapped);
+  TimeCalibCacheHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  bool valid = std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) == 0
+               && header.calibFileHash == calibFileHash
+               && header.setupFileHash == setupFileHash
+               && header.runId == runId
+               && fileSize == getCacheFileSize(header.tableSize);
+  if (valid) {
+    const std::size_t size = header.tableSize;
+    const float* leading = reinterpret_cast<const float*>(data + sizeof(header));
+    const float* trailing = leading + size;
+    const char* flags = reinterpret_cast<const char*>(trailing + size);
+    table = TimeCalibTable();
+    table.fLeadingCorrections.assign(leading, leading + size);
+    table.fTrailingCorrections.assign(trailing, trailing + size);
+    table.fValid.assign(flags, flags + size);
+    table.fNumOfChannels = std::count(flags, flags + size, 1);
+  } else {
+    WARNING("Time calibration cache " + cacheFile + " does not match the calibration file, setup or run, it is not used");
+  }
+  munmap(mapped, fileSize);
+  return valid;
+}
+
+bool TimeCalibTools::saveTimeCalibCache(const std::string& cacheFile, uint64_t calibFileHash,
+                                        uint64_t setupFileHash, int runId, const TimeCalibTable& table)
+{
+  TimeCalibCacheHeader header;
+  std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.calibFileHash = calibFileHash;
+  header.setupFileHash = setupFileHash;
+  header.runId = runId;
+  header.tableSize = table.fValid.size();
+  std::vector<char> flags(table.fValid.begin(), table.fValid.end());
+
+  const std::string tmpFile = cacheFile + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream output(tmpFile, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(table.fLeadingCorrections.data()), header.tableSize * sizeof(float));
+    output.write(reinterpret_cast<const char*>(table.fTrailingCorrections.data()), header.tableSize * sizeof(float));
+    output.write(flags.data(), flags.size());
+    if (!output) {
+      ERROR("Could not write the time calibration cache:" + tmpFile);
+      std::remove(tmpFile.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+    ERROR("Could not create the time calibration cache:" + cacheFile);
+    std::remove(tmpFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+uint64_t TimeCalibTools::hashFile(const std::string& fileName)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  if (!input) {
+    return 0;
+  }
+  uint64_t hash = 14695981039346656037ULL;
+  char buffer[4096];
+  while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+    for (std::streamsize i = 0; i < input.gcount(); i++) {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
 std::vector<TimeCalibRecord> TimeCalibTools::readCalibrationRecordsFromFile(const std::string& calibFile)
 {
   using namespace std;
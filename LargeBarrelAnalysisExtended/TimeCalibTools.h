@@ -17,9 +17,14 @@
 #ifndef TIMECALIBTOOLS_H
 #define TIMECALIBTOOLS_H
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 #include "../j-pet-framework/JPetPM/JPetPM.h" /// for JPetPM::Side
+#include "../j-pet-framework/JPetSigCh/JPetSigCh.h"
+
+class SigChBuffer;
 
 /// POD helper structure that stores time calibration parameters for one element.
 /// It is not initialized by default!!! User is responsible for the proper initialization.
@@ -35,6 +40,36 @@ struct TimeCalibRecord {
   double quality; /// -1 to not set
 };
 
+/// Time corrections stored in arrays indexed by the TOMB channel number.
+/// The corrections are kept in ps, ready to be added to the Signal Channel times.
+/// Channels without calibration have zero corrections and are marked
+/// in the validity bitmap, so applying the corrections needs no lookups.
+/// The trailing edges are corrected with the sum of the leading and trailing offsets,
+/// so a calibration with zero trailing offsets shifts both edges in the same way.
+class TimeCalibTable
+{
+public:
+  /// Offsets are given in ns, as in the calibration files.
+  void setCorrection(unsigned int channel, double leadingOffset, double trailingOffset);
+  bool isValid(unsigned int channel) const;
+  /// Correction in ps for the edge of a given type, 0 if the channel is not calibrated.
+  float getCorrection(unsigned int channel, JPetSigCh::EdgeType type) const;
+  /// Number of calibrated channels.
+  std::size_t getNumOfChannels() const;
+  bool empty() const;
+  /// Corrects the times of the Signal Channels in [begin, end),
+  /// the channel is taken from JPetSigCh::getDAQch().
+  void applyCorrections(JPetSigCh* begin, JPetSigCh* end) const;
+  void applyCorrections(SigChBuffer& buffer) const;
+
+private:
+  friend class TimeCalibTools; /// for the cache reading and writing
+  std::vector<float> fLeadingCorrections;
+  std::vector<float> fTrailingCorrections;
+  std::vector<bool> fValid;
+  std::size_t fNumOfChannels = 0;
+};
+
 class TimeCalibTools
 {
 public:
@@ -45,6 +80,24 @@ public:
   /// Main method to be used to load the time calibration parameters.
   /// tombMap contains the dependency between layer, barrel slot, PM side, threshold and TOMB channel number.
   static TOMBChToCorrection loadTimeCalibration(const std::string& calibFile, const TOMBChMap& tombMap);
+  /// Versions of the above methods giving the flat calibration table with the leading and trailing corrections.
+  static TimeCalibTable loadTimeCalibTable(const std::string& calibFile, const TOMBChMap& tombMap);
+  static TimeCalibTable generateTimeCalibTable(const std::vector<TimeCalibRecord>& calibRecords,  const TimeCalibTools::TOMBChMap& tombMap);
+  /// Binary cache of the calibration table, so the jobs using the same calibration file
+  /// and setup do not have to parse the file and build the TOMB map again.
+  /// The cache file is read with mmap. It is valid only for the calibration file hash,
+  /// the setup file hash (the TOMB mapping comes from the setup) and the run id
+  /// stored in its header, otherwise it is ignored.
+  static std::string getTimeCalibCacheFileName(const std::string& cacheDir, uint64_t calibFileHash,
+      uint64_t setupFileHash, int runId);
+  static bool loadTimeCalibCache(const std::string& cacheFile, uint64_t calibFileHash,
+                                 uint64_t setupFileHash, int runId, TimeCalibTable& table);
+  /// The file is written under a temporary name and renamed, so the concurrent jobs
+  /// never see a partially written cache.
+  static bool saveTimeCalibCache(const std::string& cacheFile, uint64_t calibFileHash,
+                                 uint64_t setupFileHash, int runId, const TimeCalibTable& table);
+  /// 64-bit FNV-1a hash of the file content, 0 if the file can not be read.
+  static uint64_t hashFile(const std::string& fileName);
   /// Method generates a dependedce map between TOMB channel numbers and calibration corrections.
   /// tombMap contains the dependency between layer, barrel slot, PM side, threshold and TOMB channel number.
   /// calibRecords contains the calibration parameters.
@@ -0,0 +1,121 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file TimeCalibToolsBenchmark.cpp
+ *  @brief Microbenchmark of the time calibration of the Signal Channels, in ns per Signal Channel.
+ *
+ *  Compares the corrections looked up in the map with getTimeCalibCorrection,
+ *  as done by the TimeCalibLoader before, with the TimeCalibTable applied
+ *  to the JPetSigCh objects and to the SigChBuffer, for growing numbers
+ *  of calibrated channels. The Signal Channels of one time window come
+ *  from randomly chosen channels.
+ *  Usage: TimeCalibToolsBenchmark.x [--filter <text>] [--min-time <s>] [--repetitions <n>] [--csv]
+ */
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include "BenchmarkTools.h"
+#include "SigChBuffer.h"
+#include "TimeCalibTools.h"
+
+namespace
+{
+
+const int kNumOfSigChs = 10000;
+/// the big barrel has 1536 channels read out on 4 thresholds
+const std::vector<long long> kNumOfChannels = {64, 384, 1536, 6144};
+
+struct Calibration {
+  TimeCalibTools::TOMBChToCorrection map;
+  TimeCalibTable table;
+};
+
+/// Leading and trailing offsets in ns, as in the calibration files.
+Calibration generateCalibration(int numOfChannels)
+{
+  std::mt19937 generator(2017);
+  std::normal_distribution<double> offset(0., 2.);
+  Calibration calibration;
+  for (int channel = 0; channel < numOfChannels; channel++) {
+    double leadingOffset = offset(generator);
+    calibration.map[channel] = leadingOffset;
+    calibration.table.setCorrection(channel, leadingOffset, 0.);
+  }
+  return calibration;
+}
+
+std::vector<JPetSigCh> generateSigChs(int numOfChannels)
+{
+  std::mt19937 generator(2017);
+  std::uniform_int_distribution<int> channel(0, numOfChannels - 1);
+  std::uniform_real_distribution<double> time(-20000000., 0.);
+  std::vector<JPetSigCh> sigChs;
+  for (int i = 0; i < kNumOfSigChs; i++) {
+    JPetSigCh sigCh(i % 2 == 0 ? JPetSigCh::Leading : JPetSigCh::Trailing, time(generator));
+    sigCh.setDAQch(channel(generator));
+    sigChs.push_back(sigCh);
+  }
+  return sigChs;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  BenchmarkRunner runner(argc, argv);
+
+  runner.run("getTimeCalibCorrection/map", kNumOfChannels, [](BenchmarkState & state) {
+    auto calibration = generateCalibration(state.getParameter());
+    auto sigChs = generateSigChs(state.getParameter());
+    state.setObjectsPerIteration(sigChs.size());
+    while (state.keepRunning()) {
+      for (auto& sigCh : sigChs) {
+        sigCh.setValue(sigCh.getValue() + 1000. * TimeCalibTools::getTimeCalibCorrection(calibration.map, sigCh.getDAQch()));
+      }
+      doNotOptimize(sigChs);
+    }
+  });
+  runner.run("TimeCalibTable::getCorrection", kNumOfChannels, [](BenchmarkState & state) {
+    auto calibration = generateCalibration(state.getParameter());
+    auto sigChs = generateSigChs(state.getParameter());
+    state.setObjectsPerIteration(sigChs.size());
+    while (state.keepRunning()) {
+      for (auto& sigCh : sigChs) {
+        sigCh.setValue(sigCh.getValue() + calibration.table.getCorrection(sigCh.getDAQch(), sigCh.getType()));
+      }
+      doNotOptimize(sigChs);
+    }
+  });
+  runner.run("TimeCalibTable::applyCorrections/sigChs", kNumOfChannels, [](BenchmarkState & state) {
+    auto calibration = generateCalibration(state.getParameter());
+    auto sigChs = generateSigChs(state.getParameter());
+    state.setObjectsPerIteration(sigChs.size());
+    while (state.keepRunning()) {
+      calibration.table.applyCorrections(sigChs.data(), sigChs.data() + sigChs.size());
+      doNotOptimize(sigChs);
+    }
+  });
+  runner.run("TimeCalibTable::applyCorrections/buffer", kNumOfChannels, [](BenchmarkState & state) {
+    auto calibration = generateCalibration(state.getParameter());
+    SigChBuffer buffer;
+    for (const auto& sigCh : generateSigChs(state.getParameter())) {
+      buffer.add(sigCh.getDAQch(), sigCh.getType(), sigCh.getThresholdNumber(), sigCh.getValue());
+    }
+    state.setObjectsPerIteration(buffer.size());
+    while (state.keepRunning()) {
+      calibration.table.applyCorrections(buffer);
+      doNotOptimize(buffer.getValues());
+    }
+  });
+  return 0;
+}
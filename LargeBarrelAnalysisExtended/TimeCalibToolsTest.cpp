@@ -2,7 +2,10 @@
 #define BOOST_TEST_MODULE TimeCalibTools
 #include <boost/test/unit_test.hpp>
 
+#include <cstdio>
+#include <fstream>
 #include "TimeCalibTools.h"
+#include "SigChBuffer.h"
 
 
 struct myFixtures {
@@ -295,4 +298,136 @@ BOOST_FIXTURE_TEST_CASE (generateTimeCalibration, myFixtures )
   BOOST_REQUIRE_CLOSE(calibration.at(73), -3, epsilon);
 }
 
+BOOST_AUTO_TEST_CASE (timeCalibTable)
+{
+  TimeCalibTable table;
+  BOOST_REQUIRE(table.empty());
+  BOOST_REQUIRE(!table.isValid(0));
+  table.setCorrection(5, 1.5, 0.25);
+  table.setCorrection(2, -1., 0.);
+  BOOST_REQUIRE(!table.empty());
+  BOOST_REQUIRE_EQUAL(table.getNumOfChannels(), 2u);
+  BOOST_REQUIRE(table.isValid(2));
+  BOOST_REQUIRE(table.isValid(5));
+  BOOST_REQUIRE(!table.isValid(3));
+  BOOST_REQUIRE(!table.isValid(100));
+  auto epsilon = 0.0001;
+  BOOST_REQUIRE_CLOSE(table.getCorrection(5, JPetSigCh::Leading), 1500., epsilon);
+  BOOST_REQUIRE_CLOSE(table.getCorrection(5, JPetSigCh::Trailing), 1750., epsilon);
+  BOOST_REQUIRE_CLOSE(table.getCorrection(2, JPetSigCh::Trailing), -1000., epsilon);
+  BOOST_REQUIRE_EQUAL(table.getCorrection(3, JPetSigCh::Leading), 0.f);
+  BOOST_REQUIRE_EQUAL(table.getCorrection(100, JPetSigCh::Leading), 0.f);
+  /// setting the same channel again does not change the number of channels
+  table.setCorrection(5, 1., 0.);
+  BOOST_REQUIRE_EQUAL(table.getNumOfChannels(), 2u);
+  BOOST_REQUIRE_CLOSE(table.getCorrection(5, JPetSigCh::Trailing), 1000., epsilon);
+}
+
+BOOST_FIXTURE_TEST_CASE (generateTimeCalibTable, myFixtures )
+{
+  auto epsilon = 0.0001;
+  fCorrectRecords.at(0).offset_value_trailing = 0.5;
+  auto table = TimeCalibTools::generateTimeCalibTable(fCorrectRecords, fCorrectTombMap);
+  auto calibration = TimeCalibTools::generateTimeCalibration(fCorrectRecords, fCorrectTombMap);
+  BOOST_REQUIRE_EQUAL(table.getNumOfChannels(), calibration.size());
+  for (const auto& channelCorrection : calibration) {
+    BOOST_REQUIRE(table.isValid(channelCorrection.first));
+    BOOST_REQUIRE_CLOSE(table.getCorrection(channelCorrection.first, JPetSigCh::Leading), 1000. * channelCorrection.second, epsilon);
+  }
+  BOOST_REQUIRE_CLOSE(table.getCorrection(22, JPetSigCh::Trailing), 7500., epsilon);
+  BOOST_REQUIRE_CLOSE(table.getCorrection(13, JPetSigCh::Trailing), 5000., epsilon);
+}
+
+BOOST_AUTO_TEST_CASE (generateTimeCalibTable_wrongRecords)
+{
+  std::vector<TimeCalibRecord> records = {{4, 1, JPetPM::SideA, 1, 1.0, 0.0, 0.0, 0.0, 0.0}};
+  std::map<std::tuple<int, int, JPetPM::Side, int>, int> tombMap;
+  BOOST_REQUIRE(TimeCalibTools::generateTimeCalibTable(records, tombMap).empty());
+}
+
+BOOST_AUTO_TEST_CASE (applyCorrections)
+{
+  TimeCalibTable table;
+  table.setCorrection(1, 2., 0.5);
+  table.setCorrection(3, -1., 0.);
+  std::vector<JPetSigCh> sigChs = {JPetSigCh(JPetSigCh::Leading, 100.), JPetSigCh(JPetSigCh::Trailing, 200.),
+                                   JPetSigCh(JPetSigCh::Leading, 300.), JPetSigCh(JPetSigCh::Trailing, 400.)
+                                  };
+  sigChs.at(0).setDAQch(1);
+  sigChs.at(1).setDAQch(1);
+  sigChs.at(2).setDAQch(3);
+  sigChs.at(3).setDAQch(7); /// not calibrated
+  SigChBuffer buffer;
+  for (const auto& sigCh : sigChs) {
+    buffer.add(sigCh.getDAQch(), sigCh.getType(), 1, sigCh.getValue());
+  }
+  table.applyCorrections(sigChs.data(), sigChs.data() + sigChs.size());
+  table.applyCorrections(buffer);
+  auto epsilon = 0.0001;
+  BOOST_REQUIRE_CLOSE(sigChs.at(0).getValue(), 2100., epsilon);
+  BOOST_REQUIRE_CLOSE(sigChs.at(1).getValue(), 2700., epsilon);
+  BOOST_REQUIRE_CLOSE(sigChs.at(2).getValue(), -700., epsilon);
+  BOOST_REQUIRE_CLOSE(sigChs.at(3).getValue(), 400., epsilon);
+  for (std::size_t i = 0; i < sigChs.size(); i++) {
+    BOOST_REQUIRE_EQUAL(buffer.getValue(i), sigChs.at(i).getValue());
+  }
+}
+
+BOOST_AUTO_TEST_CASE (hashFile)
+{
+  BOOST_REQUIRE_EQUAL(TimeCalibTools::hashFile("blabal.txt"), 0u);
+  const std::string fileName = "timeCalibHashTest.txt";
+  {
+    std::ofstream file(fileName);
+    file << "1 1 A 1 0.5 0 0 0 0\n";
+  }
+  auto hash = TimeCalibTools::hashFile(fileName);
+  BOOST_REQUIRE(hash != 0u);
+  BOOST_REQUIRE_EQUAL(TimeCalibTools::hashFile(fileName), hash);
+  {
+    std::ofstream file(fileName);
+    file << "1 1 A 1 0.6 0 0 0 0\n";
+  }
+  BOOST_REQUIRE(TimeCalibTools::hashFile(fileName) != hash);
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE (timeCalibCache)
+{
+  TimeCalibTable table;
+  table.setCorrection(3, 1.5, 0.25);
+  table.setCorrection(70, -2., 0.);
+  const uint64_t hash = 12345;
+  const uint64_t setupHash = 678;
+  const int runId = 4;
+  auto cacheFile = TimeCalibTools::getTimeCalibCacheFileName("", hash, setupHash, runId);
+  BOOST_REQUIRE(cacheFile != TimeCalibTools::getTimeCalibCacheFileName("", hash, setupHash + 1, runId));
+  BOOST_REQUIRE(TimeCalibTools::saveTimeCalibCache(cacheFile, hash, setupHash, runId, table));
+
+  TimeCalibTable loaded;
+  BOOST_REQUIRE(TimeCalibTools::loadTimeCalibCache(cacheFile, hash, setupHash, runId, loaded));
+  BOOST_REQUIRE_EQUAL(loaded.getNumOfChannels(), 2u);
+  for (unsigned int channel = 0; channel < 100; channel++) {
+    BOOST_REQUIRE_EQUAL(loaded.isValid(channel), table.isValid(channel));
+    BOOST_REQUIRE_EQUAL(loaded.getCorrection(channel, JPetSigCh::Leading), table.getCorrection(channel, JPetSigCh::Leading));
+    BOOST_REQUIRE_EQUAL(loaded.getCorrection(channel, JPetSigCh::Trailing), table.getCorrection(channel, JPetSigCh::Trailing));
+  }
+
+  /// the cache of other calibration file, setup or run is not used
+  TimeCalibTable other;
+  BOOST_REQUIRE(!TimeCalibTools::loadTimeCalibCache(cacheFile, hash + 1, setupHash, runId, other));
+  BOOST_REQUIRE(!TimeCalibTools::loadTimeCalibCache(cacheFile, hash, setupHash + 1, runId, other));
+  BOOST_REQUIRE(!TimeCalibTools::loadTimeCalibCache(cacheFile, hash, setupHash, runId + 1, other));
+  BOOST_REQUIRE(other.empty());
+  BOOST_REQUIRE(!TimeCalibTools::loadTimeCalibCache("blabal.bin", hash, setupHash, runId, other));
+
+  /// truncated file is not used
+  {
+    std::ofstream file(cacheFile, std::ios::binary | std::ios::app);
+    file << "x";
+  }
+  BOOST_REQUIRE(!TimeCalibTools::loadTimeCalibCache(cacheFile, hash, setupHash, runId, other));
+  std::remove(cacheFile.c_str());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,10 +14,11 @@
  */
 #include <Unpacker2/Unpacker2/EventIII.h>
 #include <JPetWriter/JPetWriter.h>
+#include <algorithm>
 #include "TimeWindowCreator.h"
 
 TimeWindowCreator::TimeWindowCreator(const char* name, const char* description):
-  JPetTask(name, description) {}
+  PipelineStage(name, description) {}
 
 void TimeWindowCreator::init(const JPetTaskInterface::Options& opts)
 {
@@ -28,8 +29,67 @@ void TimeWindowCreator::init(const JPetTaskInterface::Options& opts)
   if (opts.count(kMinTimeParamKey)) {
     fMinTime = std::atof(opts.at(kMinTimeParamKey).c_str());
   }
-  getStatistics().createHistogram( new TH1F("HitsPerEvtCh", "Hits per channel in one event", 50, -0.5, 49.5) );
-  getStatistics().createHistogram( new TH1F("ChannelsPerEvt", "Channels fired in one event", 200, -0.5, 199.5) );
+  if (opts.count(kCompactSigChsParamKey) && opts.at(kCompactSigChsParamKey) == "true") {
+    /// the compact buffer has no dictionary, so it can not be saved
+    if (fWriter) {
+      WARNING("The output of TimeWindowCreator is saved, the compact Signal Channels are not used.");
+    } else {
+      fCompactSigChs = true;
+    }
+  }
+  fHitsPerEvtCh = registerHistogram(getStatistics(),
+                                    new TH1F("HitsPerEvtCh", "Hits per channel in one event", 50, -0.5, 49.5) );
+  fChannelsPerEvt = registerHistogram(getStatistics(),
+                                      new TH1F("ChannelsPerEvt", "Channels fired in one event", 200, -0.5, 199.5) );
+  buildChannelTable();
+}
+
+/// The table covers the channels up to the highest one of the setup,
+/// the channels found in data outside of it are handled in exec()
+void TimeWindowCreator::buildChannelTable()
+{
+  const auto& tombChannels = getParamBank().getTOMBChannels();
+  std::size_t size = 0;
+  for (const auto& tombChannel : tombChannels) {
+    size = std::max(size, static_cast<std::size_t>(tombChannel.first) + 1);
+  }
+  fChannelStatus.assign(size, kUnknownChannel);
+  fLeadingTemplates.assign(size, JPetSigCh());
+  fTrailingTemplates.assign(size, JPetSigCh());
+  fUnknownChannelCounts.assign(size, 0);
+  for (std::size_t channel = 0; channel < size; channel++) {
+    if (channel % 65 == 0) { // trigger signals from TRB
+      fChannelStatus[channel] = kTriggerChannel;
+      continue;
+    }
+    auto tombChannel = tombChannels.find(channel);
+    if (tombChannel != tombChannels.end()) {
+      fChannelStatus[channel] = kValidChannel;
+      fLeadingTemplates[channel] = generateSigCh(*tombChannel->second, JPetSigCh::Leading);
+      fTrailingTemplates[channel] = generateSigCh(*tombChannel->second, JPetSigCh::Trailing);
+    }
+  }
+}
+
+/// The warning is repeated for the 10th, 100th, 1000th... occurrence of the channel
+/// The channels outside of the table (negative or above the setup ones) are counted separately
+void TimeWindowCreator::reportUnknownChannel(int channel)
+{
+  unsigned long& counter = isInChannelTable(channel) ?
+                           fUnknownChannelCounts[channel] : fOutOfRangeChannelCounts[channel];
+  unsigned long count = ++counter;
+  while (count % 10 == 0) {
+    count /= 10;
+  }
+  if (count == 1) {
+    WARNING(Form("DAQ Channel %d appears in data but does not exist in the setup from DB (%lu times so far).",
+                 channel, counter));
+  }
+}
+
+bool TimeWindowCreator::isInChannelTable(int channel) const
+{
+  return channel >= 0 && static_cast<std::size_t>(channel) < fChannelStatus.size();
 }
 
 TimeWindowCreator::~TimeWindowCreator() {}
@@ -41,27 +101,36 @@ void TimeWindowCreator::exec()
   // all get-methods aren't tagged with const modifier
   if (auto evt = dynamic_cast </*const*/ EventIII * const > (getEvent())) {
     int ntdc = evt->GetTotalNTDCChannels();
-    getStatistics().getHisto1D("ChannelsPerEvt").Fill( ntdc );
+    fChannelsPerEvt->Fill( ntdc );
     JPetTimeWindow tslot;
     tslot.setIndex(fCurrEventNumber);
+    SigChBuffer buffer;
+    buffer.setIndex(fCurrEventNumber);
     auto tdcHits = evt->GetTDCChannelsArray();
     for (int i = 0; i < ntdc; ++i) {
       //const is commented because this class has inproper architecture:
       // all get-methods aren't tagged with const modifier
       auto tdcChannel = dynamic_cast </*const*/ TDCChannel * const > (tdcHits->At(i));
       auto tomb_number =  tdcChannel->GetChannel();
-      if (tomb_number % 65 == 0) { // skip trigger signals from TRB
+      if (!isInChannelTable(tomb_number)) {
+        if (tomb_number % 65 != 0) { // skip trigger signals from TRB
+          reportUnknownChannel(tomb_number);
+        }
         continue;
       }
-      if ( getParamBank().getTOMBChannels().count(tomb_number) == 0 ) {
-        WARNING(Form("DAQ Channel %d appears in data but does not exist in the setup from DB.", tomb_number));
+      if (fChannelStatus[tomb_number] == kTriggerChannel) { // skip trigger signals from TRB
         continue;
       }
-      JPetTOMBChannel& tomb_channel = getParamBank().getTOMBChannel(tomb_number);
+      if (fChannelStatus[tomb_number] == kUnknownChannel) {
+        reportUnknownChannel(tomb_number);
+        continue;
+      }
+      const JPetSigCh& leadingTemplate = fLeadingTemplates[tomb_number];
+      const JPetSigCh& trailingTemplate = fTrailingTemplates[tomb_number];
       // one TDC channel may record multiple signals in one TSlot
       // iterate over all signals from one TDC channel
       // analyze number of hits per channel
-      getStatistics().getHisto1D("HitsPerEvtCh").Fill( tdcChannel->GetHitsNum() );
+      fHitsPerEvtCh->Fill( tdcChannel->GetHitsNum() );
       const int kNumHits = tdcChannel->GetHitsNum();
       for (int j = 0; j < kNumHits; ++j) {
 
@@ -74,8 +143,16 @@ void TimeWindowCreator::exec()
         if ( tdcChannel->GetTrailTime(j) > fMaxTime ||
              tdcChannel->GetTrailTime(j) < fMinTime )continue;
 
-        JPetSigCh sigChTmpLead = generateSigCh(tomb_channel, JPetSigCh::Leading);
-        JPetSigCh sigChTmpTrail = generateSigCh(tomb_channel, JPetSigCh::Trailing);
+        // the times are set in ps [raw times are in ns]
+        if (fCompactSigChs) {
+          const int thresholdNumber = leadingTemplate.getThresholdNumber();
+          buffer.add(tomb_number, JPetSigCh::Leading, thresholdNumber, tdcChannel->GetLeadTime(j) * 1000.);
+          buffer.add(tomb_number, JPetSigCh::Trailing, thresholdNumber, tdcChannel->GetTrailTime(j) * 1000.);
+          continue;
+        }
+
+        JPetSigCh sigChTmpLead = leadingTemplate;
+        JPetSigCh sigChTmpTrail = trailingTemplate;
 
         // finally, set the times in ps [raw times are in ns]
         sigChTmpLead.setValue(tdcChannel->GetLeadTime(j) * 1000.);
@@ -84,22 +161,32 @@ void TimeWindowCreator::exec()
         tslot.addCh(sigChTmpTrail);
       }
     }
-    saveTimeWindow(tslot);
+    if (fCompactSigChs) {
+      forward(buffer);
+    } else {
+      saveTimeWindow(tslot);
+    }
     fCurrEventNumber++;
   }
 }
 
-void TimeWindowCreator::terminate() {}
-
-void TimeWindowCreator::saveTimeWindow(const JPetTimeWindow& slot)
+void TimeWindowCreator::terminate()
 {
-  assert(fWriter);
-  fWriter->write(slot);
+  for (const auto& outOfRangeChannel : fOutOfRangeChannelCounts) {
+    WARNING(Form("DAQ Channel %d not existing in the setup from DB appeared in data %lu times.",
+                 outOfRangeChannel.first, outOfRangeChannel.second));
+  }
+  for (std::size_t channel = 0; channel < fUnknownChannelCounts.size(); channel++) {
+    if (fUnknownChannelCounts[channel] > 0) {
+      WARNING(Form("DAQ Channel %d not existing in the setup from DB appeared in data %lu times.",
+                   static_cast<int>(channel), fUnknownChannelCounts[channel]));
+    }
+  }
 }
 
-void TimeWindowCreator::setWriter(JPetWriter* writer)
+void TimeWindowCreator::saveTimeWindow(const JPetTimeWindow& slot)
 {
-  fWriter = writer;
+  forward(slot);
 }
 
 void TimeWindowCreator::setParamManager(JPetParamManager* paramManager)
@@ -115,15 +202,6 @@ const JPetParamBank& TimeWindowCreator::getParamBank() const
 
 JPetSigCh TimeWindowCreator::generateSigCh(const JPetTOMBChannel& channel, JPetSigCh::EdgeType edge) const
 {
-  JPetSigCh sigch;
-  sigch.setDAQch(channel.getChannel());
-  sigch.setType(edge);
-  sigch.setThresholdNumber(channel.getLocalChannelNumber());
-  sigch.setThreshold(channel.getThreshold());
-  sigch.setPM(channel.getPM());
-  sigch.setFEB(channel.getFEB());
-  sigch.setTRB(channel.getTRB());
-  sigch.setTOMBChannel(channel);
-  return sigch;
+  return SigChBuffer::createSigCh(channel, edge);
 }
 
@@ -16,13 +16,15 @@
 #ifndef TimeWindowCreator_H
 #define TimeWindowCreator_H
 
-#include <JPetTask/JPetTask.h>
+#include <map>
+#include <vector>
 #include <JPetTimeWindow/JPetTimeWindow.h>
 #include <JPetParamBank/JPetParamBank.h>
 #include <JPetParamManager/JPetParamManager.h>
 #include <JPetTOMBChannel/JPetTOMBChannel.h>
-
-class JPetWriter;
+#include "PipelineStage.h"
+#include "SigChBuffer.h"
+#include "HistogramHandles.h"
 
 #ifdef __CINT__
 //when cint is used instead of compiler, override word is not recognized
@@ -32,8 +34,11 @@ class JPetWriter;
 
 /// Task to translate EventIII Unpacker data to JPetTimeWindow.
 /// Also, some basic filtering can be done
+/// With the user option "TimeWindowCreator_CompactSigChs":"true" the task
+/// produces SigChBuffer objects instead, which are understood by the
+/// TimeCalibLoader and the SignalFinder run in the same FusedPipeline.
 
-class TimeWindowCreator: public JPetTask
+class TimeWindowCreator: public PipelineStage
 {
 public:
   TimeWindowCreator(const char* name, const char* description);
@@ -41,20 +46,35 @@ public:
   virtual void init(const JPetTaskInterface::Options& opts) override;
   virtual void exec() override;
   virtual void terminate() override;
-  virtual void setWriter(JPetWriter* writer) override;
   virtual void setParamManager(JPetParamManager* paramManager) override;
   const JPetParamBank& getParamBank() const;
 
 protected:
   void saveTimeWindow(const JPetTimeWindow& slot);
   JPetSigCh generateSigCh(const JPetTOMBChannel& channel, JPetSigCh::EdgeType edge) const;
-  JPetWriter* fWriter = nullptr;
+  void buildChannelTable();
+  bool isInChannelTable(int channel) const;
+  void reportUnknownChannel(int channel);
   JPetParamManager* fParamManager = nullptr;
   long long int fCurrEventNumber = 0;
   const std::string kMaxTimeParamKey = "TimeWindowCreator_MaxTime";
   const std::string kMinTimeParamKey = "TimeWindowCreator_MinTime";
+  const std::string kCompactSigChsParamKey = "TimeWindowCreator_CompactSigChs";
+  bool fCompactSigChs = false;
+  /// Lookup table indexed by the DAQ channel number, built in init()
+  /// from the TOMB channels of the setup. Valid channels have the templates
+  /// of the Signal Channels with all the parametric objects already set.
+  enum ChannelStatus { kUnknownChannel, kTriggerChannel, kValidChannel };
+  std::vector<char> fChannelStatus;
+  std::vector<JPetSigCh> fLeadingTemplates;
+  std::vector<JPetSigCh> fTrailingTemplates;
+  std::vector<unsigned long> fUnknownChannelCounts;
+  /// counts of the channels outside of the table, which can not index it
+  std::map<int, unsigned long> fOutOfRangeChannelCounts;
   double fMaxTime = 0.;
   double fMinTime = -1.e6;
+  TH1F* fHitsPerEvtCh = nullptr;
+  TH1F* fChannelsPerEvt = nullptr;
 };
 
 #endif /*  !TimeWindowCreator_H */
@@ -0,0 +1,142 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file VelocityCalibTools.cpp
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include "VelocityCalibTools.h"
+#include "JPetLoggerInclude.h"
+
+const int VelocityCalibTable::kNumOfThresholds;
+
+void VelocityCalibTable::setVelocity(int slot, int threshold, double velocity, double uncertainty)
+{
+  if (slot < 0 || threshold < 1 || threshold > kNumOfThresholds) {
+    return;
+  }
+  std::size_t index = slot * kNumOfThresholds + threshold - 1;
+  if (index >= fValid.size()) {
+    std::size_t size = (slot + 1) * kNumOfThresholds;
+    fVelocities.resize(size, 0.);
+    fUncertainties.resize(size, -1.);
+    fValid.resize(size, false);
+  }
+  if (!fValid[index]) {
+    fNumOfEntries++;
+  }
+  fVelocities[index] = velocity;
+  fUncertainties[index] = uncertainty;
+  fValid[index] = true;
+}
+
+int VelocityCalibTable::getIndex(int slot, int threshold) const
+{
+  if (slot < 0 || threshold < 1 || threshold > kNumOfThresholds) {
+    return -1;
+  }
+  std::size_t index = slot * kNumOfThresholds + threshold - 1;
+  return index < fValid.size() ? index : -1;
+}
+
+bool VelocityCalibTable::isValid(int slot, int threshold) const
+{
+  int index = getIndex(slot, threshold);
+  return index >= 0 && fValid[index];
+}
+
+double VelocityCalibTable::getVelocity(int slot, int threshold) const
+{
+  int index = getIndex(slot, threshold);
+  return index >= 0 ? fVelocities[index] : 0.;
+}
+
+double VelocityCalibTable::getUncertainty(int slot, int threshold) const
+{
+  int index = getIndex(slot, threshold);
+  return index >= 0 ? fUncertainties[index] : -1.;
+}
+
+std::size_t VelocityCalibTable::getNumOfEntries() const
+{
+  return fNumOfEntries;
+}
+
+bool VelocityCalibTable::empty() const
+{
+  return fNumOfEntries == 0;
+}
+
+VelocityCalibTable VelocityCalibTools::loadVelocities(const std::string& velocityFile)
+{
+  VelocityCalibTable table;
+  std::ifstream input(velocityFile, std::ios::binary);
+  if (!input.is_open()) {
+    ERROR("Velocity calibration file does not exist:" + velocityFile + " Returning empty velocity calibration");
+    return table;
+  }
+  /// the whole file is read at once and parsed in place
+  std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  if (content.empty() || content.back() != '\n') {
+    content.push_back('\n');
+  }
+  std::size_t lineBegin = 0;
+  while (lineBegin < content.size()) {
+    std::size_t lineEnd = content.find('\n', lineBegin);
+    content[lineEnd] = '\0';
+    const char* line = content.c_str() + lineBegin;
+    while (std::isspace(static_cast<unsigned char>(*line))) {
+      line++;
+    }
+    if (*line != '\0' && *line != '#' && !fillVelocities(line, table)) {
+      ERROR("Line from the velocity calibration file seems to be incorrect:" + std::string(line));
+    }
+    lineBegin = lineEnd + 1;
+  }
+  return table;
+}
+
+bool VelocityCalibTools::fillVelocities(const char* line, VelocityCalibTable& table)
+{
+  char* end = nullptr;
+  long slot = std::strtol(line, &end, 10);
+  if (end == line || slot < 0) {
+    return false;
+  }
+  double values[2 * VelocityCalibTable::kNumOfThresholds];
+  int numOfValues = 0;
+  const char* current = end;
+  while (true) {
+    double value = std::strtod(current, &end);
+    if (end == current) {
+      break;
+    }
+    if (numOfValues == 2 * VelocityCalibTable::kNumOfThresholds) {
+      return false;
+    }
+    values[numOfValues++] = value;
+    current = end;
+  }
+  while (std::isspace(static_cast<unsigned char>(*current))) {
+    current++;
+  }
+  if (*current != '\0' || numOfValues == 0 || numOfValues % 2 != 0) {
+    return false;
+  }
+  for (int i = 0; i < numOfValues / 2; i++) {
+    table.setVelocity(slot, i + 1, values[2 * i], values[2 * i + 1]);
+  }
+  return true;
+}
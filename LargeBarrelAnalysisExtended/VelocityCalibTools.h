@@ -0,0 +1,66 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file VelocityCalibTools.h
+ *  @brief Effective light velocities in the scintillators used to reconstruct the hit position.
+ */
+
+#ifndef VELOCITYCALIBTOOLS_H
+#define VELOCITYCALIBTOOLS_H
+
+#include <string>
+#include <vector>
+
+/// Effective light velocities and their uncertainties, stored in flat arrays
+/// indexed by the barrel slot ID and the threshold number (1-4).
+class VelocityCalibTable
+{
+public:
+  static const int kNumOfThresholds = 4;
+
+  void setVelocity(int slot, int threshold, double velocity, double uncertainty);
+  bool isValid(int slot, int threshold) const;
+  /// Velocity for the slot and threshold, 0 if it is not set.
+  double getVelocity(int slot, int threshold) const;
+  /// Uncertainty of the velocity, -1 if it is not set.
+  double getUncertainty(int slot, int threshold) const;
+  /// Number of the slot and threshold combinations with a velocity.
+  std::size_t getNumOfEntries() const;
+  bool empty() const;
+
+private:
+  /// -1 for the combinations out of range
+  int getIndex(int slot, int threshold) const;
+  std::vector<double> fVelocities;
+  std::vector<double> fUncertainties;
+  std::vector<bool> fValid;
+  std::size_t fNumOfEntries = 0;
+};
+
+class VelocityCalibTools
+{
+public:
+  /// Reads the velocity calibration file. Each line contains the barrel slot ID
+  /// followed by the velocity and its uncertainty for the consecutive thresholds,
+  /// starting from the first one, e.g. for two thresholds:
+  /// 1 12.1 0.2 12.3 0.2
+  /// so the files with one threshold, like resultsForThresholda.txt, can be read as well.
+  /// Empty lines and lines starting with # are skipped, incorrect lines are reported and skipped.
+  /// If the file can not be opened an empty table is returned.
+  static VelocityCalibTable loadVelocities(const std::string& velocityFile);
+  /// Fills the table with the content of one line of the file, false if the line is incorrect.
+  static bool fillVelocities(const char* line, VelocityCalibTable& table);
+private:
+  VelocityCalibTools(const VelocityCalibTools&);
+  void operator=(const VelocityCalibTools&);
+};
+#endif /*  !VELOCITYCALIBTOOLS_H */
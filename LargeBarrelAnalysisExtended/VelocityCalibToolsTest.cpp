@@ -0,0 +1,84 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE VelocityCalibToolsTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include "VelocityCalibTools.h"
+
+void writeFile(const std::string& fileName, const std::string& content)
+{
+  std::ofstream file(fileName);
+  file << content;
+}
+
+BOOST_AUTO_TEST_SUITE(VelocityCalibToolsSuite)
+
+BOOST_AUTO_TEST_CASE(velocityCalibTable)
+{
+  VelocityCalibTable table;
+  BOOST_REQUIRE(table.empty());
+  BOOST_REQUIRE(!table.isValid(1, 1));
+  BOOST_REQUIRE_EQUAL(table.getVelocity(1, 1), 0.);
+  BOOST_REQUIRE_EQUAL(table.getUncertainty(1, 1), -1.);
+  table.setVelocity(1, 1, 12.5, 0.1);
+  table.setVelocity(96, 4, 11.5, 0.2);
+  table.setVelocity(96, 4, 11.7, 0.3);
+  table.setVelocity(2, 5, 11.5, 0.2);
+  table.setVelocity(2, 0, 11.5, 0.2);
+  table.setVelocity(-1, 1, 11.5, 0.2);
+  BOOST_REQUIRE_EQUAL(table.getNumOfEntries(), 2u);
+  BOOST_REQUIRE(table.isValid(1, 1));
+  BOOST_REQUIRE(!table.isValid(1, 2));
+  BOOST_REQUIRE(!table.isValid(96, 3));
+  BOOST_REQUIRE(!table.isValid(2, 5));
+  BOOST_REQUIRE(!table.isValid(200, 1));
+  BOOST_REQUIRE_EQUAL(table.getVelocity(1, 1), 12.5);
+  BOOST_REQUIRE_EQUAL(table.getUncertainty(1, 1), 0.1);
+  BOOST_REQUIRE_EQUAL(table.getVelocity(96, 4), 11.7);
+  BOOST_REQUIRE_EQUAL(table.getUncertainty(96, 4), 0.3);
+}
+
+BOOST_AUTO_TEST_CASE(fillVelocities)
+{
+  VelocityCalibTable table;
+  BOOST_REQUIRE(VelocityCalibTools::fillVelocities("3 12.1 0.2", table));
+  BOOST_REQUIRE(VelocityCalibTools::fillVelocities("4 12.1 0.2 12.3 0.3 12.5 0.4 12.7 0.5  \r", table));
+  BOOST_REQUIRE(!VelocityCalibTools::fillVelocities("5 12.1", table));
+  BOOST_REQUIRE(!VelocityCalibTools::fillVelocities("5 12.1 0.2 x", table));
+  BOOST_REQUIRE(!VelocityCalibTools::fillVelocities("5", table));
+  BOOST_REQUIRE(!VelocityCalibTools::fillVelocities("A 12.1 0.2", table));
+  BOOST_REQUIRE(!VelocityCalibTools::fillVelocities("5 1 1 2 2 3 3 4 4 5 5", table));
+  BOOST_REQUIRE_EQUAL(table.getNumOfEntries(), 5u);
+  BOOST_REQUIRE_EQUAL(table.getVelocity(3, 1), 12.1);
+  BOOST_REQUIRE(!table.isValid(3, 2));
+  BOOST_REQUIRE_EQUAL(table.getVelocity(4, 3), 12.5);
+  BOOST_REQUIRE_EQUAL(table.getUncertainty(4, 4), 0.5);
+  BOOST_REQUIRE(!table.isValid(5, 1));
+}
+
+BOOST_AUTO_TEST_CASE(loadVelocities_nonExistingFile)
+{
+  BOOST_REQUIRE(VelocityCalibTools::loadVelocities("blabal.txt").empty());
+}
+
+BOOST_AUTO_TEST_CASE(loadVelocities)
+{
+  const std::string fileName = "velocityCalibTest.txt";
+  /// the last line has no end of line character and must be read once
+  writeFile(fileName, "# slot vel err\n1 12.1 0.2\n\n2 12.3 0.3 12.4 0.4\nwrong line\n3 12.5 0.5");
+  auto table = VelocityCalibTools::loadVelocities(fileName);
+  BOOST_REQUIRE_EQUAL(table.getNumOfEntries(), 4u);
+  BOOST_REQUIRE_EQUAL(table.getVelocity(1, 1), 12.1);
+  BOOST_REQUIRE_EQUAL(table.getVelocity(2, 1), 12.3);
+  BOOST_REQUIRE_EQUAL(table.getVelocity(2, 2), 12.4);
+  BOOST_REQUIRE_EQUAL(table.getUncertainty(3, 1), 0.5);
+
+  writeFile(fileName, "1 12.1 0.2\n2 12.3 0.3\n");
+  table = VelocityCalibTools::loadVelocities(fileName);
+  BOOST_REQUIRE_EQUAL(table.getNumOfEntries(), 2u);
+  BOOST_REQUIRE(!table.isValid(0, 1));
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file WindowAccumulator.h
+ *  @brief Collects the objects of one time window for the tasks working on whole time windows.
+ */
+
+#ifndef WINDOWACCUMULATOR_H
+#define WINDOWACCUMULATOR_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Buffer of the objects coming from one time window.
+ *
+ * The objects are added one by one with the index of their time window.
+ * When an object of another time window comes, the collected window is
+ * passed to the flush function, and at the end of the stream finish()
+ * passes the last one, so no time window is lost. The buffer is reused,
+ * it does not release its memory between the windows.
+ *
+ * With an overlap margin the objects of the last overlapMargin of a window
+ * (measured from the latest object in it) are kept and passed again at the
+ * beginning of the next window, so the coincidences split by the window edge
+ * can be found. Their times must be shifted by getCarriedTimeOffset() to be
+ * compared with the times of the next window.
+ */
+template <class T>
+class WindowAccumulator
+{
+public:
+  typedef std::function<double(const T&)> TimeGetter;
+
+  /// overlapMargin and timeWindowLength are in the units of the times given by getTime.
+  void setOverlap(double overlapMargin, double timeWindowLength, const TimeGetter& getTime)
+  {
+    fOverlapMargin = overlapMargin;
+    fTimeWindowLength = timeWindowLength;
+    fGetTime = getTime;
+  }
+
+  /// Adds the object, first calling flush(getObjects()) if it comes from another time window.
+  template <class Flush>
+  void add(const T& object, int timeWindowIndex, const Flush& flush)
+  {
+    if (fObjects.size() > fNumOfCarried && timeWindowIndex != fTimeWindowIndex) {
+      flush(fObjects);
+      keepOverlap(timeWindowIndex);
+    }
+    fTimeWindowIndex = timeWindowIndex;
+    fObjects.push_back(object);
+  }
+
+  /// Flushes the last time window, to be called at the end of the stream.
+  template <class Flush>
+  void finish(const Flush& flush)
+  {
+    if (fObjects.size() > fNumOfCarried) {
+      flush(fObjects);
+    }
+    clear();
+  }
+
+  void clear()
+  {
+    fObjects.clear();
+    fNumOfCarried = 0;
+    fCarriedTimeOffset = 0.;
+  }
+
+  /// Objects carried over from the previous window come first.
+  const std::vector<T>& getObjects() const
+  {
+    return fObjects;
+  }
+
+  std::size_t getNumOfCarried() const
+  {
+    return fNumOfCarried;
+  }
+
+  /// Time to be added to the times of the carried objects.
+  double getCarriedTimeOffset() const
+  {
+    return fCarriedTimeOffset;
+  }
+
+  int getTimeWindowIndex() const
+  {
+    return fTimeWindowIndex;
+  }
+
+  bool empty() const
+  {
+    return fObjects.size() == fNumOfCarried;
+  }
+
+private:
+  /// Leaves in the buffer only the objects of the flushed window close to its end.
+  void keepOverlap(int nextTimeWindowIndex)
+  {
+    std::size_t kept = 0;
+    if (fOverlapMargin > 0. && fGetTime) {
+      double latest = fGetTime(fObjects[fNumOfCarried]);
+      for (std::size_t i = fNumOfCarried; i < fObjects.size(); i++) {
+        latest = std::max(latest, fGetTime(fObjects[i]));
+      }
+      for (std::size_t i = fNumOfCarried; i < fObjects.size(); i++) {
+        if (fGetTime(fObjects[i]) >= latest - fOverlapMargin) {
+          std::swap(fObjects[kept++], fObjects[i]);
+        }
+      }
+    }
+    fObjects.erase(fObjects.begin() + kept, fObjects.end());
+    fNumOfCarried = kept;
+    fCarriedTimeOffset = (fTimeWindowIndex - nextTimeWindowIndex) * fTimeWindowLength;
+  }
+
+  std::vector<T> fObjects;
+  std::size_t fNumOfCarried = 0;
+  double fCarriedTimeOffset = 0.;
+  int fTimeWindowIndex = 0;
+  double fOverlapMargin = 0.;
+  double fTimeWindowLength = 0.;
+  TimeGetter fGetTime;
+};
+
+#endif /*  !WINDOWACCUMULATOR_H */
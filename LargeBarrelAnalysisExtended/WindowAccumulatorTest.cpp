@@ -0,0 +1,88 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE WindowAccumulatorTest
+#include <boost/test/unit_test.hpp>
+
+#include <utility>
+#include "WindowAccumulator.h"
+
+/// time window index and time
+typedef std::pair<int, double> Object;
+typedef std::vector<std::vector<Object>> Windows;
+
+struct Collector {
+  explicit Collector(Windows& windows): fWindows(windows) {}
+  void operator()(const std::vector<Object>& objects) const
+  {
+    fWindows.push_back(objects);
+  }
+  Windows& fWindows;
+};
+
+void addAll(WindowAccumulator<Object>& accumulator, const std::vector<Object>& objects, Windows& windows)
+{
+  for (const auto& object : objects) {
+    accumulator.add(object, object.first, Collector(windows));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(WindowAccumulatorSuite)
+
+BOOST_AUTO_TEST_CASE(finish_empty)
+{
+  WindowAccumulator<Object> accumulator;
+  Windows windows;
+  BOOST_REQUIRE(accumulator.empty());
+  accumulator.finish(Collector(windows));
+  BOOST_REQUIRE(windows.empty());
+}
+
+BOOST_AUTO_TEST_CASE(flushesEveryWindow)
+{
+  WindowAccumulator<Object> accumulator;
+  Windows windows;
+  addAll(accumulator, {{1, 1.}, {1, 2.}, {2, 3.}, {4, 4.}, {4, 5.}}, windows);
+  BOOST_REQUIRE_EQUAL(windows.size(), 2u);
+  BOOST_REQUIRE_EQUAL(accumulator.getTimeWindowIndex(), 4);
+  BOOST_REQUIRE(!accumulator.empty());
+  /// the last window is not lost at the end of the stream
+  accumulator.finish(Collector(windows));
+  BOOST_REQUIRE(accumulator.empty());
+  BOOST_REQUIRE_EQUAL(windows.size(), 3u);
+  BOOST_REQUIRE(windows[0] == std::vector<Object>({{1, 1.}, {1, 2.}}));
+  BOOST_REQUIRE(windows[1] == std::vector<Object>({{2, 3.}}));
+  BOOST_REQUIRE(windows[2] == std::vector<Object>({{4, 4.}, {4, 5.}}));
+  accumulator.finish(Collector(windows));
+  BOOST_REQUIRE_EQUAL(windows.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(overlap)
+{
+  WindowAccumulator<Object> accumulator;
+  accumulator.setOverlap(10., 1000., [](const Object & object) {
+    return object.second;
+  });
+  Windows windows;
+  std::vector<std::size_t> numOfCarried;
+  std::vector<double> offsets;
+  auto collect = [&](const std::vector<Object>& objects) {
+    windows.push_back(objects);
+    numOfCarried.push_back(accumulator.getNumOfCarried());
+    offsets.push_back(accumulator.getCarriedTimeOffset());
+  };
+  for (const auto& object : std::vector<Object>({{1, 995.}, {1, 100.}, {1, 984.}, {1, 991.}, {2, 5.}, {2, 50.}, {4, 7.}})) {
+    accumulator.add(object, object.first, collect);
+  }
+  accumulator.finish(collect);
+  BOOST_REQUIRE_EQUAL(windows.size(), 3u);
+  BOOST_REQUIRE_EQUAL(numOfCarried[0], 0u);
+  /// objects within 10 from the latest one of the window 1 are carried over
+  BOOST_REQUIRE_EQUAL(numOfCarried[1], 2u);
+  BOOST_REQUIRE_EQUAL(offsets[1], -1000.);
+  BOOST_REQUIRE(windows[1] == std::vector<Object>({{1, 995.}, {1, 991.}, {2, 5.}, {2, 50.}}));
+  /// the carried objects are not carried again, the offset follows the window indices
+  BOOST_REQUIRE_EQUAL(numOfCarried[2], 1u);
+  BOOST_REQUIRE_EQUAL(offsets[2], -2000.);
+  BOOST_REQUIRE(windows[2] == std::vector<Object>({{2, 50.}, {4, 7.}}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
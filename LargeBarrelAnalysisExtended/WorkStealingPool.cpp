@@ -0,0 +1,116 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file WorkStealingPool.cpp
+ */
+
+#include <cassert>
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned int numOfThreads):
+  fQueuedTasks(0),
+  fSteals(0),
+  fNextQueue(0),
+  fStop(false)
+{
+  assert(numOfThreads > 0);
+  for (unsigned int i = 0; i < numOfThreads; i++) {
+    fQueues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue));
+  }
+  for (unsigned int i = 0; i < numOfThreads; i++) {
+    fThreads.push_back(std::thread(&WorkStealingPool::run, this, i));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(fWakeMutex);
+    fStop = true;
+  }
+  fWakeCondition.notify_all();
+  for (auto& thread : fThreads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(const Task& task)
+{
+  {
+    /// The counter is changed under the wake mutex so no worker misses the notification.
+    /// It is incremented before the task is queued, so it never drops below zero.
+    std::lock_guard<std::mutex> lock(fWakeMutex);
+    fQueuedTasks++;
+  }
+  auto& queue = *fQueues[fNextQueue++ % fQueues.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+  fWakeCondition.notify_one();
+}
+
+unsigned int WorkStealingPool::getNumOfThreads() const
+{
+  return fThreads.size();
+}
+
+unsigned long WorkStealingPool::getNumOfSteals() const
+{
+  return fSteals;
+}
+
+void WorkStealingPool::run(unsigned int workerIndex)
+{
+  Task task;
+  while (true) {
+    if (popOwn(workerIndex, task) || steal(workerIndex, task)) {
+      fQueuedTasks--;
+      task(workerIndex);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(fWakeMutex);
+    fWakeCondition.wait(lock, [this]() {
+      return fStop || fQueuedTasks > 0;
+    });
+    if (fStop && fQueuedTasks == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::popOwn(unsigned int workerIndex, Task& task)
+{
+  auto& queue = *fQueues[workerIndex];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.front());
+  queue.tasks.pop_front();
+  return true;
+}
+
+bool WorkStealingPool::steal(unsigned int workerIndex, Task& task)
+{
+  for (unsigned int i = 1; i < fQueues.size(); i++) {
+    auto& queue = *fQueues[(workerIndex + i) % fQueues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      fSteals++;
+      return true;
+    }
+  }
+  return false;
+}
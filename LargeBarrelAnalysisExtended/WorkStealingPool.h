@@ -0,0 +1,75 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file WorkStealingPool.h
+ *  @brief Fixed size thread pool in which idle workers steal tasks from the busy ones.
+ */
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Thread pool with one task deque per worker.
+ *
+ * Submitted tasks are distributed round robin over the worker deques.
+ * A worker takes the tasks from the front of its own deque and, when it is empty,
+ * steals from the back of the deques of the other workers, so a few long tasks
+ * (e.g. noisy time windows) do not leave the other cores idle.
+ * Each task gets the index of the worker running it, which allows the tasks
+ * to use per-worker resources (e.g. statistics) without locking.
+ * The destructor waits until all the submitted tasks are finished.
+ */
+class WorkStealingPool
+{
+public:
+  typedef std::function<void(unsigned int workerIndex)> Task;
+
+  explicit WorkStealingPool(unsigned int numOfThreads);
+  ~WorkStealingPool();
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  void submit(const Task& task);
+  unsigned int getNumOfThreads() const;
+  /// Number of tasks taken from the deque of another worker.
+  unsigned long getNumOfSteals() const;
+
+private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void run(unsigned int workerIndex);
+  bool popOwn(unsigned int workerIndex, Task& task);
+  bool steal(unsigned int workerIndex, Task& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> fQueues;
+  std::vector<std::thread> fThreads;
+  std::mutex fWakeMutex;
+  std::condition_variable fWakeCondition;
+  std::atomic<unsigned long> fQueuedTasks;
+  std::atomic<unsigned long> fSteals;
+  std::atomic<unsigned int> fNextQueue;
+  std::atomic<bool> fStop;
+};
+
+#endif /*  !WORKSTEALINGPOOL_H */
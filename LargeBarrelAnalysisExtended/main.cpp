@@ -13,6 +13,10 @@
  *  @file main.cpp
  */
 
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <thread>
 #include <DBHandler/HeaderFiles/DBHandler.h>
 #include <JPetManager/JPetManager.h>
 #include <JPetTaskLoader/JPetTaskLoader.h>
@@ -23,88 +27,223 @@
 #include "HitFinder.h"
 #include "EventFinder.h"
 #include "EventCategorizer.h"
+#include "FusedPipeline.h"
+#include "ProfiledTask.h"
+#include "BatchTools.h"
 
 using namespace std;
 
-int main(int argc, char* argv[])
+namespace
 {
 
-  //Connection to the remote database disabled for the moment
-  //DB::SERVICES::DBHandler::createDBConnection("../DBConfig/configDB.cfg");
+/// Task of the analysis chain, with the types of the files it reads and writes
+/// when it is run by its own loader.
+struct ChainTask {
+  const char* name;
+  const char* inputFileType;
+  const char* outputFileType;
+  std::function<PipelineStage*()> create;
+};
 
-  JPetManager& manager = JPetManager::getManager();
-  manager.parseCmdLine(argc, argv);
+const std::vector<ChainTask>& getChainTasks()
+{
+  static const std::vector<ChainTask> tasks = {
+    {
+      "TimeWindowCreator", "hld", "tslot.raw", []() -> PipelineStage* {
+        return new TimeWindowCreator(
+          "TimeWindowCreator",
+          "Process unpacked HLD file into a tree of JPetTimeWindow objects"
+        );
+      }
+    },
+    {
+      "TimeCalibLoader", "tslot.raw", "tslot.calib", []() -> PipelineStage* {
+        return new TimeCalibLoader(
+          "TimeCalibLoader",
+          "Apply time corrections from prepared calibrations"
+        );
+      }
+    },
+    {
+      "SignalFinder", "tslot.calib", "raw.sig", []() -> PipelineStage* {
+        return new SignalFinder(
+          "SignalFinder",
+          "Create Raw Signals, optional - draw control histograms",
+          true
+        );
+      }
+    },
+    {
+      "SignalTransformer", "raw.sig", "phys.sig", []() -> PipelineStage* {
+        return new SignalTransformer(
+          "SignalTransformer",
+          "Create Reco & Phys Signals"
+        );
+      }
+    },
+    {
+      "HitFinder", "phys.sig", "hits", []() -> PipelineStage* {
+        return new HitFinder(
+          "HitFinder",
+          "Create hits from physical signals"
+        );
+      }
+    },
+    {
+      "EventFinder", "hits", "unk.evt", []() -> PipelineStage* {
+        return new EventFinder(
+          "EventFinder",
+          "Create Events as group of Hits"
+        );
+      }
+    },
+    {
+      "EventCategorizer", "unk.evt", "cat.evt", []() -> PipelineStage* {
+        return new EventCategorizer(
+          "EventCategorizer",
+          "Categorize Events"
+        );
+      }
+    }
+  };
+  return tasks;
+}
+
+/// Takes the options --separate-tasks and --first-task <TaskName> out of the command line.
+/// --first-task implies --separate-tasks. Returns false if the task name is missing or unknown.
+bool takeChainOptions(std::vector<std::string>& args, bool& separateTasks, std::string& firstTask)
+{
+  std::vector<std::string> rest;
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i] == "--separate-tasks") {
+      separateTasks = true;
+    } else if (args[i] == "--first-task") {
+      if (i + 1 >= args.size()) {
+        ERROR("No value given for the option --first-task");
+        return false;
+      }
+      firstTask = args[++i];
+      separateTasks = true;
+    } else {
+      rest.push_back(args[i]);
+    }
+  }
+  const auto& tasks = getChainTasks();
+  auto isFirstTask = [&firstTask](const ChainTask & task) {
+    return firstTask == task.name;
+  };
+  if (!firstTask.empty() && std::none_of(tasks.begin(), tasks.end(), isFirstTask)) {
+    ERROR("Unknown task given with --first-task: " + firstTask);
+    return false;
+  }
+  args.swap(rest);
+  return true;
+}
 
-  //First task - unpacking
-  manager.registerTask([]() {
-    return new JPetTaskLoader("hld", "tslot.raw",
-      new TimeWindowCreator(
-        "TimeWindowCreator",
-        "Process unpacked HLD file into a tree of JPetTimeWindow objects"
-      )
-    );
-  });
+/// Analyses the input files in rounds of at most batch.jobs files processed at the same time.
+/// The calibrations, velocities and geometry are loaded once, by the first task chain
+/// needing them, and the histograms of all files are summed into one output file.
+/// Every round is one manager.run(), which returns only when all its files are done,
+/// so the rounds are a barrier: a long file keeps the other cores idle until it ends.
+bool runBatch(JPetManager& manager, const BatchOptions& batch)
+{
+  auto files = BatchTools::expandInputFiles(batch.inputFiles);
+  if (files.empty()) {
+    ERROR("No input files found for " + batch.inputFiles);
+    return false;
+  }
+  int jobs = batch.jobs > 0 ? batch.jobs : std::max(1u, std::thread::hardware_concurrency());
+  HistogramMerger::getMerger().setEnabled(true);
+  std::size_t processed = 0;
+  for (const auto& round : BatchTools::splitIntoRounds(files, jobs)) {
+    INFO("Batch: processing files " + std::to_string(processed + 1) + "-"
+         + std::to_string(processed + round.size()) + " of " + std::to_string(files.size()));
+    auto args = BatchTools::getRoundArgs(batch, round);
+    vector<char*> roundArgv;
+    for (auto& arg : args) {
+      roundArgv.push_back(&arg[0]);
+    }
+    roundArgv.push_back(nullptr);
+    manager.parseCmdLine(args.size(), roundArgv.data());
+    manager.run();
+    processed += round.size();
+  }
+  if (!HistogramMerger::getMerger().write(batch.mergedOutput)) {
+    return false;
+  }
+  INFO("Batch: histograms of " + std::to_string(HistogramMerger::getMerger().getNumOfInputs())
+       + " files merged into " + batch.mergedOutput);
+  return true;
+}
 
-  //Second task - Signal Channel calibration
-  manager.registerTask([]() {
-    return new JPetTaskLoader("tslot.raw", "tslot.calib",
-      new TimeCalibLoader(
-        "TimeCalibLoader",
-        "Apply time corrections from prepared calibrations"
-      )
-    );
-  });
+}
 
-  //Third task - Raw Signal Creation
-  manager.registerTask([]() {
-    return new JPetTaskLoader("tslot.calib", "raw.sig",
-      new SignalFinder(
-        "SignalFinder",
-        "Create Raw Signals, optional - draw control histograms",
-        true
-      )
-    );
-  });
+int main(int argc, char* argv[])
+{
 
-  ////Fourth task - Reco & Phys signal creation
-  manager.registerTask([]() {
-    return new JPetTaskLoader("raw.sig", "phys.sig",
-      new SignalTransformer(
-        "SignalTransformer",
-        "Create Reco & Phys Signals"
-      )
-    );
-  });
+  //Connection to the remote database disabled for the moment
+  //DB::SERVICES::DBHandler::createDBConnection("../DBConfig/configDB.cfg");
 
-  ////Fifth task - Hit construction
-  manager.registerTask([]() {
-    return new JPetTaskLoader("phys.sig", "hits",
-      new HitFinder(
-        "HitFinder",
-        "Create hits from physical signals"
-      )
-    );
-  });
+  //The batch options are taken out of the command line,
+  //the rest of it is given to the JPetManager.
+  BatchOptions batch;
+  if (!BatchTools::parseBatchOptions(argc, argv, batch)) {
+    return 1;
+  }
 
-  ////Sixth task - unknown Event construction
-  manager.registerTask([]() {
-    return new JPetTaskLoader("hits", "unk.evt",
-      new EventFinder(
-        "EventFinder",
-        "Create Events as group of Hits"
-      )
-    );
-  });
+  //The options choosing the chain are also taken out of the command line.
+  bool separateTasks = false;
+  std::string firstTask;
+  if (!takeChainOptions(batch.frameworkArgs, separateTasks, firstTask)) {
+    return 1;
+  }
+
+  JPetManager& manager = JPetManager::getManager();
 
-  //Seventh task - Event Categorization
-  manager.registerTask([]() {
-    return new JPetTaskLoader("unk.evt", "cat.evt",
-      new EventCategorizer(
-        "EventCategorizer",
-        "Categorize Events"
-      )
-    );
-  });
+  if (!separateTasks) {
+    //All the tasks are run in memory, one time window at a time:
+    //unpacking, Signal Channel calibration, Raw Signal creation,
+    //Reco & Phys signal creation, Hit construction, unknown Event construction
+    //and Event Categorization.
+    //Only the output of the last task is written, unless the intermediate
+    //outputs are requested with the "<TaskName>_SaveOutput" user options.
+    manager.registerTask([]() {
+      auto pipeline = new FusedPipeline(
+        "FusedPipeline",
+        "Process unpacked HLD file into categorized Events in memory"
+      );
+      for (const auto& task : getChainTasks()) {
+        pipeline->addStage(task.create(), task.outputFileType);
+      }
+      return new JPetTaskLoader("hld", "cat.evt", new ProfiledTask(pipeline));
+    });
+  } else {
+    //Every task is run by its own loader, reading the file written by
+    //the previous one, starting from the task given with --first-task.
+    const auto& tasks = getChainTasks();
+    auto first = std::find_if(tasks.begin(), tasks.end(), [&firstTask](const ChainTask & task) {
+      return firstTask.empty() || firstTask == task.name;
+    });
+    for (auto task = first; task != tasks.end(); ++task) {
+      manager.registerTask([task]() {
+        return new JPetTaskLoader(task->inputFileType, task->outputFileType, new ProfiledTask(task->create()));
+      });
+    }
+  }
 
-  manager.run();
+  if (batch.inputFiles.empty()) {
+    vector<char*> frameworkArgv;
+    for (auto& arg : batch.frameworkArgs) {
+      frameworkArgv.push_back(&arg[0]);
+    }
+    frameworkArgv.push_back(nullptr);
+    manager.parseCmdLine(batch.frameworkArgs.size(), frameworkArgv.data());
+    manager.run();
+  } else if (separateTasks) {
+    ERROR("The batch mode runs only the fused chain, --separate-tasks can not be used with --batch");
+    return 1;
+  } else if (!runBatch(manager, batch)) {
+    return 1;
+  }
+  TaskProfiler::getProfiler().finish(std::cout);
 }
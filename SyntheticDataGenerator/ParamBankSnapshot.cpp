@@ -0,0 +1,331 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file ParamBankSnapshot.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <JPetParamBank/JPetParamBank.h>
+#include <JPetLoggerInclude.h>
+#include "ParamBankSnapshot.h"
+
+namespace
+{
+
+const char kSnapshotMagic[8] = {'J', 'P', 'E', 'T', 'P', 'B', 'S', '3'};
+
+enum Section {
+  kLayers, kBarrelSlots, kScins, kPMs, kFEBs, kTRBs, kTOMBChannels, kChannelIndex, kNumOfSections
+};
+
+const std::size_t kRecordSizes[kNumOfSections] = {
+  sizeof(ParamBankSnapshot::Layer), sizeof(ParamBankSnapshot::BarrelSlot), sizeof(ParamBankSnapshot::Scin),
+  sizeof(ParamBankSnapshot::PM), sizeof(ParamBankSnapshot::FEB), sizeof(ParamBankSnapshot::TRB),
+  sizeof(ParamBankSnapshot::TOMBChannel), sizeof(int32_t)
+};
+
+/// The header is followed by the sections, each starting at a multiple of 8 bytes.
+/// The channel index gives the position of every TOMB channel number in
+/// the TOMB channels section, -1 for the numbers not used.
+struct SnapshotHeader {
+  char magic[8];
+  int64_t runId;
+  /// 0 if the snapshot is not bound to a setup file
+  uint64_t setupFileHash;
+  uint64_t fileSize;
+  uint64_t offsets[kNumOfSections];
+  uint64_t counts[kNumOfSections];
+};
+
+uint64_t alignTo8(uint64_t offset)
+{
+  return (offset + 7) / 8 * 8;
+}
+
+/// 64-bit FNV-1a hash of the content of the setup file, the same as the one
+/// keying the time calibration cache of LargeBarrelAnalysisExtended.
+/// False if the file can not be read.
+bool hashSetupFile(const std::string& setupFile, uint64_t& hash)
+{
+  hash = 0;
+  if (setupFile.empty()) {
+    return true;
+  }
+  std::ifstream input(setupFile, std::ios::binary);
+  if (!input) {
+    return false;
+  }
+  hash = 14695981039346656037ULL;
+  char buffer[4096];
+  while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+    for (std::streamsize i = 0; i < input.gcount(); i++) {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 1099511628211ULL;
+    }
+  }
+  return true;
+}
+
+/// Positions of the objects in the map ordered by ID.
+template <class Object>
+std::map<int, int32_t> getIndices(const std::map<int, Object*>& objects)
+{
+  std::map<int, int32_t> indices;
+  for (const auto& object : objects) {
+    indices.emplace(object.first, indices.size());
+  }
+  return indices;
+}
+
+int32_t findIndex(const std::map<int, int32_t>& indices, int id)
+{
+  auto index = indices.find(id);
+  return index == indices.end() ? -1 : index->second;
+}
+
+template <class Record>
+void writeSection(std::ofstream& output, SnapshotHeader& header, Section section, const std::vector<Record>& records)
+{
+  header.offsets[section] = alignTo8(output.tellp());
+  header.counts[section] = records.size();
+  const char padding[8] = {};
+  output.write(padding, header.offsets[section] - output.tellp());
+  output.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+}
+
+}
+
+ParamBankSnapshot::ParamBankSnapshot() {}
+
+ParamBankSnapshot::~ParamBankSnapshot()
+{
+  close();
+}
+
+bool ParamBankSnapshot::write(const JPetParamBank& paramBank, const std::string& fileName,
+                              const std::string& setupFile, int runId)
+{
+  SnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.runId = runId;
+  if (!hashSetupFile(setupFile, header.setupFileHash)) {
+    ERROR("The setup file of the parameter bank snapshot does not exist:" + setupFile);
+    return false;
+  }
+
+  auto layerIndices = getIndices(paramBank.getLayers());
+  auto slotIndices = getIndices(paramBank.getBarrelSlots());
+  auto scinIndices = getIndices(paramBank.getScintillators());
+  auto pmIndices = getIndices(paramBank.getPMs());
+  auto febIndices = getIndices(paramBank.getFEBs());
+  auto trbIndices = getIndices(paramBank.getTRBs());
+
+  std::vector<Layer> layers;
+  for (const auto& layer : paramBank.getLayers()) {
+    layers.push_back({layer.first, 0, layer.second->getRadius()});
+  }
+  std::vector<BarrelSlot> slots;
+  for (const auto& slot : paramBank.getBarrelSlots()) {
+    slots.push_back({slot.first, findIndex(layerIndices, slot.second->getLayer().getID()),
+                     slot.second->getTheta()});
+  }
+  std::vector<Scin> scins;
+  for (const auto& scin : paramBank.getScintillators()) {
+    scins.push_back({scin.first, findIndex(slotIndices, scin.second->getBarrelSlot().getID())});
+  }
+  std::vector<PM> pms;
+  for (const auto& pm : paramBank.getPMs()) {
+    pms.push_back({pm.first, static_cast<int32_t>(pm.second->getSide()),
+                   findIndex(slotIndices, pm.second->getBarrelSlot().getID()),
+                   findIndex(scinIndices, pm.second->getScin().getID())});
+  }
+  std::vector<FEB> febs;
+  for (const auto& feb : paramBank.getFEBs()) {
+    febs.push_back({feb.first});
+  }
+  std::vector<TRB> trbs;
+  for (const auto& trb : paramBank.getTRBs()) {
+    trbs.push_back({trb.first});
+  }
+  std::vector<TOMBChannel> channels;
+  std::vector<int32_t> channelIndex;
+  for (const auto& tombChannel : paramBank.getTOMBChannels()) {
+    const auto& channel = *tombChannel.second;
+    if (channel.getChannel() >= channelIndex.size()) {
+      channelIndex.resize(channel.getChannel() + 1, -1);
+    }
+    channelIndex[channel.getChannel()] = channels.size();
+    channels.push_back({channel.getChannel(), findIndex(pmIndices, channel.getPM().getID()),
+                        findIndex(febIndices, channel.getFEB().getID()), findIndex(trbIndices, channel.getTRB().getID()),
+                        static_cast<int32_t>(channel.getLocalChannelNumber()), channel.getThreshold()});
+  }
+
+  const std::string tmpFile = fileName + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream output(tmpFile, std::ios::binary);
+    /// the header is written again when the offsets are known
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeSection(output, header, kLayers, layers);
+    writeSection(output, header, kBarrelSlots, slots);
+    writeSection(output, header, kScins, scins);
+    writeSection(output, header, kPMs, pms);
+    writeSection(output, header, kFEBs, febs);
+    writeSection(output, header, kTRBs, trbs);
+    writeSection(output, header, kTOMBChannels, channels);
+    writeSection(output, header, kChannelIndex, channelIndex);
+    header.fileSize = output.tellp();
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!output) {
+      ERROR("Could not write the parameter bank snapshot:" + tmpFile);
+      std::remove(tmpFile.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmpFile.c_str(), fileName.c_str()) != 0) {
+    ERROR("Could not create the parameter bank snapshot:" + fileName);
+    std::remove(tmpFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string ParamBankSnapshot::getSnapshotFileName(const std::string& directory, const std::string& setupFile, int runId)
+{
+  auto baseName = setupFile.substr(setupFile.find_last_of('/') + 1);
+  baseName = baseName.substr(0, baseName.find_last_of('.'));
+  auto name = baseName + "_run" + std::to_string(runId) + ".paramBank.bin";
+  return directory.empty() ? name : directory + "/" + name;
+}
+
+bool ParamBankSnapshot::open(const std::string& fileName, const std::string& setupFile, int runId)
+{
+  close();
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || static_cast<std::size_t>(fileStat.st_size) < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    WARNING("Parameter bank snapshot " + fileName + " is damaged, it is not used");
+    return false;
+  }
+  const std::size_t fileSize = fileStat.st_size;
+  void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  const auto& header = *static_cast<const SnapshotHeader*>(mapped);
+  bool valid = std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0
+               && header.fileSize == fileSize;
+  for (int section = 0; valid && section < kNumOfSections; section++) {
+    valid = header.offsets[section] % 8 == 0 && header.offsets[section] >= sizeof(SnapshotHeader)
+            && header.offsets[section] + header.counts[section] * kRecordSizes[section] <= fileSize;
+  }
+  if (!valid) {
+    WARNING("Parameter bank snapshot " + fileName + " is damaged, it is not used");
+    munmap(mapped, fileSize);
+    return false;
+  }
+  uint64_t setupFileHash = 0;
+  if (header.runId != runId || (!setupFile.empty()
+                                && (!hashSetupFile(setupFile, setupFileHash)
+                                    || header.setupFileHash != setupFileHash))) {
+    WARNING("Parameter bank snapshot " + fileName + " does not match the setup file or run, it is not used");
+    munmap(mapped, fileSize);
+    return false;
+  }
+  fData = static_cast<const char*>(mapped);
+  fSize = fileSize;
+  return true;
+}
+
+void ParamBankSnapshot::close()
+{
+  if (fData) {
+    munmap(const_cast<char*>(fData), fSize);
+    fData = nullptr;
+    fSize = 0;
+  }
+}
+
+bool ParamBankSnapshot::isOpen() const
+{
+  return fData != nullptr;
+}
+
+template <class Record>
+ParamBankSnapshot::Records<Record> ParamBankSnapshot::getRecords(int section) const
+{
+  if (!fData) {
+    return Records<Record>();
+  }
+  const auto& header = *reinterpret_cast<const SnapshotHeader*>(fData);
+  return Records<Record>(reinterpret_cast<const Record*>(fData + header.offsets[section]), header.counts[section]);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::Layer> ParamBankSnapshot::getLayers() const
+{
+  return getRecords<Layer>(kLayers);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::BarrelSlot> ParamBankSnapshot::getBarrelSlots() const
+{
+  return getRecords<BarrelSlot>(kBarrelSlots);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::Scin> ParamBankSnapshot::getScintillators() const
+{
+  return getRecords<Scin>(kScins);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::PM> ParamBankSnapshot::getPMs() const
+{
+  return getRecords<PM>(kPMs);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::FEB> ParamBankSnapshot::getFEBs() const
+{
+  return getRecords<FEB>(kFEBs);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::TRB> ParamBankSnapshot::getTRBs() const
+{
+  return getRecords<TRB>(kTRBs);
+}
+
+ParamBankSnapshot::Records<ParamBankSnapshot::TOMBChannel> ParamBankSnapshot::getTOMBChannels() const
+{
+  return getRecords<TOMBChannel>(kTOMBChannels);
+}
+
+const ParamBankSnapshot::TOMBChannel* ParamBankSnapshot::findTOMBChannel(unsigned int channel) const
+{
+  auto channelIndex = getRecords<int32_t>(kChannelIndex);
+  auto channels = getTOMBChannels();
+  if (channel >= channelIndex.size() || channelIndex[channel] < 0
+      || static_cast<std::size_t>(channelIndex[channel]) >= channels.size()) {
+    return nullptr;
+  }
+  return &channels[channelIndex[channel]];
+}
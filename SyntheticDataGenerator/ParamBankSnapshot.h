@@ -0,0 +1,156 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file ParamBankSnapshot.h
+ *  @brief Read-only snapshot of the parameter bank in a memory-mapped binary file.
+ */
+
+#ifndef PARAMBANKSNAPSHOT_H
+#define PARAMBANKSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class JPetParamBank;
+
+/**
+ * @brief Layers, barrel slots, scintillators, PMs, FEBs, TRBs and TOMB channels
+ * of one run in flat arrays, written once and then mapped into the memory.
+ *
+ * The objects of every type are stored ordered by ID, and the relations between
+ * them are kept as the indices in these arrays (-1 if not set), e.g. the TOMB
+ * channel gives the index of its PM, the PM the index of its barrel slot.
+ * The TOMB channels can also be found by the channel number in a dense table.
+ * Nothing is parsed or allocated when the file is opened, and the file is mapped
+ * as shared and read only, so all jobs on one node read the same pages from the
+ * page cache. The snapshot records the run number and the hash of the content
+ * of the setup file it was built from, and it is not used if they changed.
+ *
+ * The file written on one machine can be read on the machines with the same
+ * byte order only.
+ */
+class ParamBankSnapshot
+{
+public:
+  /// The geometry is kept in double, as in the parameter bank, so the tools
+  /// using the snapshot get exactly the same values as from the setup file.
+  struct Layer {
+    int32_t id;
+    /// always 0, keeps the written bytes defined
+    int32_t padding;
+    double radius;
+  };
+  struct BarrelSlot {
+    int32_t id;
+    int32_t layer;
+    /// in degrees
+    double theta;
+  };
+  struct Scin {
+    int32_t id;
+    int32_t barrelSlot;
+  };
+  struct PM {
+    int32_t id;
+    /// JPetPM::Side
+    int32_t side;
+    int32_t barrelSlot;
+    int32_t scin;
+  };
+  struct FEB {
+    int32_t id;
+  };
+  struct TRB {
+    int32_t id;
+  };
+  struct TOMBChannel {
+    uint32_t channel;
+    int32_t pm;
+    int32_t feb;
+    int32_t trb;
+    /// local channel number of the FEB, 1-4
+    int32_t thresholdNumber;
+    float threshold;
+  };
+
+  /// Array of the records stored in the snapshot.
+  template <class Record>
+  class Records
+  {
+  public:
+    Records(const Record* data = nullptr, std::size_t size = 0): fData(data), fSize(size) {}
+    const Record* begin() const
+    {
+      return fData;
+    }
+    const Record* end() const
+    {
+      return fData + fSize;
+    }
+    std::size_t size() const
+    {
+      return fSize;
+    }
+    bool empty() const
+    {
+      return fSize == 0;
+    }
+    const Record& operator[](std::size_t index) const
+    {
+      return fData[index];
+    }
+  private:
+    const Record* fData;
+    std::size_t fSize;
+  };
+
+  ParamBankSnapshot();
+  ~ParamBankSnapshot();
+
+  /**
+   * Writes the snapshot of the parameter bank loaded from the setup file for the run.
+   * The file is replaced at once, so the jobs reading the previous version are not affected.
+   * The setup file may be empty, then the snapshot is not bound to any file.
+   */
+  static bool write(const JPetParamBank& paramBank, const std::string& fileName,
+                    const std::string& setupFile, int runId);
+  /// Name of the snapshot of the run in the directory.
+  static std::string getSnapshotFileName(const std::string& directory, const std::string& setupFile, int runId);
+
+  /// Maps the file, false if it does not exist, is damaged, or was built for another
+  /// version of the setup file or another run. The setup file is not checked if empty.
+  bool open(const std::string& fileName, const std::string& setupFile, int runId);
+  void close();
+  bool isOpen() const;
+
+  Records<Layer> getLayers() const;
+  Records<BarrelSlot> getBarrelSlots() const;
+  Records<Scin> getScintillators() const;
+  Records<PM> getPMs() const;
+  Records<FEB> getFEBs() const;
+  Records<TRB> getTRBs() const;
+  Records<TOMBChannel> getTOMBChannels() const;
+  /// nullptr if the channel is not in the setup
+  const TOMBChannel* findTOMBChannel(unsigned int channel) const;
+
+private:
+  ParamBankSnapshot(const ParamBankSnapshot&);
+  void operator=(const ParamBankSnapshot&);
+  template <class Record>
+  Records<Record> getRecords(int section) const;
+
+  const char* fData = nullptr;
+  std::size_t fSize = 0;
+};
+
+#endif /*  !PARAMBANKSNAPSHOT_H */
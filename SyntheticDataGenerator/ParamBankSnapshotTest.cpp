@@ -0,0 +1,170 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ParamBankSnapshotTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <JPetParamBank/JPetParamBank.h>
+#include "ParamBankSnapshot.h"
+
+/// Two layers with two slots each, a scintillator and two PMs in every slot,
+/// and the PMs read out on 4 thresholds by one FEB and one TRB.
+class TestSetup
+{
+public:
+  TestSetup():
+    fFEB(5, true, "active", "", 1, 1, 8, 0),
+    fTRB(7, 0, 0)
+  {
+    fParamBank.addFEB(fFEB);
+    fParamBank.addTRB(fTRB);
+    unsigned int channel = 100;
+    for (int layer = 1; layer <= 2; layer++) {
+      fLayers.push_back(JPetLayer(layer, true, "Layer", 40. + 5.1 * layer));
+      fParamBank.addLayer(fLayers.back());
+      for (int slot = 0; slot < 2; slot++) {
+        int id = 10 * layer + slot;
+        fSlots.push_back(JPetBarrelSlot(id, true, "slot", 180. * slot + 7.3, slot + 1));
+        fSlots.back().setLayer(fLayers.back());
+        fParamBank.addBarrelSlot(fSlots.back());
+        fScins.push_back(JPetScin(id));
+        fScins.back().setBarrelSlot(fSlots.back());
+        fParamBank.addScintillator(fScins.back());
+        for (auto side : {JPetPM::SideA, JPetPM::SideB}) {
+          fPMs.push_back(JPetPM(2 * id + side, "pm"));
+          fPMs.back().setSide(side);
+          fPMs.back().setScin(fScins.back());
+          fPMs.back().setBarrelSlot(fSlots.back());
+          fParamBank.addPM(fPMs.back());
+          for (unsigned int thr = 1; thr <= 4; thr++) {
+            fChannels.push_back(JPetTOMBChannel(channel++));
+            fChannels.back().setPM(fPMs.back());
+            fChannels.back().setFEB(fFEB);
+            fChannels.back().setTRB(fTRB);
+            fChannels.back().setLocalChannelNumber(thr);
+            fChannels.back().setThreshold(80. * thr);
+            fParamBank.addTOMBChannel(fChannels.back());
+          }
+        }
+      }
+    }
+  }
+
+  const JPetParamBank& getParamBank() const
+  {
+    return fParamBank;
+  }
+
+private:
+  JPetParamBank fParamBank;
+  JPetFEB fFEB;
+  JPetTRB fTRB;
+  std::deque<JPetLayer> fLayers;
+  std::deque<JPetBarrelSlot> fSlots;
+  std::deque<JPetScin> fScins;
+  std::deque<JPetPM> fPMs;
+  std::deque<JPetTOMBChannel> fChannels;
+};
+
+const std::string kSetupFile = "paramBankSnapshotTestSetup.json";
+const std::string kSnapshotFile = "paramBankSnapshotTest.bin";
+
+void writeSetupFile(const std::string& content)
+{
+  std::ofstream(kSetupFile) << content;
+}
+
+BOOST_AUTO_TEST_SUITE(ParamBankSnapshotSuite)
+
+BOOST_AUTO_TEST_CASE(writeAndOpen)
+{
+  TestSetup setup;
+  writeSetupFile("{}");
+  BOOST_REQUIRE(ParamBankSnapshot::write(setup.getParamBank(), kSnapshotFile, kSetupFile, 43));
+
+  ParamBankSnapshot snapshot;
+  BOOST_REQUIRE(snapshot.open(kSnapshotFile, kSetupFile, 43));
+  BOOST_REQUIRE(snapshot.isOpen());
+  BOOST_REQUIRE_EQUAL(snapshot.getLayers().size(), 2u);
+  BOOST_REQUIRE_EQUAL(snapshot.getBarrelSlots().size(), 4u);
+  BOOST_REQUIRE_EQUAL(snapshot.getScintillators().size(), 4u);
+  BOOST_REQUIRE_EQUAL(snapshot.getPMs().size(), 8u);
+  BOOST_REQUIRE_EQUAL(snapshot.getFEBs().size(), 1u);
+  BOOST_REQUIRE_EQUAL(snapshot.getTRBs().size(), 1u);
+  BOOST_REQUIRE_EQUAL(snapshot.getTOMBChannels().size(), 32u);
+
+  /// the objects are ordered by ID and the relations are given as indices
+  BOOST_REQUIRE_EQUAL(snapshot.getLayers()[1].id, 2);
+  /// the geometry is exactly the one of the parameter bank
+  const auto& paramBank = setup.getParamBank();
+  BOOST_REQUIRE_EQUAL(snapshot.getLayers()[1].radius, paramBank.getLayers().at(2)->getRadius());
+  const auto& slot = snapshot.getBarrelSlots()[3];
+  BOOST_REQUIRE_EQUAL(slot.id, 21);
+  BOOST_REQUIRE_EQUAL(snapshot.getLayers()[slot.layer].id, 2);
+  BOOST_REQUIRE_EQUAL(slot.theta, paramBank.getBarrelSlots().at(21)->getTheta());
+  BOOST_REQUIRE_EQUAL(snapshot.getBarrelSlots()[snapshot.getScintillators()[2].barrelSlot].id, 20);
+
+  auto channel = snapshot.findTOMBChannel(113);
+  BOOST_REQUIRE(channel);
+  BOOST_REQUIRE_EQUAL(channel->channel, 113u);
+  BOOST_REQUIRE_EQUAL(channel->thresholdNumber, 2);
+  BOOST_REQUIRE_CLOSE(channel->threshold, 160., 0.001);
+  BOOST_REQUIRE_EQUAL(snapshot.getFEBs()[channel->feb].id, 5);
+  BOOST_REQUIRE_EQUAL(snapshot.getTRBs()[channel->trb].id, 7);
+  const auto& pm = snapshot.getPMs()[channel->pm];
+  BOOST_REQUIRE_EQUAL(pm.id, 2 * 11 + JPetPM::SideB);
+  BOOST_REQUIRE_EQUAL(pm.side, JPetPM::SideB);
+  BOOST_REQUIRE_EQUAL(snapshot.getBarrelSlots()[pm.barrelSlot].id, 11);
+  BOOST_REQUIRE_EQUAL(snapshot.getScintillators()[pm.scin].id, 11);
+
+  BOOST_REQUIRE(!snapshot.findTOMBChannel(99));
+  BOOST_REQUIRE(!snapshot.findTOMBChannel(132));
+
+  snapshot.close();
+  BOOST_REQUIRE(!snapshot.isOpen());
+  BOOST_REQUIRE(snapshot.getPMs().empty());
+  std::remove(kSnapshotFile.c_str());
+  std::remove(kSetupFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(notMatchingSnapshot)
+{
+  TestSetup setup;
+  writeSetupFile("{}");
+  BOOST_REQUIRE(ParamBankSnapshot::write(setup.getParamBank(), kSnapshotFile, kSetupFile, 43));
+  ParamBankSnapshot snapshot;
+  BOOST_REQUIRE(!snapshot.open("blabla.bin", kSetupFile, 43));
+  BOOST_REQUIRE(!snapshot.open(kSnapshotFile, kSetupFile, 44));
+  /// the snapshot can be used without the setup file
+  BOOST_REQUIRE(snapshot.open(kSnapshotFile, "", 43));
+
+  writeSetupFile("{\"changed\": 1}");
+  BOOST_REQUIRE(!snapshot.open(kSnapshotFile, kSetupFile, 43));
+  BOOST_REQUIRE(!snapshot.isOpen());
+  /// an edit keeping the size, made within the same second
+  writeSetupFile("{\"changed\": 1}");
+  BOOST_REQUIRE(ParamBankSnapshot::write(setup.getParamBank(), kSnapshotFile, kSetupFile, 43));
+  writeSetupFile("{\"changed\": 2}");
+  BOOST_REQUIRE(!snapshot.open(kSnapshotFile, kSetupFile, 43));
+  std::remove(kSetupFile.c_str());
+  BOOST_REQUIRE(!snapshot.open(kSnapshotFile, kSetupFile, 43));
+
+  /// damaged file
+  {
+    std::ofstream file(kSnapshotFile, std::ios::binary | std::ios::app);
+    file << "garbage";
+  }
+  BOOST_REQUIRE(!snapshot.open(kSnapshotFile, "", 43));
+  std::remove(kSnapshotFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(snapshotFileName)
+{
+  BOOST_REQUIRE_EQUAL(ParamBankSnapshot::getSnapshotFileName("", "../setup/large_barrel.json", 43),
+                      "large_barrel_run43.paramBank.bin");
+  BOOST_REQUIRE_EQUAL(ParamBankSnapshot::getSnapshotFileName("cache", "large_barrel.json", 5),
+                      "cache/large_barrel_run5.paramBank.bin");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,320 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SyntheticEventGenerator.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include "SyntheticEventGenerator.h"
+
+namespace
+{
+
+const double kSpeedOfLight = 29.9792458; // cm/ns
+/// triangular pulse of the amplitude 1 rises in 1 ns and falls in 80 ns
+const double kRiseTime = 1.;
+const double kFallTime = 80.;
+/// the thresholds are at 0.2, 0.4, ... of the maximal amplitude
+const double kThresholdStep = 0.2;
+const double kMaxNoiseAmplitude = 0.5;
+
+double angularDistance(double theta1, double theta2)
+{
+  double distance = std::fabs(theta1 - theta2);
+  return std::min(distance, 360. - distance);
+}
+
+}
+
+GeneratorSetup GeneratorSetup::build(const JPetParamBank& paramBank, int numOfActivePMs, int numOfThresholds)
+{
+  std::set<int> activePMs;
+  for (const auto& pm : paramBank.getPMs()) {
+    if (numOfActivePMs >= 0 && static_cast<int>(activePMs.size()) >= numOfActivePMs) {
+      break;
+    }
+    activePMs.insert(pm.first);
+  }
+  GeneratorSetup setup;
+  for (const auto& tombChannel : paramBank.getTOMBChannels()) {
+    const auto& channel = *tombChannel.second;
+    int thresholdNumber = channel.getLocalChannelNumber();
+    if (thresholdNumber < 1 || thresholdNumber > numOfThresholds
+        || activePMs.count(channel.getPM().getID()) == 0) {
+      continue;
+    }
+    const auto& slot = channel.getPM().getBarrelSlot();
+    setup.addChannel(slot.getLayer().getID(), slot.getLayer().getRadius(), slot.getID(), slot.getTheta(),
+                     channel.getPM().getSide() == JPetPM::SideA, thresholdNumber, channel.getChannel());
+  }
+  setup.finish();
+  return setup;
+}
+
+GeneratorSetup GeneratorSetup::build(const ParamBankSnapshot& snapshot, int numOfActivePMs, int numOfThresholds)
+{
+  /// the PMs in the snapshot are ordered by ID
+  int numOfPMs = static_cast<int>(snapshot.getPMs().size());
+  if (numOfActivePMs >= 0) {
+    numOfPMs = std::min(numOfPMs, numOfActivePMs);
+  }
+  GeneratorSetup setup;
+  for (const auto& channel : snapshot.getTOMBChannels()) {
+    if (channel.thresholdNumber < 1 || channel.thresholdNumber > numOfThresholds
+        || channel.pm < 0 || channel.pm >= numOfPMs) {
+      continue;
+    }
+    const auto& pm = snapshot.getPMs()[channel.pm];
+    if (pm.barrelSlot < 0 || snapshot.getBarrelSlots()[pm.barrelSlot].layer < 0) {
+      continue;
+    }
+    const auto& slot = snapshot.getBarrelSlots()[pm.barrelSlot];
+    const auto& layer = snapshot.getLayers()[slot.layer];
+    setup.addChannel(layer.id, layer.radius, slot.id, slot.theta,
+                     pm.side == JPetPM::SideA, channel.thresholdNumber, channel.channel);
+  }
+  setup.finish();
+  return setup;
+}
+
+void GeneratorSetup::addChannel(int layerID, double radius, int slotID, double theta,
+                                bool sideA, int thresholdNumber, int daqChannel)
+{
+  auto layer = std::find_if(fLayers.begin(), fLayers.end(), [layerID](const Layer & l) {
+    return l.id == layerID;
+  });
+  if (layer == fLayers.end()) {
+    fLayers.push_back(Layer());
+    layer = fLayers.end() - 1;
+    layer->id = layerID;
+    layer->radius = radius;
+  }
+  auto slot = std::find_if(layer->slots.begin(), layer->slots.end(), [slotID](const Slot & s) {
+    return s.id == slotID;
+  });
+  if (slot == layer->slots.end()) {
+    layer->slots.push_back(Slot());
+    slot = layer->slots.end() - 1;
+    slot->id = slotID;
+    slot->theta = theta;
+  }
+  auto& channels = sideA ? slot->channelsA : slot->channelsB;
+  if (static_cast<int>(channels.size()) < thresholdNumber) {
+    channels.resize(thresholdNumber, -1);
+  }
+  channels[thresholdNumber - 1] = daqChannel;
+  fNumOfChannels++;
+}
+
+void GeneratorSetup::finish()
+{
+  std::sort(fLayers.begin(), fLayers.end(), [](const Layer & l1, const Layer & l2) {
+    return l1.radius < l2.radius;
+  });
+  for (auto& layer : fLayers) {
+    std::sort(layer.slots.begin(), layer.slots.end(), [](const Slot & s1, const Slot & s2) {
+      return s1.theta < s2.theta;
+    });
+  }
+}
+
+const std::vector<GeneratorSetup::Layer>& GeneratorSetup::getLayers() const
+{
+  return fLayers;
+}
+
+const GeneratorSetup::Slot* GeneratorSetup::findSlot(const Layer& layer, double theta)
+{
+  if (layer.slots.empty()) {
+    return nullptr;
+  }
+  auto next = std::lower_bound(layer.slots.begin(), layer.slots.end(), theta,
+  [](const Slot & slot, double value) {
+    return slot.theta < value;
+  });
+  /// the neighbours, with the first and the last slot being neighbours as well
+  const Slot& after = (next == layer.slots.end()) ? layer.slots.front() : *next;
+  const Slot& before = (next == layer.slots.begin()) ? layer.slots.back() : *(next - 1);
+  return angularDistance(after.theta, theta) < angularDistance(before.theta, theta) ? &after : &before;
+}
+
+std::size_t GeneratorSetup::getNumOfChannels() const
+{
+  return fNumOfChannels;
+}
+
+SyntheticEventGenerator::SyntheticEventGenerator(const GeneratorSetup& setup, const Parameters& parameters):
+  fSetup(setup),
+  fParameters(parameters),
+  fGenerator(parameters.seed),
+  fUniform(0., 1.) {}
+
+void SyntheticEventGenerator::generateTimeWindow(std::vector<TDCHit>& hits)
+{
+  hits.clear();
+  const double meanAnnihilations = fParameters.rate * fParameters.timeWindowLength * 1.e-9;
+  if (meanAnnihilations > 0.) {
+    int numOfAnnihilations = std::poisson_distribution<int>(meanAnnihilations)(fGenerator);
+    for (int i = 0; i < numOfAnnihilations; i++) {
+      generateAnnihilation(fUniform(fGenerator) * fParameters.timeWindowLength, hits);
+    }
+  }
+  if (fParameters.noiseMultiplicity > 0.) {
+    std::poisson_distribution<int> numOfNoiseSignals(fParameters.noiseMultiplicity);
+    for (const auto& layer : fSetup.getLayers()) {
+      for (const auto& slot : layer.slots) {
+        for (const auto* channels : {&slot.channelsA, &slot.channelsB}) {
+          if (channels->empty()) {
+            continue;
+          }
+          for (int i = numOfNoiseSignals(fGenerator); i > 0; i--) {
+            addSignal(*channels, fUniform(fGenerator) * fParameters.timeWindowLength,
+                      fUniform(fGenerator) * kMaxNoiseAmplitude, hits);
+          }
+        }
+      }
+    }
+  }
+  std::sort(hits.begin(), hits.end(), [](const TDCHit & hit1, const TDCHit & hit2) {
+    return hit1.channel < hit2.channel
+           || (hit1.channel == hit2.channel && hit1.leadTime < hit2.leadTime);
+  });
+}
+
+unsigned long SyntheticEventGenerator::getNumOfAnnihilations() const
+{
+  return fNumOfAnnihilations;
+}
+
+unsigned long SyntheticEventGenerator::getNumOfInteractions() const
+{
+  return fNumOfInteractions;
+}
+
+void SyntheticEventGenerator::generateAnnihilation(double time, std::vector<TDCHit>& hits)
+{
+  fNumOfAnnihilations++;
+  Point origin = {0., 0., 0.};
+  if (fParameters.sourceRadius > 0.) {
+    do {
+      origin = {2. * fUniform(fGenerator) - 1., 2. * fUniform(fGenerator) - 1., 2. * fUniform(fGenerator) - 1.};
+    } while (origin.x * origin.x + origin.y * origin.y + origin.z * origin.z > 1.);
+    origin = {origin.x * fParameters.sourceRadius, origin.y * fParameters.sourceRadius,
+              origin.z * fParameters.sourceRadius
+             };
+  }
+  Point first = randomDirection();
+  if (fUniform(fGenerator) >= fParameters.threeGammaFraction) {
+    propagatePhoton(origin, first, time, hits);
+    propagatePhoton(origin, {-first.x, -first.y, -first.z}, time, hits);
+    return;
+  }
+  /// the 3 photons are in one plane, the angles between them are all below 180 degrees
+  Point perpendicular = randomPerpendicular(first);
+  double angle12 = 0., angle23 = 0.;
+  do {
+    angle12 = fUniform(fGenerator) * M_PI;
+    angle23 = fUniform(fGenerator) * M_PI;
+  } while (angle12 + angle23 <= M_PI);
+  for (double angle : {0., angle12, angle12 + angle23}) {
+    Point direction = {
+      std::cos(angle) * first.x + std::sin(angle) * perpendicular.x,
+      std::cos(angle) * first.y + std::sin(angle) * perpendicular.y,
+      std::cos(angle) * first.z + std::sin(angle) * perpendicular.z
+    };
+    propagatePhoton(origin, direction, time, hits);
+  }
+}
+
+/// The photon interacts in the first layer it crosses with the interaction
+/// probability, otherwise it goes to the next one or leaves the barrel.
+void SyntheticEventGenerator::propagatePhoton(const Point& origin, const Point& direction, double time,
+    std::vector<TDCHit>& hits)
+{
+  const double a = direction.x * direction.x + direction.y * direction.y;
+  if (a <= 0.) {
+    return;
+  }
+  const double b = 2. * (origin.x * direction.x + origin.y * direction.y);
+  for (const auto& layer : fSetup.getLayers()) {
+    const double c = origin.x * origin.x + origin.y * origin.y - layer.radius * layer.radius;
+    /// the origin is inside the layer, so only the positive root is used
+    const double path = (-b + std::sqrt(b * b - 4. * a * c)) / (2. * a);
+    const Point point = {origin.x + path * direction.x, origin.y + path * direction.y, origin.z + path * direction.z};
+    if (std::fabs(point.z) > fParameters.stripLength / 2.) {
+      return;
+    }
+    if (fUniform(fGenerator) >= fParameters.interactionProbability) {
+      continue;
+    }
+    double theta = std::atan2(point.y, point.x) * 180. / M_PI;
+    const auto* slot = GeneratorSetup::findSlot(layer, theta < 0. ? theta + 360. : theta);
+    if (!slot) {
+      continue;
+    }
+    fNumOfInteractions++;
+    std::normal_distribution<double> resolution(0., fParameters.timeResolution);
+    const double interactionTime = time + path / kSpeedOfLight;
+    const double amplitude = 0.1 + 0.9 * fUniform(fGenerator);
+    /// as in the HitFinder, z = velocity * (tA - tB) / 2
+    const double timeA = interactionTime + (fParameters.stripLength / 2. + point.z) / fParameters.velocity;
+    const double timeB = interactionTime + (fParameters.stripLength / 2. - point.z) / fParameters.velocity;
+    addSignal(slot->channelsA, timeA + resolution(fGenerator),
+              std::min(1., amplitude * (0.9 + 0.2 * fUniform(fGenerator))), hits);
+    addSignal(slot->channelsB, timeB + resolution(fGenerator),
+              std::min(1., amplitude * (0.9 + 0.2 * fUniform(fGenerator))), hits);
+    return;
+  }
+}
+
+/// The time is counted from the beginning of the time window, the signals
+/// not finished before its end are lost, as in the data.
+void SyntheticEventGenerator::addSignal(const std::vector<int>& channels, double startTime, double amplitude,
+                                        std::vector<TDCHit>& hits)
+{
+  for (std::size_t thr = 0; thr < channels.size(); thr++) {
+    const double level = kThresholdStep * (thr + 1);
+    if (amplitude <= level) {
+      return;
+    }
+    const double leadTime = startTime + kRiseTime * level / amplitude;
+    const double trailTime = startTime + kRiseTime + kFallTime * (amplitude - level);
+    if (channels[thr] < 0 || trailTime >= fParameters.timeWindowLength) {
+      continue;
+    }
+    hits.push_back({channels[thr], leadTime - fParameters.timeWindowLength, trailTime - fParameters.timeWindowLength});
+  }
+}
+
+SyntheticEventGenerator::Point SyntheticEventGenerator::randomDirection()
+{
+  const double cosTheta = 2. * fUniform(fGenerator) - 1.;
+  const double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+  const double phi = 2. * M_PI * fUniform(fGenerator);
+  return {sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta};
+}
+
+/// Unit vector perpendicular to the given unit vector, in a random direction.
+SyntheticEventGenerator::Point SyntheticEventGenerator::randomPerpendicular(const Point& direction)
+{
+  Point other = randomDirection();
+  double dot = other.x * direction.x + other.y * direction.y + other.z * direction.z;
+  Point perpendicular = {other.x - dot * direction.x, other.y - dot * direction.y, other.z - dot * direction.z};
+  double norm = std::sqrt(perpendicular.x * perpendicular.x + perpendicular.y * perpendicular.y
+                          + perpendicular.z * perpendicular.z);
+  if (norm < 1.e-9) {
+    return randomPerpendicular(direction);
+  }
+  return {perpendicular.x / norm, perpendicular.y / norm, perpendicular.z / norm};
+}
@@ -0,0 +1,147 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SyntheticEventGenerator.h
+ *  @brief Generator of the TDC hits of the large barrel for the throughput tests.
+ */
+
+#ifndef SYNTHETICEVENTGENERATOR_H
+#define SYNTHETICEVENTGENERATOR_H
+
+#include <random>
+#include <vector>
+#include <JPetParamBank/JPetParamBank.h>
+#include "ParamBankSnapshot.h"
+
+/**
+ * @brief DAQ channels of the barrel slots, the part of the setup used by the generator.
+ */
+class GeneratorSetup
+{
+public:
+  struct Slot {
+    int id = 0;
+    /// in degrees, as in JPetBarrelSlot
+    double theta = 0.;
+    /// DAQ channels of the sides A and B, indexed by the threshold number - 1,
+    /// empty if the PM is not active
+    std::vector<int> channelsA;
+    std::vector<int> channelsB;
+  };
+  struct Layer {
+    int id = 0;
+    /// in cm
+    double radius = 0.;
+    /// sorted by theta
+    std::vector<Slot> slots;
+  };
+
+  /**
+   * Takes the DAQ channels of the first numOfActivePMs PMs (in the order of their IDs,
+   * all of them if negative) and of their first numOfThresholds thresholds.
+   */
+  static GeneratorSetup build(const JPetParamBank& paramBank, int numOfActivePMs, int numOfThresholds);
+  /// The same, with the setup taken from the snapshot of the parameter bank.
+  static GeneratorSetup build(const ParamBankSnapshot& snapshot, int numOfActivePMs, int numOfThresholds);
+
+  /// Adds the channel of a slot, the layer and the slot are created if needed.
+  void addChannel(int layerID, double radius, int slotID, double theta,
+                  bool sideA, int thresholdNumber, int daqChannel);
+  /// Sorts the layers by radius and the slots by theta, to be called after the channels are added.
+  void finish();
+
+  const std::vector<Layer>& getLayers() const;
+  /// The slot of the layer closest in theta to the given angle in degrees, nullptr if the layer is empty.
+  static const Slot* findSlot(const Layer& layer, double theta);
+  std::size_t getNumOfChannels() const;
+
+private:
+  std::vector<Layer> fLayers;
+  std::size_t fNumOfChannels = 0;
+};
+
+/**
+ * @brief Leading and trailing time of one TDC hit, in ns.
+ *
+ * As in the data unpacked from the HLD files, the times are measured
+ * from the end of the time window, so they are negative.
+ */
+struct TDCHit {
+  int channel;
+  double leadTime;
+  double trailTime;
+};
+
+/**
+ * @brief Generates the TDC hits of the annihilations and of the noise for consecutive time windows.
+ *
+ * The annihilations happen at random times with a constant rate, in a source
+ * at the centre of the barrel. Their 2 back-to-back photons, or 3 coplanar
+ * photons, cross the layers from the innermost one and interact in each of them
+ * with a fixed probability. The interaction point gives the slot, the time of flight
+ * and the times of the light reaching both ends of the strip. Every signal is a
+ * triangular pulse with a random amplitude, which crosses the thresholds at 0.2, 0.4...
+ * of the maximal amplitude, so the higher thresholds have shorter TOTs or no hits at all.
+ * The noise signals have small amplitudes and appear on a single PM.
+ * The same seed gives the same hits.
+ */
+class SyntheticEventGenerator
+{
+public:
+  struct Parameters {
+    /// annihilations per second
+    double rate = 1.e6;
+    /// in ns
+    double timeWindowLength = 50000.;
+    double threeGammaFraction = 0.;
+    /// probability that a photon crossing a layer interacts in it
+    double interactionProbability = 0.3;
+    /// mean number of noise signals on every active PM in one time window
+    double noiseMultiplicity = 0.1;
+    /// in cm
+    double stripLength = 50.;
+    double sourceRadius = 0.;
+    /// effective velocity of light in the strip, in cm/ns
+    double velocity = 12.6;
+    /// sigma of the signal start, in ns
+    double timeResolution = 0.1;
+    unsigned long seed = 2017;
+  };
+
+  SyntheticEventGenerator(const GeneratorSetup& setup, const Parameters& parameters);
+
+  /// Replaces hits with the ones of the next time window, ordered by channel and time.
+  void generateTimeWindow(std::vector<TDCHit>& hits);
+
+  /// Counters of everything generated so far
+  unsigned long getNumOfAnnihilations() const;
+  unsigned long getNumOfInteractions() const;
+
+private:
+  struct Point {
+    double x, y, z;
+  };
+  void generateAnnihilation(double time, std::vector<TDCHit>& hits);
+  void propagatePhoton(const Point& origin, const Point& direction, double time, std::vector<TDCHit>& hits);
+  void addSignal(const std::vector<int>& channels, double startTime, double amplitude, std::vector<TDCHit>& hits);
+  Point randomDirection();
+  Point randomPerpendicular(const Point& direction);
+
+  const GeneratorSetup& fSetup;
+  Parameters fParameters;
+  std::mt19937_64 fGenerator;
+  std::uniform_real_distribution<double> fUniform;
+  unsigned long fNumOfAnnihilations = 0;
+  unsigned long fNumOfInteractions = 0;
+};
+
+#endif /*  !SYNTHETICEVENTGENERATOR_H */
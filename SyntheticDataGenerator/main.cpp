@@ -0,0 +1,159 @@
+/**
+ *  @copyright Copyright 2017 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file main.cpp
+ *  @brief Writes the synthetic large barrel data in the format of the unpacked HLD files.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <TFile.h>
+#include <TTree.h>
+#include <Unpacker2/Unpacker2/EventIII.h>
+#include <JPetParamManager/JPetParamManager.h>
+#include <JPetParamGetterAscii/JPetParamGetterAscii.h>
+#include "SyntheticEventGenerator.h"
+
+using namespace std;
+
+namespace
+{
+
+/// the TDCChannel keeps the hits in arrays of a fixed size
+const int kMaxHitsPerChannel = 50;
+
+void printUsage(const char* program)
+{
+  SyntheticEventGenerator::Parameters defaults;
+  cerr << "Usage: " << program << " [--option value]...\n"
+       << "  --setup             setup file in the JSON format (large_barrel.json)\n"
+       << "  --run               run number of the setup (43)\n"
+       << "  --snapshot          snapshot of the parameter bank, read instead of the setup file\n"
+       << "                      if up to date, written otherwise (none)\n"
+       << "  --output            output file (synthetic.hld.root)\n"
+       << "  --windows           number of time windows (1000)\n"
+       << "  --window-length     time window length in ns (" << defaults.timeWindowLength << ")\n"
+       << "  --rate              annihilations per second (" << defaults.rate << ")\n"
+       << "  --three-gamma       fraction of the 3 gamma annihilations (" << defaults.threeGammaFraction << ")\n"
+       << "  --interaction       interaction probability in one layer (" << defaults.interactionProbability << ")\n"
+       << "  --noise             mean number of noise signals per PM and time window ("
+       << defaults.noiseMultiplicity << ")\n"
+       << "  --active-pms        number of the active PMs, all if negative (-1)\n"
+       << "  --thresholds        number of the thresholds read out for every PM (4)\n"
+       << "  --strip-length      in cm (" << defaults.stripLength << ")\n"
+       << "  --source-radius     in cm, 0 for a point source (" << defaults.sourceRadius << ")\n"
+       << "  --velocity          effective light velocity in cm/ns (" << defaults.velocity << ")\n"
+       << "  --time-resolution   in ns (" << defaults.timeResolution << ")\n"
+       << "  --seed              seed of the random numbers (" << defaults.seed << ")" << endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  map<string, string> options = {
+    {"setup", "large_barrel.json"}, {"run", "43"}, {"snapshot", ""}, {"output", "synthetic.hld.root"},
+    {"windows", "1000"}, {"active-pms", "-1"}, {"thresholds", "4"}
+  };
+  SyntheticEventGenerator::Parameters parameters;
+  map<string, double*> numericParameters = {
+    {"window-length", &parameters.timeWindowLength}, {"rate", &parameters.rate},
+    {"three-gamma", &parameters.threeGammaFraction}, {"interaction", &parameters.interactionProbability},
+    {"noise", &parameters.noiseMultiplicity}, {"strip-length", &parameters.stripLength},
+    {"source-radius", &parameters.sourceRadius}, {"velocity", &parameters.velocity},
+    {"time-resolution", &parameters.timeResolution}
+  };
+  for (int i = 1; i < argc; i += 2) {
+    string name = argv[i];
+    if (name.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+      printUsage(argv[0]);
+      return 1;
+    }
+    name = name.substr(2);
+    if (numericParameters.count(name)) {
+      *numericParameters[name] = atof(argv[i + 1]);
+    } else if (name == "seed") {
+      parameters.seed = strtoul(argv[i + 1], nullptr, 10);
+    } else if (options.count(name)) {
+      options[name] = argv[i + 1];
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  const int runId = atoi(options["run"].c_str());
+  const int numOfActivePMs = atoi(options["active-pms"].c_str());
+  const int numOfThresholds = atoi(options["thresholds"].c_str());
+  GeneratorSetup setup;
+  ParamBankSnapshot snapshot;
+  if (!options["snapshot"].empty() && snapshot.open(options["snapshot"], options["setup"], runId)) {
+    cout << "Setup read from the snapshot " << options["snapshot"] << endl;
+    setup = GeneratorSetup::build(snapshot, numOfActivePMs, numOfThresholds);
+  } else {
+    JPetParamManager paramManager(new JPetParamGetterAscii(options["setup"].c_str()));
+    paramManager.fillParameterBank(runId);
+    setup = GeneratorSetup::build(paramManager.getParamBank(), numOfActivePMs, numOfThresholds);
+    if (!options["snapshot"].empty()) {
+      if (ParamBankSnapshot::write(paramManager.getParamBank(), options["snapshot"], options["setup"], runId)) {
+        cout << "Snapshot of the setup written to " << options["snapshot"] << endl;
+      } else {
+        cerr << "Snapshot of the setup could not be written to " << options["snapshot"] << endl;
+      }
+    }
+  }
+  if (setup.getNumOfChannels() == 0) {
+    cerr << "No DAQ channels found in the setup " << options["setup"]
+         << " for the run " << options["run"] << endl;
+    return 1;
+  }
+  cout << "Generating hits for " << setup.getNumOfChannels() << " DAQ channels in "
+       << setup.getLayers().size() << " layers." << endl;
+
+  /// the same tree and branch names as in the files written by the Unpacker2
+  TFile file(options["output"].c_str(), "RECREATE");
+  TTree tree("T", "Synthetic large barrel data");
+  EventIII* event = new EventIII();
+  tree.Branch("event", "EventIII", &event);
+
+  SyntheticEventGenerator generator(setup, parameters);
+  vector<TDCHit> hits;
+  const int numOfWindows = atoi(options["windows"].c_str());
+  unsigned long numOfHits = 0;
+  for (int window = 0; window < numOfWindows; window++) {
+    generator.generateTimeWindow(hits);
+    event->Clear();
+    TDCChannel* tdcChannel = nullptr;
+    int hitsInChannel = 0;
+    for (const auto& hit : hits) {
+      if (!tdcChannel || tdcChannel->GetChannel() != hit.channel) {
+        tdcChannel = event->AddTDCChannel(hit.channel);
+        hitsInChannel = 0;
+      }
+      if (hitsInChannel++ < kMaxHitsPerChannel) {
+        tdcChannel->AddHit(hit.leadTime, hit.trailTime);
+        numOfHits++;
+      }
+    }
+    tree.Fill();
+  }
+  file.Write();
+  file.Close();
+  delete event;
+
+  cout << "Written " << numOfWindows << " time windows with " << generator.getNumOfAnnihilations()
+       << " annihilations, " << generator.getNumOfInteractions() << " photon interactions and "
+       << numOfHits << " TDC hits to " << options["output"] << endl;
+  return 0;
+}
@@ -0,0 +1,6 @@
+#!/bin/bash
+# 1000 time windows of 50 us with 1e6 annihilations per second and 10% of 3 gamma annihilations,
+# the output is processed by the analysis like an unpacked HLD file, e.g.
+# ../LargeBarrelAnalysisExtended/LargeBarrelAnalysisExtended.x -t root -f synthetic.hld.root -i 43 -l large_barrel.json
+./SyntheticDataGenerator.x --setup large_barrel.json --run 43 --snapshot large_barrel_run43.paramBank.bin --output synthetic.hld.root \
+  --windows 1000 --rate 1000000 --three-gamma 0.1 --noise 0.1